@@ -0,0 +1,206 @@
+#ifndef _POCKET_BENCH_BENCH_H
+#define _POCKET_BENCH_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES 1
+#else
+#define BENCH_HAS_CYCLES 0
+#endif
+
+/*
+ * Minimal timing harness for the containers.
+ *
+ * A bench_case_t is a setup/run/teardown triple. Every repetition calls setup (untimed), run (timed) and teardown
+ * (untimed); read-only cases are set up once and run repeatedly instead. run returns the number of operations it
+ * performed, and every repetition becomes one ns/op sample. After a few warmup repetitions the samples are sorted
+ * into min/p50/p90/p99/mean.
+ *
+ * Cycle counts come from the time stamp counter (reference cycles, not core cycles) on x86 and are reported as
+ * null elsewhere.
+ */
+
+#define BENCH_MAX_RESULTS 1024
+#define BENCH_WARMUP_REPS 2
+
+typedef struct bench_case_t {
+    const char *name;
+    void *(*setup)(size_t size);
+    size_t (*run)(void *ctx, size_t size);
+    void (*teardown)(void *ctx);
+    int read_only;    // Setup once and time run repeatedly
+    size_t max_size;  // Sizes above this are skipped (0: no limit), for cases whose footprint is a multiple of size
+} bench_case_t;
+
+typedef struct bench_result_t {
+    char name[64];
+    size_t size;
+    size_t reps;
+    double min_ns, p50_ns, p90_ns, p99_ns, mean_ns;  // Per operation
+    double cycles_per_op;                            // Negative when unavailable
+} bench_result_t;
+
+typedef struct bench_options_t {
+    size_t min_reps, max_reps;
+    size_t target_ops;  // Repetitions are chosen so that reps * size is close to this
+} bench_options_t;
+
+/* Keeps the compiler from optimizing away a computed value */
+#if defined(__GNUC__) || defined(__clang__)
+#define bench_do_not_optimize(value) __asm__ volatile("" : : "g"(value) : "memory")
+#else
+static volatile uint64_t bench_sink;
+#define bench_do_not_optimize(value) (bench_sink += (uint64_t)(value))
+#endif
+
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t bench_cycles(void) {
+#if BENCH_HAS_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/* xorshift64*, deterministic so every run sees the same keys */
+static inline uint64_t bench_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+static int bench_compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static inline double bench_percentile(const double *sorted, size_t count, double p) {
+    size_t index = (size_t)(p * (double)(count - 1) + 0.5);
+    return sorted[index < count ? index : count - 1];
+}
+
+static inline bench_result_t bench_run(const bench_case_t *bench, size_t size, const bench_options_t *options) {
+    size_t reps = size ? options->target_ops / size : options->max_reps;
+    if (reps < options->min_reps) reps = options->min_reps;
+    if (reps > options->max_reps) reps = options->max_reps;
+
+    double *samples = (double *)malloc(reps * sizeof(double));
+    uint64_t total_cycles = 0, total_ops = 0;
+    void *ctx = bench->read_only ? bench->setup(size) : NULL;
+    for (size_t rep = 0; rep < BENCH_WARMUP_REPS + reps; rep++) {
+        if (!bench->read_only) ctx = bench->setup(size);
+        uint64_t cycles = bench_cycles();
+        uint64_t start = bench_now_ns();
+        size_t ops = bench->run(ctx, size);
+        uint64_t elapsed = bench_now_ns() - start;
+        cycles = bench_cycles() - cycles;
+        if (!bench->read_only) bench->teardown(ctx);
+        if (rep < BENCH_WARMUP_REPS) continue;
+        if (ops == 0) ops = 1;
+        samples[rep - BENCH_WARMUP_REPS] = (double)elapsed / (double)ops;
+        total_cycles += cycles;
+        total_ops += ops;
+    }
+    if (bench->read_only) bench->teardown(ctx);
+
+    qsort(samples, reps, sizeof(double), bench_compare_double);
+    bench_result_t result;
+    memset(&result, 0, sizeof(result));
+    snprintf(result.name, sizeof(result.name), "%s", bench->name);
+    result.size = size;
+    result.reps = reps;
+    result.min_ns = samples[0];
+    result.p50_ns = bench_percentile(samples, reps, 0.50);
+    result.p90_ns = bench_percentile(samples, reps, 0.90);
+    result.p99_ns = bench_percentile(samples, reps, 0.99);
+    for (size_t i = 0; i < reps; i++) result.mean_ns += samples[i] / (double)reps;
+    result.cycles_per_op = BENCH_HAS_CYCLES ? (double)total_cycles / (double)total_ops : -1.0;
+    free(samples);
+    return result;
+}
+
+/*************************************/
+/**************JSON*******************/
+/*************************************/
+
+/* One result per line, so baselines can be read back without a JSON parser */
+static inline void bench_write_json(FILE *out, const bench_result_t *results, size_t count) {
+    fprintf(out, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        fprintf(out,
+                "    {\"name\": \"%s\", \"size\": %zu, \"reps\": %zu, \"min_ns\": %.3f, \"p50_ns\": %.3f, "
+                "\"p90_ns\": %.3f, \"p99_ns\": %.3f, \"mean_ns\": %.3f, \"cycles_per_op\": ",
+                r->name, r->size, r->reps, r->min_ns, r->p50_ns, r->p90_ns, r->p99_ns, r->mean_ns);
+        if (r->cycles_per_op < 0)
+            fprintf(out, "null}");
+        else
+            fprintf(out, "%.3f}", r->cycles_per_op);
+        fprintf(out, "%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+/* Reads name/size/p50 back from a file written by bench_write_json. Returns the number of results. */
+static inline size_t bench_read_json(FILE *in, bench_result_t *results, size_t max_results) {
+    char line[512];
+    size_t count = 0;
+    while (count < max_results && fgets(line, sizeof(line), in)) {
+        const char *name = strstr(line, "\"name\": \"");
+        const char *size = strstr(line, "\"size\": ");
+        const char *p50 = strstr(line, "\"p50_ns\": ");
+        if (!name || !size || !p50) continue;
+        bench_result_t *r = &results[count];
+        memset(r, 0, sizeof(*r));
+        name += strlen("\"name\": \"");
+        const char *end = strchr(name, '"');
+        if (!end || (size_t)(end - name) >= sizeof(r->name)) continue;
+        memcpy(r->name, name, (size_t)(end - name));
+        r->size = (size_t)strtoull(size + strlen("\"size\": "), NULL, 10);
+        r->p50_ns = strtod(p50 + strlen("\"p50_ns\": "), NULL);
+        count++;
+    }
+    return count;
+}
+
+/*
+ * Prints the p50 change of every result that also appears in the baseline. Returns the number of results that got
+ * slower by more than threshold_pct.
+ */
+static inline size_t bench_compare(FILE *out, const bench_result_t *results, size_t count,
+                                   const bench_result_t *baseline, size_t baseline_count, double threshold_pct) {
+    size_t regressions = 0;
+    fprintf(out, "\n%-32s %10s %12s %12s %9s\n", "benchmark", "size", "base ns/op", "ns/op", "change");
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < baseline_count; j++) {
+            if (results[i].size != baseline[j].size || strcmp(results[i].name, baseline[j].name) != 0) continue;
+            double change = baseline[j].p50_ns > 0 ? (results[i].p50_ns / baseline[j].p50_ns - 1.0) * 100.0 : 0.0;
+            int regressed = change > threshold_pct;
+            regressions += (size_t)regressed;
+            fprintf(out, "%-32s %10zu %12.3f %12.3f %+8.1f%%%s\n", results[i].name, results[i].size,
+                    baseline[j].p50_ns, results[i].p50_ns, change, regressed ? "  REGRESSION" : "");
+            break;
+        }
+    }
+    return regressions;
+}
+
+#endif  // _POCKET_BENCH_BENCH_H
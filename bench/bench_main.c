@@ -0,0 +1,552 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "bitset.h"
+#include "btree_map.h"
+#include "dynamic_array.h"
+#include "hash_map.h"
+#include "pocket_string.h"
+#include "priority_queue.h"
+
+DYN_ARRAY_DECLARE(bench_vec, uint64_t)
+DYN_ARRAY_IMPLEMENT(bench_vec, uint64_t)
+
+HASH_MAP_DECLARE(bench_map, uint64_t, uint64_t)
+HASH_MAP_IMPLEMENT(bench_map, uint64_t, uint64_t)
+
+BTREE_MAP_DECLARE(bench_tree, uint64_t, uint64_t)
+BTREE_MAP_IMPLEMENT(bench_tree, uint64_t, uint64_t, default_compare_uint64)
+
+#define BENCH_U64_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+PRIORITY_QUEUE_DECLARE(bench_queue, uint64_t, BENCH_U64_CMP)
+PRIORITY_QUEUE_IMPLEMENT(bench_queue, uint64_t, BENCH_U64_CMP)
+
+static bool u64_equal(uint64_t a, uint64_t b) { return a == b; }
+
+#define BENCH_SEED 0x9E3779B97F4A7C15ull
+#define BENCH_MISS_SEED 0xD1B54A32D192ED03ull
+
+/* Shifting benchmarks move O(size) bytes per operation, so they do fewer operations on large arrays */
+static size_t shift_ops(size_t size) {
+    size_t ops = ((size_t)1 << 24) / (size + 1);
+    return ops < 1 ? 1 : ops > 256 ? 256 : ops;
+}
+
+/*************************************/
+/**************Dynamic Array**********/
+/*************************************/
+
+static void *vec_setup_empty(size_t size) {
+    (void)size;
+    return bench_vec_create(1);
+}
+
+static void *vec_setup_filled(size_t size) {
+    bench_vec_t *vec = bench_vec_create(size + 256);
+    for (size_t i = 0; i < size; i++) bench_vec_push_back(vec, i);
+    return vec;
+}
+
+static void vec_teardown(void *ctx) { bench_vec_free((bench_vec_t *)ctx); }
+
+static size_t vec_push_back(void *ctx, size_t size) {
+    bench_vec_t *vec = (bench_vec_t *)ctx;
+    for (size_t i = 0; i < size; i++) bench_vec_push_back(vec, i);
+    bench_do_not_optimize(vec->data);
+    return size;
+}
+
+static size_t vec_insert_middle(void *ctx, size_t size) {
+    bench_vec_t *vec = (bench_vec_t *)ctx;
+    size_t ops = shift_ops(size);
+    for (size_t i = 0; i < ops; i++) bench_vec_insert(vec, vec->size / 2, i);
+    bench_do_not_optimize(vec->data);
+    return ops;
+}
+
+static size_t vec_remove_middle(void *ctx, size_t size) {
+    bench_vec_t *vec = (bench_vec_t *)ctx;
+    size_t ops = shift_ops(size);
+    if (ops > vec->size) ops = vec->size;
+    for (size_t i = 0; i < ops; i++) bench_vec_remove(vec, vec->size / 2);
+    bench_do_not_optimize(vec->data);
+    return ops;
+}
+
+static size_t vec_get_random(void *ctx, size_t size) {
+    bench_vec_t *vec = (bench_vec_t *)ctx;
+    uint64_t state = BENCH_SEED, sum = 0;
+    for (size_t i = 0; i < size; i++) sum += bench_vec_get(vec, bench_random(&state) % size);
+    bench_do_not_optimize(sum);
+    return size;
+}
+
+/*************************************/
+/**************String*****************/
+/*************************************/
+
+static const char bench_text[] = "/api/v1/users/0123456789/profile/settings/notifications/email";
+
+typedef struct string_pairs_t {
+    string_t *a;
+    string_t *b;
+    size_t count;
+} string_pairs_t;
+
+static void *no_setup(size_t size) {
+    (void)size;
+    return NULL;
+}
+
+static void no_teardown(void *ctx) { (void)ctx; }
+
+static size_t string_create_free(size_t count, size_t len) {
+    for (size_t i = 0; i < count; i++) {
+        string_t s = string_create_n(bench_text, len);
+        bench_do_not_optimize(string_get_cstr(&s));
+        string_free(&s);
+    }
+    return count;
+}
+
+static size_t string_create_short(void *ctx, size_t size) {
+    (void)ctx;
+    return string_create_free(size, 12);
+}
+
+static size_t string_create_long(void *ctx, size_t size) {
+    (void)ctx;
+    return string_create_free(size, 48);
+}
+
+static void *string_setup_empty(size_t size) {
+    (void)size;
+    string_t *s = (string_t *)malloc(sizeof(string_t));
+    *s = string_create_empty();
+    return s;
+}
+
+static void string_teardown_one(void *ctx) {
+    string_free((string_t *)ctx);
+    free(ctx);
+}
+
+static size_t string_append(void *ctx, size_t size) {
+    string_t *s = (string_t *)ctx;
+    for (size_t i = 0; i < size; i++) string_append_n(s, bench_text, 16);
+    bench_do_not_optimize(string_get_cstr(s));
+    return size;
+}
+
+/* Pairs of equal 48 char strings, a realistic worst case for equality since every byte has to be compared */
+static void *string_setup_pairs(size_t size) {
+    string_pairs_t *pairs = (string_pairs_t *)malloc(sizeof(string_pairs_t));
+    pairs->a = (string_t *)malloc(size * sizeof(string_t));
+    pairs->b = (string_t *)malloc(size * sizeof(string_t));
+    pairs->count = size;
+    for (size_t i = 0; i < size; i++) {
+        pairs->a[i] = string_create_n(bench_text, 48);
+        pairs->b[i] = string_copy(&pairs->a[i]);
+    }
+    return pairs;
+}
+
+static void string_teardown_pairs(void *ctx) {
+    string_pairs_t *pairs = (string_pairs_t *)ctx;
+    for (size_t i = 0; i < pairs->count; i++) {
+        string_free(&pairs->a[i]);
+        string_free(&pairs->b[i]);
+    }
+    free(pairs->a);
+    free(pairs->b);
+    free(pairs);
+}
+
+static size_t string_equals_pairs(void *ctx, size_t size) {
+    string_pairs_t *pairs = (string_pairs_t *)ctx;
+    size_t equal = 0;
+    for (size_t i = 0; i < size; i++) equal += (size_t)string_equals(&pairs->a[i], &pairs->b[i]);
+    bench_do_not_optimize(equal);
+    return size;
+}
+
+static size_t string_compare_pairs(void *ctx, size_t size) {
+    string_pairs_t *pairs = (string_pairs_t *)ctx;
+    int total = 0;
+    for (size_t i = 0; i < size; i++) total += string_compare(&pairs->a[i], &pairs->b[i]);
+    bench_do_not_optimize(total);
+    return size;
+}
+
+/*************************************/
+/**************Hash Map***************/
+/*************************************/
+
+static void *map_setup_empty(size_t size) {
+    (void)size;
+    bench_map_t *map = (bench_map_t *)malloc(sizeof(bench_map_t));
+    *map = bench_map_create(16, u64_equal, default_hash_uint64);
+    return map;
+}
+
+static void *map_setup_filled(size_t size) {
+    bench_map_t *map = (bench_map_t *)map_setup_empty(size);
+    uint64_t state = BENCH_SEED;
+    for (size_t i = 0; i < size; i++) bench_map_insert(map, bench_random(&state), i);
+    return map;
+}
+
+/* Same map with a 1% Bloom filter in front of it */
+static void *map_setup_filtered(size_t size) {
+    bench_map_t *map = (bench_map_t *)map_setup_filled(size);
+    bench_map_enable_filter(map, 0.01);
+    return map;
+}
+
+static void map_teardown(void *ctx) {
+    bench_map_free((bench_map_t *)ctx);
+    free(ctx);
+}
+
+static size_t map_insert(void *ctx, size_t size) {
+    bench_map_t *map = (bench_map_t *)ctx;
+    uint64_t state = BENCH_SEED;
+    for (size_t i = 0; i < size; i++) bench_map_insert(map, bench_random(&state), i);
+    return size;
+}
+
+static size_t map_lookup(bench_map_t *map, size_t size, uint64_t seed) {
+    uint64_t state = seed, found = 0;
+    for (size_t i = 0; i < size; i++) found += bench_map_find(map, bench_random(&state)) != NULL;
+    bench_do_not_optimize(found);
+    return size;
+}
+
+static size_t map_find_hit(void *ctx, size_t size) { return map_lookup((bench_map_t *)ctx, size, BENCH_SEED); }
+
+static size_t map_find_miss(void *ctx, size_t size) { return map_lookup((bench_map_t *)ctx, size, BENCH_MISS_SEED); }
+
+/* Erases and re-inserts every key, so the map ends in the same state and the case can be repeated */
+static size_t map_erase_churn(void *ctx, size_t size) {
+    bench_map_t *map = (bench_map_t *)ctx;
+    uint64_t state = BENCH_SEED;
+    for (size_t i = 0; i < size; i++) {
+        uint64_t key = bench_random(&state);
+        bench_map_erase(map, key);
+        bench_map_insert(map, key, i);
+    }
+    return size * 2;
+}
+
+static size_t map_iterate(void *ctx, size_t size) {
+    bench_map_t *map = (bench_map_t *)ctx;
+    uint64_t sum = 0;
+    for (bench_map_it_t it = bench_map_it_begin(map); it.index < map->capacity; bench_map_it_next(&it))
+        sum += bench_map_it_value(&it);
+    bench_do_not_optimize(sum);
+    return size;
+}
+
+/*************************************/
+/**************B-Tree Map*************/
+/*************************************/
+
+static void *tree_setup_empty(size_t size) {
+    (void)size;
+    bench_tree_t *tree = (bench_tree_t *)malloc(sizeof(bench_tree_t));
+    *tree = bench_tree_create();
+    return tree;
+}
+
+static void *tree_setup_filled(size_t size) {
+    bench_tree_t *tree = (bench_tree_t *)tree_setup_empty(size);
+    uint64_t state = BENCH_SEED;
+    for (size_t i = 0; i < size; i++) bench_tree_insert(tree, bench_random(&state), i);
+    return tree;
+}
+
+static void tree_teardown(void *ctx) {
+    bench_tree_free((bench_tree_t *)ctx);
+    free(ctx);
+}
+
+static size_t tree_insert_random(void *ctx, size_t size) {
+    bench_tree_t *tree = (bench_tree_t *)ctx;
+    uint64_t state = BENCH_SEED;
+    for (size_t i = 0; i < size; i++) bench_tree_insert(tree, bench_random(&state), i);
+    return size;
+}
+
+/* Increasing timestamps, the time series case */
+static size_t tree_insert_append(void *ctx, size_t size) {
+    bench_tree_t *tree = (bench_tree_t *)ctx;
+    for (size_t i = 0; i < size; i++) bench_tree_insert(tree, 1000000 + i * 10, i);
+    return size;
+}
+
+static size_t tree_find_hit(void *ctx, size_t size) {
+    bench_tree_t *tree = (bench_tree_t *)ctx;
+    uint64_t state = BENCH_SEED, found = 0;
+    for (size_t i = 0; i < size; i++) found += bench_tree_find(tree, bench_random(&state)) != NULL;
+    bench_do_not_optimize(found);
+    return size;
+}
+
+/* Short range scans: a lower_bound followed by 16 steps along the leaves */
+static size_t tree_range_scan(void *ctx, size_t size) {
+    bench_tree_t *tree = (bench_tree_t *)ctx;
+    uint64_t state = BENCH_MISS_SEED, sum = 0;
+    size_t scans = size / 16 + 1;
+    for (size_t i = 0; i < scans; i++) {
+        bench_tree_it_t it = bench_tree_lower_bound(tree, bench_random(&state));
+        for (int step = 0; step < 16 && bench_tree_it_valid(&it); step++, bench_tree_it_next(&it))
+            sum += *bench_tree_it_value(&it);
+    }
+    bench_do_not_optimize(sum);
+    return scans * 16;
+}
+
+/*************************************/
+/**************Priority Queue*********/
+/*************************************/
+
+static void *queue_setup_empty(size_t size) {
+    bench_queue_t *queue = (bench_queue_t *)malloc(sizeof(bench_queue_t));
+    *queue = bench_queue_create(size, false);
+    return queue;
+}
+
+static void queue_teardown(void *ctx) {
+    bench_queue_free((bench_queue_t *)ctx);
+    free(ctx);
+}
+
+/* Pushes size random keys, then pops them all */
+static size_t queue_push_pop(void *ctx, size_t size) {
+    bench_queue_t *queue = (bench_queue_t *)ctx;
+    uint64_t state = BENCH_SEED, sum = 0;
+    for (size_t i = 0; i < size; i++) bench_queue_push(queue, bench_random(&state));
+    for (size_t i = 0; i < size; i++) sum += bench_queue_pop(queue);
+    bench_do_not_optimize(sum);
+    return size * 2;
+}
+
+/* Keeps the 100 greatest of size random keys */
+static size_t queue_top_k(void *ctx, size_t size) {
+    bench_queue_t *queue = (bench_queue_t *)ctx;
+    uint64_t state = BENCH_SEED;
+    bench_queue_clear(queue);
+    for (size_t i = 0; i < size; i++) bench_queue_push_bounded(queue, bench_random(&state), 100);
+    bench_do_not_optimize(bench_queue_top(queue));
+    return size;
+}
+
+/*************************************/
+/**************Bitset*****************/
+/*************************************/
+
+/* Sizes count 64-bit words, so the footprint matches the uint64_t cases */
+typedef struct bench_bits_t {
+    bitset_t a, b;
+    bitset_rank_t index;
+} bench_bits_t;
+
+static void *bits_setup_filled(size_t size) {
+    bench_bits_t *bits = (bench_bits_t *)malloc(sizeof(bench_bits_t));
+    bits->a = bitset_create(size * BITSET_WORD_BITS);
+    bits->b = bitset_create(size * BITSET_WORD_BITS);
+    uint64_t state = BENCH_SEED;
+    for (size_t i = 0; i < size; i++) {
+        bits->a.words[i] = bench_random(&state);
+        bits->b.words[i] = bench_random(&state) & bench_random(&state) & bench_random(&state) & bench_random(&state);
+    }
+    bitset_rank_build(&bits->index, &bits->b);
+    return bits;
+}
+
+static void bits_teardown(void *ctx) {
+    bench_bits_t *bits = (bench_bits_t *)ctx;
+    bitset_rank_free(&bits->index);
+    bitset_free(&bits->a);
+    bitset_free(&bits->b);
+    free(bits);
+}
+
+/* One pass of a ^= b, per word */
+static size_t bits_xor(void *ctx, size_t size) {
+    bench_bits_t *bits = (bench_bits_t *)ctx;
+    bitset_xor(&bits->a, &bits->b);
+    bench_do_not_optimize(bits->a.words[0]);
+    return size;
+}
+
+/* Popcount of the whole bitset, per word */
+static size_t bits_count(void *ctx, size_t size) {
+    bench_bits_t *bits = (bench_bits_t *)ctx;
+    bench_do_not_optimize(bitset_count(&bits->a));
+    return size;
+}
+
+/* Walks the set bits of a 1/16 dense bitset with find_next, per set bit */
+static size_t bits_iterate(void *ctx, size_t size) {
+    bench_bits_t *bits = (bench_bits_t *)ctx;
+    size_t found = 0, sum = 0;
+    for (size_t i = bitset_find_first(&bits->b); i != BITSET_NPOS; i = bitset_find_next(&bits->b, i + 1)) {
+        sum += i;
+        found++;
+    }
+    bench_do_not_optimize(sum);
+    (void)size;
+    return found;
+}
+
+/* Random rank and select queries on the 1/16 dense bitset */
+static size_t bits_rank_select(void *ctx, size_t size) {
+    bench_bits_t *bits = (bench_bits_t *)ctx;
+    uint64_t state = BENCH_MISS_SEED, sum = 0;
+    size_t ones = bits->index.ones ? bits->index.ones : 1;
+    for (size_t i = 0; i < size; i++) {
+        sum += bitset_rank(&bits->index, bench_random(&state) % bits->b.size);
+        sum += bitset_select(&bits->index, bench_random(&state) % ones);
+    }
+    bench_do_not_optimize(sum);
+    return size * 2;
+}
+
+/*************************************/
+/**************Driver*****************/
+/*************************************/
+
+static const bench_case_t bench_cases[] = {
+    {"dyn_array/push_back", vec_setup_empty, vec_push_back, vec_teardown, 0, 0},
+    {"dyn_array/insert_middle", vec_setup_filled, vec_insert_middle, vec_teardown, 0, 0},
+    {"dyn_array/remove_middle", vec_setup_filled, vec_remove_middle, vec_teardown, 0, 0},
+    {"dyn_array/get_random", vec_setup_filled, vec_get_random, vec_teardown, 1, 0},
+    {"string/create_short", no_setup, string_create_short, no_teardown, 1, 1 << 16},
+    {"string/create_long", no_setup, string_create_long, no_teardown, 1, 1 << 16},
+    {"string/append", string_setup_empty, string_append, string_teardown_one, 0, 1 << 22},
+    {"string/equals", string_setup_pairs, string_equals_pairs, string_teardown_pairs, 1, 1 << 20},
+    {"string/compare", string_setup_pairs, string_compare_pairs, string_teardown_pairs, 1, 1 << 20},
+    {"hash_map/insert", map_setup_empty, map_insert, map_teardown, 0, 1 << 22},
+    {"hash_map/find_hit", map_setup_filled, map_find_hit, map_teardown, 1, 1 << 22},
+    {"hash_map/find_miss", map_setup_filled, map_find_miss, map_teardown, 1, 1 << 22},
+    {"hash_map/find_hit_filtered", map_setup_filtered, map_find_hit, map_teardown, 1, 1 << 22},
+    {"hash_map/find_miss_filtered", map_setup_filtered, map_find_miss, map_teardown, 1, 1 << 22},
+    {"hash_map/erase_churn", map_setup_filled, map_erase_churn, map_teardown, 1, 1 << 22},
+    {"hash_map/iterate", map_setup_filled, map_iterate, map_teardown, 1, 1 << 22},
+    {"btree_map/insert_random", tree_setup_empty, tree_insert_random, tree_teardown, 0, 1 << 22},
+    {"btree_map/insert_append", tree_setup_empty, tree_insert_append, tree_teardown, 0, 1 << 22},
+    {"btree_map/find_hit", tree_setup_filled, tree_find_hit, tree_teardown, 1, 1 << 22},
+    {"btree_map/range_scan", tree_setup_filled, tree_range_scan, tree_teardown, 1, 1 << 22},
+    {"priority_queue/push_pop", queue_setup_empty, queue_push_pop, queue_teardown, 0, 1 << 22},
+    {"priority_queue/top_k", queue_setup_empty, queue_top_k, queue_teardown, 1, 0},
+    {"bitset/xor", bits_setup_filled, bits_xor, bits_teardown, 1, 1 << 22},
+    {"bitset/count", bits_setup_filled, bits_count, bits_teardown, 1, 1 << 22},
+    {"bitset/iterate", bits_setup_filled, bits_iterate, bits_teardown, 1, 1 << 22},
+    {"bitset/rank_select", bits_setup_filled, bits_rank_select, bits_teardown, 1, 1 << 22},
+};
+
+/* From a few KiB (L1) up to 128 MiB of uint64_t, past the last level cache of most machines */
+static const size_t default_sizes[] = {1 << 9, 1 << 13, 1 << 17, 1 << 21, 1 << 24};
+static const size_t quick_sizes[] = {1 << 8, 1 << 12};
+
+static void usage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [--json FILE] [--baseline FILE] [--threshold PCT] [--filter TEXT] [--sizes N,N,...] "
+            "[--quick]\n"
+            "  --json FILE       write results as JSON\n"
+            "  --baseline FILE   compare p50 against a previous --json output\n"
+            "  --threshold PCT   slowdown reported as a regression (default 10)\n"
+            "  --filter TEXT     only run benchmarks whose name contains TEXT\n"
+            "  --sizes N,N,...   element counts to run (default L1 to beyond LLC)\n"
+            "  --quick           tiny sizes and few repetitions, a smoke test\n",
+            program);
+}
+
+int main(int argc, char **argv) {
+    const char *json_path = NULL, *baseline_path = NULL, *filter = NULL;
+    double threshold = 10.0;
+    size_t sizes[32], size_count = sizeof(default_sizes) / sizeof(default_sizes[0]);
+    memcpy(sizes, default_sizes, sizeof(default_sizes));
+    bench_options_t options = {5, 200, (size_t)1 << 24};
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--quick") == 0) {
+            size_count = sizeof(quick_sizes) / sizeof(quick_sizes[0]);
+            memcpy(sizes, quick_sizes, sizeof(quick_sizes));
+            options.min_reps = 3;
+            options.max_reps = 5;
+        } else if (value && strcmp(arg, "--json") == 0) {
+            json_path = argv[++i];
+        } else if (value && strcmp(arg, "--baseline") == 0) {
+            baseline_path = argv[++i];
+        } else if (value && strcmp(arg, "--threshold") == 0) {
+            threshold = strtod(argv[++i], NULL);
+        } else if (value && strcmp(arg, "--filter") == 0) {
+            filter = argv[++i];
+        } else if (value && strcmp(arg, "--sizes") == 0) {
+            size_count = 0;
+            for (char *p = argv[++i]; *p && size_count < 32; p += *p == ',') {
+                sizes[size_count++] = (size_t)strtoull(p, &p, 10);
+                if (*p && *p != ',') {
+                    usage(argv[0]);
+                    return 2;
+                }
+            }
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    static bench_result_t results[BENCH_MAX_RESULTS];
+    size_t result_count = 0;
+    printf("%-32s %10s %6s %10s %10s %10s %10s %10s\n", "benchmark", "size", "reps", "min", "p50", "p90", "p99",
+           "cycles");
+    for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+        const bench_case_t *bench = &bench_cases[c];
+        if (filter && !strstr(bench->name, filter)) continue;
+        for (size_t s = 0; s < size_count && result_count < BENCH_MAX_RESULTS; s++) {
+            if (bench->max_size && sizes[s] > bench->max_size) continue;
+            bench_result_t r = bench_run(bench, sizes[s], &options);
+            results[result_count++] = r;
+            printf("%-32s %10zu %6zu %10.2f %10.2f %10.2f %10.2f %10.1f\n", r.name, r.size, r.reps, r.min_ns,
+                   r.p50_ns, r.p90_ns, r.p99_ns, r.cycles_per_op);
+            fflush(stdout);
+        }
+    }
+    printf("(ns per operation; cycles are TSC reference cycles per operation, -1 when unavailable)\n");
+
+    if (json_path) {
+        FILE *out = fopen(json_path, "w");
+        if (!out) {
+            perror(json_path);
+            return 2;
+        }
+        bench_write_json(out, results, result_count);
+        fclose(out);
+    }
+
+    if (baseline_path) {
+        FILE *in = fopen(baseline_path, "r");
+        if (!in) {
+            perror(baseline_path);
+            return 2;
+        }
+        static bench_result_t baseline[BENCH_MAX_RESULTS];
+        size_t baseline_count = bench_read_json(in, baseline, BENCH_MAX_RESULTS);
+        fclose(in);
+        size_t regressions = bench_compare(stdout, results, result_count, baseline, baseline_count, threshold);
+        if (regressions) {
+            printf("%zu benchmark(s) slower than the baseline by more than %.1f%%\n", regressions, threshold);
+            return 1;
+        }
+    }
+    return 0;
+}
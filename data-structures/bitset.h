@@ -0,0 +1,389 @@
+#ifndef _POCKET_DATA_STRUCTURES_BITSET_H
+#define _POCKET_DATA_STRUCTURES_BITSET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "dynamic_array.h"
+
+/*
+ * bitset_t is a growable array of bits packed into 64-bit words, one bit per flag instead of one byte.
+ *
+ * The word array is always a whole number of 256-bit blocks and the bits past the size are kept at zero, so the
+ * bulk operations (AND/OR/XOR/ANDNOT, popcount) run over whole blocks without tail handling. Built with -mavx2 they
+ * use AVX2 for 256 bits at a time and popcount uses the nibble lookup (vpshufb) method; with -mpopcnt single words
+ * use the POPCNT instruction, and find-first/next uses ctz (TZCNT/BSF). Without those flags portable code is used.
+ *
+ * bitset_rank_t is an optional index over a bitset for succinct structures: rank (set bits before a position) and
+ * select (position of the k-th set bit) in O(1) and O(log n) respectively, for about 13% extra space. It points
+ * into the bitset and has to be rebuilt after the bitset changes.
+ */
+
+#define BITSET_WORD_BITS 64
+#define BITSET_BLOCK_WORDS 4 /* 256 bits, one AVX2 register */
+#define BITSET_NPOS SIZE_MAX
+
+typedef struct bitset_t {
+    uint64_t *words;
+    size_t size;      // Bits
+    size_t capacity;  // Words allocated, a multiple of BITSET_BLOCK_WORDS
+} bitset_t;
+
+/*************************************/
+/**************Word helpers***********/
+/*************************************/
+
+static inline unsigned bitset_popcount64(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ull);
+    word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (unsigned)((word * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Index of the lowest set bit, word must not be 0
+static inline unsigned bitset_ctz64(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(word);
+#else
+    unsigned index = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Index of the (rank + 1)-th set bit of word, rank must be below its popcount
+static inline unsigned bitset_select64(uint64_t word, unsigned rank) {
+#if defined(__BMI2__)
+    return bitset_ctz64(_pdep_u64((uint64_t)1 << rank, word));
+#else
+    while (rank--) word &= word - 1;
+    return bitset_ctz64(word);
+#endif
+}
+
+static inline size_t bitset_words_for(size_t bits) { return (bits + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS; }
+
+// Words actually used, rounded up to whole blocks
+static inline size_t bitset_block_words(const bitset_t *bitset) {
+    size_t words = bitset_words_for(bitset->size);
+    return (words + BITSET_BLOCK_WORDS - 1) / BITSET_BLOCK_WORDS * BITSET_BLOCK_WORDS;
+}
+
+static inline uint64_t bitset_popcount_words(const uint64_t *words, size_t count) {
+    uint64_t total = 0;
+    size_t i = 0;
+#if defined(__AVX2__)
+    // Per-nibble counts from a 16-entry table, summed per 64-bit lane by vpsadbw
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1,
+                                           2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+    __m256i sums = _mm256_setzero_si256();
+    for (; i + BITSET_BLOCK_WORDS <= count; i += BITSET_BLOCK_WORDS) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(words + i));
+        __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(block, low_nibbles));
+        __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(block, 4), low_nibbles));
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+    }
+    total += (uint64_t)_mm256_extract_epi64(sums, 0) + (uint64_t)_mm256_extract_epi64(sums, 1) +
+             (uint64_t)_mm256_extract_epi64(sums, 2) + (uint64_t)_mm256_extract_epi64(sums, 3);
+#endif
+    for (; i < count; i++) total += bitset_popcount64(words[i]);
+    return total;
+}
+
+/*************************************/
+/*******Constructors & Destructor*****/
+/*************************************/
+
+static inline int bitset_resize(bitset_t *bitset, size_t bits);
+
+// All bits start cleared. words is NULL if the allocation failed.
+static inline bitset_t bitset_create(size_t bits) {
+    bitset_t bitset = {NULL, 0, 0};
+    if (unlikely_branch(!bitset_resize(&bitset, bits ? bits : 1))) return bitset;
+    bitset.size = bits;
+    return bitset;
+}
+
+static inline void bitset_free(bitset_t *bitset) {
+    POCKET_FREE("bitset_t", bitset->words, bitset->capacity * sizeof(uint64_t));
+    bitset->words = NULL;
+    bitset->size = bitset->capacity = 0;
+}
+
+static inline size_t bitset_size(const bitset_t *bitset) { return bitset->size; }
+
+static inline pocket_memory_usage_t bitset_memory_usage(const bitset_t *bitset) {
+    return pocket_memory_usage_make(bitset_words_for(bitset->size) * sizeof(uint64_t),
+                                    bitset->capacity * sizeof(uint64_t), sizeof(bitset_t));
+}
+
+// Grows or shrinks to bits. New bits are cleared, and so are the ones dropped when shrinking.
+static inline int bitset_resize(bitset_t *bitset, size_t bits) {
+    size_t words = bitset_words_for(bits);
+    size_t needed = (words + BITSET_BLOCK_WORDS - 1) / BITSET_BLOCK_WORDS * BITSET_BLOCK_WORDS;
+    if (needed > bitset->capacity) {
+        size_t new_capacity = bitset->capacity * DYNAMIC_ARRAY_GROWTH_FACTOR;
+        if (new_capacity < needed) new_capacity = needed;
+        uint64_t *new_words = (uint64_t *)POCKET_REALLOC("bitset_t", bitset->words, bitset->capacity * sizeof(uint64_t),
+                                                         new_capacity * sizeof(uint64_t));
+        if (unlikely_branch(!new_words)) return 0;
+        memset(new_words + bitset->capacity, 0, (new_capacity - bitset->capacity) * sizeof(uint64_t));
+        bitset->words = new_words;
+        bitset->capacity = new_capacity;
+    }
+    if (bits < bitset->size) {
+        size_t old_words = bitset_words_for(bitset->size);
+        memset(bitset->words + words, 0, (old_words - words) * sizeof(uint64_t));
+        if (bits % BITSET_WORD_BITS)
+            bitset->words[words - 1] &= ~(uint64_t)0 >> (BITSET_WORD_BITS - bits % BITSET_WORD_BITS);
+    }
+    bitset->size = bits;
+    return 1;
+}
+
+/*************************************/
+/**************Single bits************/
+/*************************************/
+
+static inline bool bitset_test(const bitset_t *bitset, size_t index) {
+    if (unlikely_branch(index >= bitset->size)) return false;
+    return (bitset->words[index / BITSET_WORD_BITS] >> (index % BITSET_WORD_BITS)) & 1;
+}
+
+static inline int bitset_set(bitset_t *bitset, size_t index) {
+    if (unlikely_branch(index >= bitset->size)) return 0;
+    bitset->words[index / BITSET_WORD_BITS] |= (uint64_t)1 << (index % BITSET_WORD_BITS);
+    return 1;
+}
+
+static inline int bitset_clear(bitset_t *bitset, size_t index) {
+    if (unlikely_branch(index >= bitset->size)) return 0;
+    bitset->words[index / BITSET_WORD_BITS] &= ~((uint64_t)1 << (index % BITSET_WORD_BITS));
+    return 1;
+}
+
+static inline int bitset_assign(bitset_t *bitset, size_t index, bool value) {
+    return value ? bitset_set(bitset, index) : bitset_clear(bitset, index);
+}
+
+static inline int bitset_push_back(bitset_t *bitset, bool value) {
+    if (unlikely_branch(!bitset_resize(bitset, bitset->size + 1))) return 0;
+    return value ? bitset_set(bitset, bitset->size - 1) : 1;
+}
+
+// Sets or clears every bit
+static inline void bitset_fill(bitset_t *bitset, bool value) {
+    size_t words = bitset_words_for(bitset->size);
+    memset(bitset->words, value ? 0xFF : 0, words * sizeof(uint64_t));
+    if (value && bitset->size % BITSET_WORD_BITS)
+        bitset->words[words - 1] = ~(uint64_t)0 >> (BITSET_WORD_BITS - bitset->size % BITSET_WORD_BITS);
+}
+
+/*************************************/
+/**************Searching**************/
+/*************************************/
+
+// Index of the first set bit at or after from, BITSET_NPOS if there is none
+static inline size_t bitset_find_next(const bitset_t *bitset, size_t from) {
+    if (from >= bitset->size) return BITSET_NPOS;
+    size_t word_index = from / BITSET_WORD_BITS;
+    size_t words = bitset_words_for(bitset->size);
+    uint64_t word = bitset->words[word_index] & (~(uint64_t)0 << (from % BITSET_WORD_BITS));
+    while (!word) {
+        if (++word_index == words) return BITSET_NPOS;
+        word = bitset->words[word_index];
+    }
+    return word_index * BITSET_WORD_BITS + bitset_ctz64(word);
+}
+
+static inline size_t bitset_find_first(const bitset_t *bitset) { return bitset_find_next(bitset, 0); }
+
+static inline size_t bitset_count(const bitset_t *bitset) {
+    return (size_t)bitset_popcount_words(bitset->words, bitset_block_words(bitset));
+}
+
+/*************************************/
+/**************Bulk operations********/
+/*************************************/
+
+typedef enum bitset_op_t { BITSET_AND, BITSET_OR, BITSET_XOR, BITSET_ANDNOT } bitset_op_t;
+
+// dst = dst OP src over all words. Both bitsets must have the same size, returns 0 otherwise.
+static inline int bitset_apply(bitset_t *dst, const bitset_t *src, bitset_op_t op) {
+    if (unlikely_branch(dst->size != src->size)) return 0;
+    uint64_t *a = dst->words;
+    const uint64_t *b = src->words;
+    size_t words = bitset_block_words(dst);
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i < words; i += BITSET_BLOCK_WORDS) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+        switch (op) {
+            case BITSET_AND: x = _mm256_and_si256(x, y); break;
+            case BITSET_OR: x = _mm256_or_si256(x, y); break;
+            case BITSET_XOR: x = _mm256_xor_si256(x, y); break;
+            case BITSET_ANDNOT: x = _mm256_andnot_si256(y, x); break;
+        }
+        _mm256_storeu_si256((__m256i *)(a + i), x);
+    }
+#endif
+    // The switch is hoisted out of the loops, each loop is simple enough to auto-vectorize
+    switch (op) {
+        case BITSET_AND: for (; i < words; i++) a[i] &= b[i]; break;
+        case BITSET_OR: for (; i < words; i++) a[i] |= b[i]; break;
+        case BITSET_XOR: for (; i < words; i++) a[i] ^= b[i]; break;
+        case BITSET_ANDNOT: for (; i < words; i++) a[i] &= ~b[i]; break;
+    }
+    return 1;
+}
+
+static inline int bitset_and(bitset_t *dst, const bitset_t *src) { return bitset_apply(dst, src, BITSET_AND); }
+static inline int bitset_or(bitset_t *dst, const bitset_t *src) { return bitset_apply(dst, src, BITSET_OR); }
+static inline int bitset_xor(bitset_t *dst, const bitset_t *src) { return bitset_apply(dst, src, BITSET_XOR); }
+static inline int bitset_andnot(bitset_t *dst, const bitset_t *src) { return bitset_apply(dst, src, BITSET_ANDNOT); }
+
+// Inverts every bit
+static inline void bitset_flip_all(bitset_t *bitset) {
+    size_t words = bitset_words_for(bitset->size);
+    for (size_t i = 0; i < words; i++) bitset->words[i] = ~bitset->words[i];
+    if (bitset->size % BITSET_WORD_BITS)
+        bitset->words[words - 1] &= ~(uint64_t)0 >> (BITSET_WORD_BITS - bitset->size % BITSET_WORD_BITS);
+}
+
+// popcount(a AND b) without writing anything, 0 if the sizes differ
+static inline size_t bitset_and_count(const bitset_t *a, const bitset_t *b) {
+    if (unlikely_branch(a->size != b->size)) return 0;
+    size_t words = bitset_block_words(a), total = 0;
+    for (size_t i = 0; i < words; i++) total += bitset_popcount64(a->words[i] & b->words[i]);
+    return total;
+}
+
+/*************************************/
+/**************Rank & select**********/
+/*************************************/
+
+#define BITSET_RANK_BLOCK_WORDS 8     /* One cumulative count per 512 bits */
+#define BITSET_SELECT_SAMPLE 4096     /* Block of every 4096th set bit, bounds the select search */
+
+typedef struct bitset_rank_t {
+    const uint64_t *words;
+    size_t size;
+    size_t ones;
+    uint64_t *block_ranks;     // Set bits before each block, one extra entry holding the total
+    size_t blocks;
+    size_t *select_samples;    // Block holding set bit number i * BITSET_SELECT_SAMPLE
+    size_t samples;
+} bitset_rank_t;
+
+static inline pocket_memory_usage_t bitset_rank_memory_usage(const bitset_rank_t *index) {
+    size_t bytes = index->block_ranks ? (index->blocks + 1) * sizeof(uint64_t) + index->samples * sizeof(size_t) : 0;
+    return pocket_memory_usage_make(bytes, bytes, sizeof(bitset_rank_t));
+}
+
+static inline void bitset_rank_free(bitset_rank_t *index) {
+    POCKET_FREE("bitset_rank_t", index->block_ranks, (index->blocks + 1) * sizeof(uint64_t));
+    POCKET_FREE("bitset_rank_t", index->select_samples, index->samples * sizeof(size_t));
+    memset(index, 0, sizeof(*index));
+}
+
+// Builds the index in one pass over the bitset. Returns 0 if an allocation failed.
+static inline int bitset_rank_build(bitset_rank_t *index, const bitset_t *bitset) {
+    memset(index, 0, sizeof(*index));
+    size_t words = bitset_words_for(bitset->size);
+    size_t blocks = (words + BITSET_RANK_BLOCK_WORDS - 1) / BITSET_RANK_BLOCK_WORDS;
+    uint64_t *block_ranks = (uint64_t *)POCKET_MALLOC("bitset_rank_t", (blocks + 1) * sizeof(uint64_t));
+    if (unlikely_branch(!block_ranks)) return 0;
+    uint64_t ones = 0;
+    for (size_t block = 0; block < blocks; block++) {
+        block_ranks[block] = ones;
+        size_t first = block * BITSET_RANK_BLOCK_WORDS;
+        size_t count = words - first < BITSET_RANK_BLOCK_WORDS ? words - first : BITSET_RANK_BLOCK_WORDS;
+        ones += bitset_popcount_words(bitset->words + first, count);
+    }
+    block_ranks[blocks] = ones;
+
+    size_t samples = (size_t)(ones + BITSET_SELECT_SAMPLE - 1) / BITSET_SELECT_SAMPLE;
+    size_t *select_samples = (size_t *)POCKET_MALLOC("bitset_rank_t", samples * sizeof(size_t));
+    if (unlikely_branch(samples && !select_samples)) {
+        POCKET_FREE("bitset_rank_t", block_ranks, (blocks + 1) * sizeof(uint64_t));
+        return 0;
+    }
+    // Sample i is the last block whose rank is <= i * BITSET_SELECT_SAMPLE
+    size_t block = 0;
+    for (size_t i = 0; i < samples; i++) {
+        uint64_t target = (uint64_t)i * BITSET_SELECT_SAMPLE;
+        while (block + 1 < blocks && block_ranks[block + 1] <= target) block++;
+        select_samples[i] = block;
+    }
+
+    index->words = bitset->words;
+    index->size = bitset->size;
+    index->ones = (size_t)ones;
+    index->block_ranks = block_ranks;
+    index->blocks = blocks;
+    index->select_samples = select_samples;
+    index->samples = samples;
+    return 1;
+}
+
+// Number of set bits in [0, pos)
+static inline size_t bitset_rank(const bitset_rank_t *index, size_t pos) {
+    if (pos >= index->size) return index->ones;
+    size_t word = pos / BITSET_WORD_BITS;
+    size_t block = word / BITSET_RANK_BLOCK_WORDS;
+    size_t first = block * BITSET_RANK_BLOCK_WORDS;
+    uint64_t rank = index->block_ranks[block] + bitset_popcount_words(index->words + first, word - first);
+    if (pos % BITSET_WORD_BITS)
+        rank += bitset_popcount64(index->words[word] << (BITSET_WORD_BITS - pos % BITSET_WORD_BITS));
+    return (size_t)rank;
+}
+
+// Position of the set bit with rank k (the (k + 1)-th one), BITSET_NPOS if there are not that many
+static inline size_t bitset_select(const bitset_rank_t *index, size_t k) {
+    if (k >= index->ones) return BITSET_NPOS;
+    // The samples bound the block, a binary search over the cumulative counts finds it
+    size_t sample = k / BITSET_SELECT_SAMPLE;
+    size_t low = index->select_samples[sample];
+    size_t high = sample + 1 < index->samples ? index->select_samples[sample + 1] + 1 : index->blocks;
+    while (high - low > 1) {
+        size_t mid = low + (high - low) / 2;
+        if (index->block_ranks[mid] <= k)
+            low = mid;
+        else
+            high = mid;
+    }
+    size_t remaining = k - (size_t)index->block_ranks[low];
+    size_t word = low * BITSET_RANK_BLOCK_WORDS;
+    while (1) {
+        unsigned ones = bitset_popcount64(index->words[word]);
+        if (remaining < ones) break;
+        remaining -= ones;
+        word++;
+    }
+    return word * BITSET_WORD_BITS + bitset_select64(index->words[word], (unsigned)remaining);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_BITSET_H
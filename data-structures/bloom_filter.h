@@ -0,0 +1,357 @@
+#ifndef _POCKET_DATA_STRUCTURES_BLOOM_FILTER_H
+#define _POCKET_DATA_STRUCTURES_BLOOM_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pocket_alloc.h"
+
+/*
+ * Approximate membership filters over 64-bit key hashes: "definitely not present" or "maybe present".
+ *
+ * bloom_filter_t is a cache-line-blocked Bloom filter. A key only touches one 64-byte block, so a lookup costs one
+ * cache miss whatever the number of hash functions. It takes adds at any time but cannot forget keys, and it is
+ * sized up front from the expected number of keys and the wanted false positive rate.
+ *
+ * xor_filter_t is an xor8 filter for sets that do not change: built once from all the hashes, it answers with three
+ * byte reads, uses about 9.9 bits per key and has a fixed false positive rate of about 0.4%.
+ *
+ * Both mix the hashes they are given, so weak hashes like FNV-1a of small integers are fine.
+ */
+
+#define BLOOM_FILTER_BLOCK_WORDS 8 /* 512 bits, one cache line */
+#define BLOOM_FILTER_MAX_HASHES 16
+#define BLOOM_FILTER_MAX_BITS_PER_KEY 64
+
+#ifndef BLOOM_FILTER_DEFAULT_FPR
+#define BLOOM_FILTER_DEFAULT_FPR 0.01
+#endif
+
+/* Final mix of MurmurHash3 */
+static inline uint64_t bloom_filter_mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/* Maps a 32-bit value onto [0, range) with a multiply instead of a modulo */
+static inline size_t bloom_filter_reduce(uint32_t value, size_t range) {
+    return (size_t)(((uint64_t)value * range) >> 32);
+}
+
+/* log2(x) for x >= 1 without libm: integer part by halving, then one fraction bit per squaring */
+static inline double bloom_filter_log2(double x) {
+    double result = 0, bit = 0.5;
+    while (x >= 2) {
+        x /= 2;
+        result += 1;
+    }
+    for (int i = 0; i < 24; i++, bit /= 2) {
+        x *= x;
+        if (x >= 2) {
+            x /= 2;
+            result += bit;
+        }
+    }
+    return result;
+}
+
+/* x^n by squaring, n is a small hash count */
+static inline double bloom_filter_pow(double x, unsigned n) {
+    double result = 1;
+    for (; n; n >>= 1, x *= x)
+        if (n & 1) result *= x;
+    return result;
+}
+
+/*************************************/
+/**************Blocked Bloom**********/
+/*************************************/
+
+typedef struct bloom_filter_t {
+    uint64_t *blocks;  // block_count * BLOOM_FILTER_BLOCK_WORDS words, aligned to 64 bytes
+    void *allocation;  // What was actually allocated, blocks points inside it
+    size_t block_count;
+    unsigned hashes;  // Bits set per key
+    double false_positive_rate;
+} bloom_filter_t;
+
+/*
+ * Expected false positive rate at bits_per_key and hashes. The number of keys landing in one block is Poisson with
+ * mean block_bits / bits_per_key, and a block holding i keys answers yes with probability (1 - (1 - 1/B)^(k i))^k.
+ * The Poisson weights are summed up as they go instead of being scaled by e^-mean, which keeps libm out.
+ */
+static inline double bloom_filter_block_rate(double bits_per_key, unsigned hashes) {
+    double block_bits = BLOOM_FILTER_BLOCK_WORDS * 64, mean = block_bits / bits_per_key;
+    double keep = bloom_filter_pow(1 - 1 / block_bits, hashes);  // Chance a bit survives one more key
+    double weight = 1, weights = 0, rate = 0, clear = 1;
+    for (unsigned keys = 0;; keys++) {
+        rate += weight * bloom_filter_pow(1 - clear, hashes);
+        weights += weight;
+        if (keys > mean && weight < rate * 1e-4) break;  // The rest of the tail adds at most a few weights
+        weight *= mean / (keys + 1);
+        clear *= keep;
+    }
+    return rate / weights;
+}
+
+/* The hash count with the lowest rate at bits_per_key, searched from a nearby count (the rate is unimodal in it) */
+static inline unsigned bloom_filter_best_hashes(double bits_per_key, unsigned hashes, double *rate) {
+    *rate = bloom_filter_block_rate(bits_per_key, hashes);
+    double other;
+    if (hashes > 1 && (other = bloom_filter_block_rate(bits_per_key, hashes - 1)) <= *rate) {
+        do {
+            *rate = other;
+            hashes--;
+        } while (hashes > 1 && (other = bloom_filter_block_rate(bits_per_key, hashes - 1)) <= *rate);
+        return hashes;
+    }
+    while (hashes < BLOOM_FILTER_MAX_HASHES && (other = bloom_filter_block_rate(bits_per_key, hashes + 1)) < *rate) {
+        *rate = other;
+        hashes++;
+    }
+    return hashes;
+}
+
+/*
+ * Sized for expected_items keys at false_positive_rate (BLOOM_FILTER_DEFAULT_FPR if outside (0, 1)). blocks is NULL
+ * if the allocation failed.
+ *
+ * Blocking costs bits: about 10 per key at 1%, 22 at 0.01% and 39 at 0.0001%, against 9.6, 19 and 29 for a plain
+ * Bloom filter. Rates below about 1e-8 would need more than BLOOM_FILTER_MAX_BITS_PER_KEY bits per key, they get
+ * that many bits and a rate of about 1e-8.
+ */
+static inline bloom_filter_t bloom_filter_create(size_t expected_items, double false_positive_rate) {
+    bloom_filter_t filter = {NULL, NULL, 0, 0, 0};
+    if (!(false_positive_rate > 0 && false_positive_rate < 1)) false_positive_rate = BLOOM_FILTER_DEFAULT_FPR;
+    if (expected_items == 0) expected_items = 1;
+
+    // The plain Bloom filter size is a lower bound: grow it by 5% until the rate is met, then bisect the last step
+    double max_bits = BLOOM_FILTER_MAX_BITS_PER_KEY;
+    double rate, low = bloom_filter_log2(1 / false_positive_rate) * 1.4427;
+    if (low < 1) low = 1;
+    if (low > max_bits) low = max_bits;
+    double high = low;
+    unsigned hashes = (unsigned)(high * 0.6931 + 0.5);
+    if (hashes < 1) hashes = 1;
+    if (hashes > BLOOM_FILTER_MAX_HASHES) hashes = BLOOM_FILTER_MAX_HASHES;
+    hashes = bloom_filter_best_hashes(high, hashes, &rate);
+    while (rate > false_positive_rate && high < max_bits) {
+        low = high;
+        high = high * 1.05 < max_bits ? high * 1.05 : max_bits;
+        hashes = bloom_filter_best_hashes(high, hashes, &rate);
+    }
+    for (int i = 0; i < 3 && high > low; i++) {
+        double middle = (low + high) / 2;
+        unsigned middle_hashes = bloom_filter_best_hashes(middle, hashes, &rate);
+        if (rate > false_positive_rate) {
+            low = middle;
+        } else {
+            high = middle;
+            hashes = middle_hashes;
+        }
+    }
+    double bits = (double)expected_items * high;
+    size_t block_bits = BLOOM_FILTER_BLOCK_WORDS * 64;
+    size_t block_count = (size_t)(bits / (double)block_bits) + 1;
+
+    size_t bytes = block_count * BLOOM_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+    void *allocation = POCKET_CALLOC("bloom_filter_t", 1, bytes + 63);
+    if (!allocation) return filter;
+    filter.allocation = allocation;
+    filter.blocks = (uint64_t *)(((uintptr_t)allocation + 63) & ~(uintptr_t)63);
+    filter.block_count = block_count;
+    filter.hashes = hashes;
+    filter.false_positive_rate = false_positive_rate;
+    return filter;
+}
+
+static inline void bloom_filter_free(bloom_filter_t *filter) {
+    if (filter->allocation)
+        POCKET_FREE("bloom_filter_t", filter->allocation,
+                    filter->block_count * BLOOM_FILTER_BLOCK_WORDS * sizeof(uint64_t) + 63);
+    memset(filter, 0, sizeof(*filter));
+}
+
+static inline void bloom_filter_clear(bloom_filter_t *filter) {
+    memset(filter->blocks, 0, filter->block_count * BLOOM_FILTER_BLOCK_WORDS * sizeof(uint64_t));
+}
+
+/*
+ * The block comes from the high half of the mixed hash, the bit positions from the top 9 bits of a 64-bit LCG seeded
+ * with the whole hash. Adding a fixed step instead would make every key's bits depend on only about 18 bits of the
+ * hash, so that keys sharing a block also share their bits far more often than the sizing assumes.
+ */
+static inline uint64_t bloom_filter_next_position(uint64_t position, uint64_t step) {
+    return position * 0x5851F42D4C957F2Dull + step;
+}
+
+static inline void bloom_filter_add(bloom_filter_t *filter, uint64_t hash) {
+    hash = bloom_filter_mix(hash);
+    uint64_t *block = filter->blocks + bloom_filter_reduce((uint32_t)(hash >> 32), filter->block_count) *
+                                           BLOOM_FILTER_BLOCK_WORDS;
+    uint64_t position = hash, step = (hash * 0xC2B2AE3D27D4EB4Full) | 1;
+    for (unsigned i = 0; i < filter->hashes; i++) {
+        position = bloom_filter_next_position(position, step);
+        block[position >> 61] |= (uint64_t)1 << ((position >> 55) & 63);
+    }
+}
+
+static inline bool bloom_filter_may_contain(const bloom_filter_t *filter, uint64_t hash) {
+    hash = bloom_filter_mix(hash);
+    const uint64_t *block = filter->blocks + bloom_filter_reduce((uint32_t)(hash >> 32), filter->block_count) *
+                                                 BLOOM_FILTER_BLOCK_WORDS;
+    uint64_t position = hash, step = (hash * 0xC2B2AE3D27D4EB4Full) | 1;
+    uint64_t found = 1;
+    for (unsigned i = 0; i < filter->hashes; i++) {
+        position = bloom_filter_next_position(position, step);
+        found &= block[position >> 61] >> ((position >> 55) & 63);
+    }
+    return found & 1;
+}
+
+static inline pocket_memory_usage_t bloom_filter_memory_usage(const bloom_filter_t *filter) {
+    size_t bytes = filter->block_count * BLOOM_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+    return pocket_memory_usage_make(bytes, bytes, filter->allocation ? 63 : 0);
+}
+
+/*************************************/
+/**************Xor filter*************/
+/*************************************/
+
+#define XOR_FILTER_MAX_ATTEMPTS 64
+
+typedef struct xor_filter_t {
+    uint8_t *fingerprints;  // 3 segments of segment_length
+    size_t segment_length;
+    size_t size;  // Distinct keys
+    uint64_t seed;
+} xor_filter_t;
+
+static inline uint8_t xor_filter_fingerprint(uint64_t hash) { return (uint8_t)(hash ^ (hash >> 32)); }
+
+static inline size_t xor_filter_slot(const xor_filter_t *filter, uint64_t hash, unsigned segment) {
+    uint64_t rotated = segment ? (hash << (21 * segment)) | (hash >> (64 - 21 * segment)) : hash;
+    return bloom_filter_reduce((uint32_t)rotated, filter->segment_length) + segment * filter->segment_length;
+}
+
+static inline int xor_filter_compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static inline void xor_filter_free(xor_filter_t *filter) {
+    POCKET_FREE("xor_filter_t", filter->fingerprints, 3 * filter->segment_length);
+    memset(filter, 0, sizeof(*filter));
+}
+
+/*
+ * Builds the filter for the given hashes (duplicates are fine). Peels the 3-hypergraph of keys and slots, retrying
+ * with another seed in the rare case it has a cycle. Returns false if an allocation failed.
+ */
+static inline bool xor_filter_build(xor_filter_t *filter, const uint64_t *hashes, size_t count) {
+    typedef struct xor_filter_slot_t {
+        uint64_t keys;  // Xor of the mixed hashes of the keys mapped here
+        uint32_t count;
+    } xor_filter_slot_t;
+
+    memset(filter, 0, sizeof(*filter));
+    uint64_t *keys = (uint64_t *)POCKET_MALLOC("xor_filter_t", (count + 1) * sizeof(uint64_t));
+    if (!keys) return false;
+    memcpy(keys, hashes, count * sizeof(uint64_t));
+    qsort(keys, count, sizeof(uint64_t), xor_filter_compare_u64);
+    size_t distinct = 0;
+    for (size_t i = 0; i < count; i++)
+        if (distinct == 0 || keys[i] != keys[distinct - 1]) keys[distinct++] = keys[i];
+
+    filter->size = distinct;
+    filter->segment_length = (32 + distinct * 123 / 100) / 3 + 1;
+    size_t capacity = 3 * filter->segment_length;
+    filter->fingerprints = (uint8_t *)POCKET_CALLOC("xor_filter_t", capacity, 1);
+    xor_filter_slot_t *slots = (xor_filter_slot_t *)POCKET_MALLOC("xor_filter_t", capacity * sizeof(xor_filter_slot_t));
+    size_t *queue = (size_t *)POCKET_MALLOC("xor_filter_t", capacity * sizeof(size_t));
+    uint64_t *order_hashes = (uint64_t *)POCKET_MALLOC("xor_filter_t", (distinct + 1) * sizeof(uint64_t));
+    size_t *order_slots = (size_t *)POCKET_MALLOC("xor_filter_t", (distinct + 1) * sizeof(size_t));
+    bool built = false;
+    if (filter->fingerprints && slots && queue && order_hashes && order_slots) {
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+        for (int attempt = 0; attempt < XOR_FILTER_MAX_ATTEMPTS && !built; attempt++, seed += 0x9E3779B97F4A7C15ull) {
+            filter->seed = seed;
+            memset(slots, 0, capacity * sizeof(xor_filter_slot_t));
+            for (size_t i = 0; i < distinct; i++) {
+                uint64_t hash = bloom_filter_mix(keys[i] + seed);
+                for (unsigned segment = 0; segment < 3; segment++) {
+                    xor_filter_slot_t *slot = &slots[xor_filter_slot(filter, hash, segment)];
+                    slot->keys ^= hash;
+                    slot->count++;
+                }
+            }
+
+            // Repeatedly take a slot with a single key, remember it and remove that key everywhere
+            size_t queued = 0, peeled = 0;
+            for (size_t i = 0; i < capacity; i++)
+                if (slots[i].count == 1) queue[queued++] = i;
+            while (queued > 0) {
+                size_t index = queue[--queued];
+                if (slots[index].count != 1) continue;
+                uint64_t hash = slots[index].keys;
+                order_hashes[peeled] = hash;
+                order_slots[peeled++] = index;
+                for (unsigned segment = 0; segment < 3; segment++) {
+                    size_t other = xor_filter_slot(filter, hash, segment);
+                    slots[other].keys ^= hash;
+                    if (--slots[other].count == 1) queue[queued++] = other;
+                }
+            }
+            built = peeled == distinct;
+        }
+    }
+
+    // Assign in reverse peeling order, so each key's slot is the last of its three to be written
+    if (built) {
+        memset(filter->fingerprints, 0, capacity);
+        for (size_t i = distinct; i-- > 0;) {
+            uint64_t hash = order_hashes[i];
+            uint8_t fingerprint = xor_filter_fingerprint(hash);
+            for (unsigned segment = 0; segment < 3; segment++)
+                fingerprint ^= filter->fingerprints[xor_filter_slot(filter, hash, segment)];
+            filter->fingerprints[order_slots[i]] = fingerprint;
+        }
+    }
+    POCKET_FREE("xor_filter_t", keys, (count + 1) * sizeof(uint64_t));
+    POCKET_FREE("xor_filter_t", slots, capacity * sizeof(xor_filter_slot_t));
+    POCKET_FREE("xor_filter_t", queue, capacity * sizeof(size_t));
+    POCKET_FREE("xor_filter_t", order_hashes, (distinct + 1) * sizeof(uint64_t));
+    POCKET_FREE("xor_filter_t", order_slots, (distinct + 1) * sizeof(size_t));
+    if (!built) xor_filter_free(filter);
+    return built;
+}
+
+static inline bool xor_filter_may_contain(const xor_filter_t *filter, uint64_t hash) {
+    if (!filter->fingerprints) return false;
+    hash = bloom_filter_mix(hash + filter->seed);
+    uint8_t fingerprint = xor_filter_fingerprint(hash);
+    fingerprint ^= filter->fingerprints[xor_filter_slot(filter, hash, 0)];
+    fingerprint ^= filter->fingerprints[xor_filter_slot(filter, hash, 1)];
+    fingerprint ^= filter->fingerprints[xor_filter_slot(filter, hash, 2)];
+    return fingerprint == 0;
+}
+
+static inline pocket_memory_usage_t xor_filter_memory_usage(const xor_filter_t *filter) {
+    return pocket_memory_usage_make(3 * filter->segment_length, 3 * filter->segment_length, sizeof(xor_filter_t));
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_BLOOM_FILTER_H
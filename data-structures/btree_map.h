@@ -0,0 +1,701 @@
+#ifndef _POCKET_DATA_STRUCTURES_BTREE_MAP_H
+#define _POCKET_DATA_STRUCTURES_BTREE_MAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pocket_alloc.h"
+
+/*
+ * Ordered map as a B+ tree.
+ *
+ *   BTREE_MAP_DECLARE(series, uint64_t, double)
+ *   BTREE_MAP_IMPLEMENT(series, uint64_t, double, default_compare_uint64)
+ *
+ * Nodes are BTREE_MAP_NODE_BYTES wide (a few cache lines) and keep their keys in one contiguous array that is
+ * searched with a branchless binary search; all of a node's key lines are prefetched together when the descent
+ * reaches it. Values only live in the leaves, and the leaves are linked in both directions, so a range scan is a
+ * lower_bound followed by a walk along the leaves:
+ *
+ *   for (series_it_t it = series_lower_bound(&map, from); series_it_valid(&it) && series_it_key(&it) < to;
+ *        series_it_next(&it)) { ... }
+ *
+ * CMP(a, b) returns <0, 0 or >0 like strcmp. It may be a function or a function-like macro and is expanded inside
+ * the search loops, so it gets inlined.
+ *
+ * Keys larger than the current maximum (time series, sequential ids) are appended to the last leaf without a
+ * descent, and a full node on the right edge of the tree is split so that its left half stays full. Erase borrows
+ * from or merges with a sibling when a node drops below half full. Inserting or erasing invalidates iterators.
+ */
+
+#ifndef BTREE_MAP_NODE_BYTES
+#define BTREE_MAP_NODE_BYTES 512
+#endif
+
+/* Bounds the path kept while descending, far above the height of any tree that fits in memory */
+#define BTREE_MAP_MAX_HEIGHT 64
+
+/* Entries per node for a given entry size, never fewer than 4 so splits and merges stay well defined */
+#define BTREE_MAP_NODE_CAPACITY(ENTRY_BYTES) \
+    (BTREE_MAP_NODE_BYTES / (ENTRY_BYTES) < 4 ? 4 : BTREE_MAP_NODE_BYTES / (ENTRY_BYTES))
+
+/* Requests every cache line of a node at once, so searching it waits for one miss instead of one per step */
+static inline void btree_map_prefetch(const void *node, size_t bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+    for (size_t offset = 0; offset < bytes; offset += 64) __builtin_prefetch((const char *)node + offset);
+#else
+    (void)node;
+    (void)bytes;
+#endif
+}
+
+/* Provides some default comparison functions */
+static inline int default_compare_int(int a, int b) { return (a > b) - (a < b); }
+static inline int default_compare_uint64(uint64_t a, uint64_t b) { return (a > b) - (a < b); }
+static inline int default_compare_int64(int64_t a, int64_t b) { return (a > b) - (a < b); }
+static inline int default_compare_double(double a, double b) { return (a > b) - (a < b); }
+static inline int default_compare_cstr(const char *a, const char *b) { return strcmp(a, b); }
+
+#define BTREE_MAP_DECLARE(DECL_NAME, KEY_TYPE, VALUE_TYPE)                                                        \
+    enum {                                                                                                        \
+        DECL_NAME##_LEAF_CAPACITY = BTREE_MAP_NODE_CAPACITY(sizeof(KEY_TYPE) + sizeof(VALUE_TYPE)),               \
+        DECL_NAME##_INNER_CAPACITY = BTREE_MAP_NODE_CAPACITY(sizeof(KEY_TYPE) + sizeof(void *)),                  \
+    };                                                                                                            \
+                                                                                                                  \
+    /* Both node types start with this header */                                                                  \
+    typedef struct DECL_NAME##_node_t {                                                                           \
+        uint32_t count; /* Number of keys */                                                                      \
+        uint32_t is_leaf;                                                                                         \
+    } DECL_NAME##_node_t;                                                                                         \
+                                                                                                                  \
+    typedef struct DECL_NAME##_leaf_t {                                                                           \
+        DECL_NAME##_node_t header;                                                                                \
+        struct DECL_NAME##_leaf_t *prev;                                                                          \
+        struct DECL_NAME##_leaf_t *next;                                                                          \
+        KEY_TYPE keys[DECL_NAME##_LEAF_CAPACITY];                                                                 \
+        VALUE_TYPE values[DECL_NAME##_LEAF_CAPACITY];                                                             \
+    } DECL_NAME##_leaf_t;                                                                                         \
+                                                                                                                  \
+    /* Keys under children[i] are < keys[i], keys under children[i + 1] are >= keys[i] */                         \
+    typedef struct DECL_NAME##_inner_t {                                                                          \
+        DECL_NAME##_node_t header;                                                                                \
+        KEY_TYPE keys[DECL_NAME##_INNER_CAPACITY];                                                                \
+        DECL_NAME##_node_t *children[DECL_NAME##_INNER_CAPACITY + 1];                                             \
+    } DECL_NAME##_inner_t;                                                                                        \
+                                                                                                                  \
+    typedef struct DECL_NAME##_t {                                                                                \
+        DECL_NAME##_node_t *root;                                                                                 \
+        DECL_NAME##_leaf_t *first; /* Ends of the leaf list */                                                    \
+        DECL_NAME##_leaf_t *last;                                                                                 \
+        size_t size;                                                                                              \
+        size_t height; /* 1 when the root is a leaf */                                                            \
+        size_t leaf_count;                                                                                        \
+        size_t inner_count;                                                                                       \
+    } DECL_NAME##_t;                                                                                              \
+                                                                                                                  \
+    DECL_NAME##_t DECL_NAME##_create(void);                                                                       \
+    void DECL_NAME##_free(DECL_NAME##_t *map);                                                                    \
+    size_t DECL_NAME##_size(const DECL_NAME##_t *map);                                                            \
+    VALUE_TYPE *DECL_NAME##_find(DECL_NAME##_t *map, KEY_TYPE key);                                               \
+                                                                                                                  \
+    /* Inserts or overwrites. Returns false if an allocation failed, the map is then unchanged. */                \
+    bool DECL_NAME##_insert(DECL_NAME##_t *map, KEY_TYPE key, VALUE_TYPE value);                                  \
+    bool DECL_NAME##_erase(DECL_NAME##_t *map, KEY_TYPE key);                                                     \
+                                                                                                                  \
+    /* Replaces the contents with count strictly increasing keys, building full leaves bottom-up in O(count).     \
+       Returns false (and leaves the map empty) if the keys are not sorted or an allocation failed. */            \
+    bool DECL_NAME##_bulk_load(DECL_NAME##_t *map, const KEY_TYPE *keys, const VALUE_TYPE *values, size_t count); \
+                                                                                                                  \
+    /* Bytes in live entries vs. all leaf slots, inner nodes and leaf links count as overhead */                  \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *map);                                     \
+                                                                                                                  \
+    typedef struct DECL_NAME##_it_t {                                                                             \
+        DECL_NAME##_leaf_t *leaf; /* NULL once past either end */                                                 \
+        size_t index;                                                                                             \
+    } DECL_NAME##_it_t;                                                                                           \
+                                                                                                                  \
+    /* First entry with a key >= key, and first with a key > key */                                               \
+    DECL_NAME##_it_t DECL_NAME##_lower_bound(DECL_NAME##_t *map, KEY_TYPE key);                                   \
+    DECL_NAME##_it_t DECL_NAME##_upper_bound(DECL_NAME##_t *map, KEY_TYPE key);                                   \
+                                                                                                                  \
+    /* Smallest and largest entry */                                                                              \
+    DECL_NAME##_it_t DECL_NAME##_it_begin(DECL_NAME##_t *map);                                                    \
+    DECL_NAME##_it_t DECL_NAME##_it_last(DECL_NAME##_t *map);                                                     \
+                                                                                                                  \
+    bool DECL_NAME##_it_valid(const DECL_NAME##_it_t *it);                                                        \
+                                                                                                                  \
+    /* Move to the next/previous entry in key order. Return false when running off the end. */                    \
+    bool DECL_NAME##_it_next(DECL_NAME##_it_t *it);                                                               \
+    bool DECL_NAME##_it_prev(DECL_NAME##_it_t *it);                                                               \
+                                                                                                                  \
+    KEY_TYPE DECL_NAME##_it_key(const DECL_NAME##_it_t *it);                                                      \
+    VALUE_TYPE *DECL_NAME##_it_value(const DECL_NAME##_it_t *it);
+
+#define BTREE_MAP_IMPLEMENT(DECL_NAME, KEY_TYPE, VALUE_TYPE, CMP)                                                     \
+                                                                                                                      \
+    /* Number of keys < key, or <= key when inclusive is 1. The trip count only depends on count and the              \
+       comparison compiles to a conditional move, so there is no branch to mispredict. */                             \
+    static inline size_t DECL_NAME##_search(const KEY_TYPE *keys, size_t count, KEY_TYPE key, int inclusive) {        \
+        if (count == 0) return 0;                                                                                     \
+        const KEY_TYPE *base = keys;                                                                                  \
+        while (count > 1) {                                                                                           \
+            size_t half = count / 2;                                                                                  \
+            base = CMP(base[half], key) < inclusive ? base + half : base;                                             \
+            count -= half;                                                                                            \
+        }                                                                                                             \
+        return (size_t)(base - keys) + (CMP(*base, key) < inclusive);                                                 \
+    }                                                                                                                 \
+                                                                                                                      \
+    static DECL_NAME##_leaf_t *DECL_NAME##_new_leaf(DECL_NAME##_t *map) {                                             \
+        DECL_NAME##_leaf_t *leaf = (DECL_NAME##_leaf_t *)POCKET_MALLOC(#DECL_NAME, sizeof(DECL_NAME##_leaf_t));       \
+        if (!leaf) return NULL;                                                                                       \
+        leaf->header.count = 0;                                                                                       \
+        leaf->header.is_leaf = 1;                                                                                     \
+        leaf->prev = leaf->next = NULL;                                                                               \
+        map->leaf_count++;                                                                                            \
+        return leaf;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    static DECL_NAME##_inner_t *DECL_NAME##_new_inner(DECL_NAME##_t *map) {                                           \
+        DECL_NAME##_inner_t *inner =                                                                                  \
+            (DECL_NAME##_inner_t *)POCKET_MALLOC(#DECL_NAME, sizeof(DECL_NAME##_inner_t));                            \
+        if (!inner) return NULL;                                                                                      \
+        inner->header.count = 0;                                                                                      \
+        inner->header.is_leaf = 0;                                                                                    \
+        map->inner_count++;                                                                                           \
+        return inner;                                                                                                 \
+    }                                                                                                                 \
+                                                                                                                      \
+    static void DECL_NAME##_free_node(DECL_NAME##_t *map, DECL_NAME##_node_t *node) {                                 \
+        if (node->is_leaf) {                                                                                          \
+            POCKET_FREE(#DECL_NAME, node, sizeof(DECL_NAME##_leaf_t));                                                \
+            map->leaf_count--;                                                                                        \
+        } else {                                                                                                      \
+            POCKET_FREE(#DECL_NAME, node, sizeof(DECL_NAME##_inner_t));                                               \
+            map->inner_count--;                                                                                       \
+        }                                                                                                             \
+    }                                                                                                                 \
+                                                                                                                      \
+    static void DECL_NAME##_free_subtree(DECL_NAME##_t *map, DECL_NAME##_node_t *node) {                              \
+        if (!node->is_leaf) {                                                                                         \
+            DECL_NAME##_inner_t *inner = (DECL_NAME##_inner_t *)node;                                                 \
+            for (size_t i = 0; i <= inner->header.count; i++) DECL_NAME##_free_subtree(map, inner->children[i]);      \
+        }                                                                                                             \
+        DECL_NAME##_free_node(map, node);                                                                             \
+    }                                                                                                                 \
+                                                                                                                      \
+    DECL_NAME##_t DECL_NAME##_create(void) {                                                                          \
+        DECL_NAME##_t map = {0};                                                                                      \
+        return map;                                                                                                   \
+    }                                                                                                                 \
+                                                                                                                      \
+    void DECL_NAME##_free(DECL_NAME##_t *map) {                                                                       \
+        if (map->root) DECL_NAME##_free_subtree(map, map->root);                                                      \
+        *map = DECL_NAME##_create();                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    size_t DECL_NAME##_size(const DECL_NAME##_t *map) { return map->size; }                                           \
+                                                                                                                      \
+    enum {                                                                                                            \
+        DECL_NAME##_PREFETCH_BYTES = offsetof(DECL_NAME##_leaf_t, values) > offsetof(DECL_NAME##_inner_t, children)   \
+                                         ? offsetof(DECL_NAME##_leaf_t, values)                                       \
+                                         : offsetof(DECL_NAME##_inner_t, children)                                    \
+    };                                                                                                                \
+                                                                                                                      \
+    static DECL_NAME##_leaf_t *DECL_NAME##_find_leaf(const DECL_NAME##_t *map, KEY_TYPE key) {                        \
+        DECL_NAME##_node_t *node = map->root;                                                                         \
+        while (!node->is_leaf) {                                                                                      \
+            DECL_NAME##_inner_t *inner = (DECL_NAME##_inner_t *)node;                                                 \
+            node = inner->children[DECL_NAME##_search(inner->keys, inner->header.count, key, 1)];                     \
+            /* Header and keys of either node type, values and children are only needed later */                      \
+            btree_map_prefetch(node, DECL_NAME##_PREFETCH_BYTES);                                                     \
+        }                                                                                                             \
+        return (DECL_NAME##_leaf_t *)node;                                                                            \
+    }                                                                                                                 \
+                                                                                                                      \
+    VALUE_TYPE *DECL_NAME##_find(DECL_NAME##_t *map, KEY_TYPE key) {                                                  \
+        if (!map->root) return NULL;                                                                                  \
+        DECL_NAME##_leaf_t *leaf = DECL_NAME##_find_leaf(map, key);                                                   \
+        size_t index = DECL_NAME##_search(leaf->keys, leaf->header.count, key, 0);                                    \
+        if (index < leaf->header.count && CMP(leaf->keys[index], key) == 0) return &leaf->values[index];              \
+        return NULL;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    /*************************************/                                                                           \
+    /**************Insert*****************/                                                                           \
+    /*************************************/                                                                           \
+                                                                                                                      \
+    static void DECL_NAME##_leaf_insert_at(DECL_NAME##_leaf_t *leaf, size_t index, KEY_TYPE key, VALUE_TYPE value) {  \
+        size_t tail = leaf->header.count - index;                                                                     \
+        memmove(&leaf->keys[index + 1], &leaf->keys[index], tail * sizeof(KEY_TYPE));                                 \
+        memmove(&leaf->values[index + 1], &leaf->values[index], tail * sizeof(VALUE_TYPE));                           \
+        leaf->keys[index] = key;                                                                                      \
+        leaf->values[index] = value;                                                                                  \
+        leaf->header.count++;                                                                                         \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Inserts separator key at index and the node right of it at index + 1 */                                        \
+    static void DECL_NAME##_inner_insert_at(DECL_NAME##_inner_t *inner, size_t index, KEY_TYPE key,                   \
+                                            DECL_NAME##_node_t *child) {                                              \
+        size_t tail = inner->header.count - index;                                                                    \
+        memmove(&inner->keys[index + 1], &inner->keys[index], tail * sizeof(KEY_TYPE));                               \
+        memmove(&inner->children[index + 2], &inner->children[index + 1], tail * sizeof(DECL_NAME##_node_t *));       \
+        inner->keys[index] = key;                                                                                     \
+        inner->children[index + 1] = child;                                                                           \
+        inner->header.count++;                                                                                        \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Moves the upper part of a full leaf into right while inserting key at index. Inserting past the end of the     \
+       last leaf keeps the left leaf full and starts right with the new key only. */                                  \
+    static void DECL_NAME##_split_leaf(DECL_NAME##_t *map, DECL_NAME##_leaf_t *leaf, DECL_NAME##_leaf_t *right,       \
+                                       size_t index, KEY_TYPE key, VALUE_TYPE value) {                                \
+        const size_t capacity = DECL_NAME##_LEAF_CAPACITY;                                                            \
+        size_t left_count = index == capacity && !leaf->next ? capacity : (capacity + 1) / 2;                         \
+        size_t from = index < left_count ? left_count - 1 : left_count;                                               \
+        memcpy(right->keys, &leaf->keys[from], (capacity - from) * sizeof(KEY_TYPE));                                 \
+        memcpy(right->values, &leaf->values[from], (capacity - from) * sizeof(VALUE_TYPE));                           \
+        right->header.count = (uint32_t)(capacity - from);                                                            \
+        leaf->header.count = (uint32_t)from;                                                                          \
+        if (index < left_count)                                                                                       \
+            DECL_NAME##_leaf_insert_at(leaf, index, key, value);                                                      \
+        else                                                                                                          \
+            DECL_NAME##_leaf_insert_at(right, index - left_count, key, value);                                        \
+                                                                                                                      \
+        right->prev = leaf;                                                                                           \
+        right->next = leaf->next;                                                                                     \
+        if (leaf->next)                                                                                               \
+            leaf->next->prev = right;                                                                                 \
+        else                                                                                                          \
+            map->last = right;                                                                                        \
+        leaf->next = right;                                                                                           \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Splits a full inner node while inserting (key, child) at index. The middle key moves up through up_key.        \
+       On the right edge of the tree (append) the left node keeps all but one key. */                                 \
+    static void DECL_NAME##_split_inner(DECL_NAME##_inner_t *inner, DECL_NAME##_inner_t *right, size_t index,         \
+                                        KEY_TYPE key, DECL_NAME##_node_t *child, bool append, KEY_TYPE *up_key) {     \
+        const size_t capacity = DECL_NAME##_INNER_CAPACITY;                                                           \
+        KEY_TYPE keys[DECL_NAME##_INNER_CAPACITY + 1];                                                                \
+        DECL_NAME##_node_t *children[DECL_NAME##_INNER_CAPACITY + 2];                                                 \
+        memcpy(keys, inner->keys, index * sizeof(KEY_TYPE));                                                          \
+        memcpy(&keys[index + 1], &inner->keys[index], (capacity - index) * sizeof(KEY_TYPE));                         \
+        memcpy(children, inner->children, (index + 1) * sizeof(DECL_NAME##_node_t *));                                \
+        memcpy(&children[index + 2], &inner->children[index + 1], (capacity - index) * sizeof(DECL_NAME##_node_t *)); \
+        keys[index] = key;                                                                                            \
+        children[index + 1] = child;                                                                                  \
+                                                                                                                      \
+        size_t mid = append && index == capacity ? capacity - 1 : capacity / 2;                                       \
+        memcpy(inner->keys, keys, mid * sizeof(KEY_TYPE));                                                            \
+        memcpy(inner->children, children, (mid + 1) * sizeof(DECL_NAME##_node_t *));                                  \
+        inner->header.count = (uint32_t)mid;                                                                          \
+        memcpy(right->keys, &keys[mid + 1], (capacity - mid) * sizeof(KEY_TYPE));                                     \
+        memcpy(right->children, &children[mid + 1], (capacity - mid + 1) * sizeof(DECL_NAME##_node_t *));             \
+        right->header.count = (uint32_t)(capacity - mid);                                                             \
+        *up_key = keys[mid];                                                                                          \
+    }                                                                                                                 \
+                                                                                                                      \
+    bool DECL_NAME##_insert(DECL_NAME##_t *map, KEY_TYPE key, VALUE_TYPE value) {                                     \
+        if (!map->root) {                                                                                             \
+            DECL_NAME##_leaf_t *leaf = DECL_NAME##_new_leaf(map);                                                     \
+            if (!leaf) return false;                                                                                  \
+            map->root = &leaf->header;                                                                                \
+            map->first = map->last = leaf;                                                                            \
+            map->height = 1;                                                                                          \
+        }                                                                                                             \
+                                                                                                                      \
+        /* Past the current maximum with room in the last leaf: no descent needed */                                  \
+        DECL_NAME##_leaf_t *last = map->last;                                                                         \
+        size_t last_count = last->header.count;                                                                       \
+        if (last_count > 0 && last_count < DECL_NAME##_LEAF_CAPACITY && CMP(last->keys[last_count - 1], key) < 0) {   \
+            last->keys[last_count] = key;                                                                             \
+            last->values[last_count] = value;                                                                         \
+            last->header.count++;                                                                                     \
+            map->size++;                                                                                              \
+            return true;                                                                                              \
+        }                                                                                                             \
+                                                                                                                      \
+        /* Descend, remembering the path and whether it still follows the right edge */                               \
+        DECL_NAME##_inner_t *path[BTREE_MAP_MAX_HEIGHT];                                                              \
+        size_t slots[BTREE_MAP_MAX_HEIGHT];                                                                           \
+        bool right_edge[BTREE_MAP_MAX_HEIGHT];                                                                        \
+        size_t depth = 0;                                                                                             \
+        bool on_edge = true;                                                                                          \
+        DECL_NAME##_node_t *node = map->root;                                                                         \
+        while (!node->is_leaf) {                                                                                      \
+            DECL_NAME##_inner_t *inner = (DECL_NAME##_inner_t *)node;                                                 \
+            size_t slot = DECL_NAME##_search(inner->keys, inner->header.count, key, 1);                               \
+            on_edge = on_edge && slot == inner->header.count;                                                         \
+            path[depth] = inner;                                                                                      \
+            slots[depth] = slot;                                                                                      \
+            right_edge[depth++] = on_edge;                                                                            \
+            node = inner->children[slot];                                                                             \
+            btree_map_prefetch(node, DECL_NAME##_PREFETCH_BYTES);                                                     \
+        }                                                                                                             \
+                                                                                                                      \
+        DECL_NAME##_leaf_t *leaf = (DECL_NAME##_leaf_t *)node;                                                        \
+        size_t index = DECL_NAME##_search(leaf->keys, leaf->header.count, key, 0);                                    \
+        if (index < leaf->header.count && CMP(leaf->keys[index], key) == 0) {                                         \
+            leaf->values[index] = value;                                                                              \
+            return true;                                                                                              \
+        }                                                                                                             \
+        if (leaf->header.count < DECL_NAME##_LEAF_CAPACITY) {                                                         \
+            DECL_NAME##_leaf_insert_at(leaf, index, key, value);                                                      \
+            map->size++;                                                                                              \
+            return true;                                                                                              \
+        }                                                                                                             \
+                                                                                                                      \
+        /* The leaf splits, and so does every full inner node right above it. Allocate all new nodes first so a       \
+           failed allocation leaves the tree untouched. */                                                            \
+        size_t splits = 0;                                                                                            \
+        while (splits < depth && path[depth - 1 - splits]->header.count == DECL_NAME##_INNER_CAPACITY) splits++;      \
+        size_t needed = splits + (splits == depth);                                                                   \
+        DECL_NAME##_inner_t *spare[BTREE_MAP_MAX_HEIGHT + 1];                                                         \
+        size_t allocated = 0;                                                                                         \
+        DECL_NAME##_leaf_t *right_leaf = DECL_NAME##_new_leaf(map);                                                   \
+        while (right_leaf && allocated < needed && (spare[allocated] = DECL_NAME##_new_inner(map))) allocated++;      \
+        if (!right_leaf || allocated < needed) {                                                                      \
+            if (right_leaf) DECL_NAME##_free_node(map, &right_leaf->header);                                          \
+            for (size_t i = 0; i < allocated; i++) DECL_NAME##_free_node(map, &spare[i]->header);                     \
+            return false;                                                                                             \
+        }                                                                                                             \
+                                                                                                                      \
+        DECL_NAME##_split_leaf(map, leaf, right_leaf, index, key, value);                                             \
+        DECL_NAME##_node_t *child = &right_leaf->header;                                                              \
+        KEY_TYPE up_key = right_leaf->keys[0];                                                                        \
+        size_t used = 0;                                                                                              \
+        while (child && depth > 0) {                                                                                  \
+            depth--;                                                                                                  \
+            DECL_NAME##_inner_t *parent = path[depth];                                                                \
+            if (parent->header.count < DECL_NAME##_INNER_CAPACITY) {                                                  \
+                DECL_NAME##_inner_insert_at(parent, slots[depth], up_key, child);                                     \
+                child = NULL;                                                                                         \
+            } else {                                                                                                  \
+                DECL_NAME##_inner_t *right = spare[used++];                                                           \
+                DECL_NAME##_split_inner(parent, right, slots[depth], up_key, child, right_edge[depth], &up_key);      \
+                child = &right->header;                                                                               \
+            }                                                                                                         \
+        }                                                                                                             \
+        /* The root itself split: grow by one level */                                                                \
+        if (child) {                                                                                                  \
+            DECL_NAME##_inner_t *root = spare[used];                                                                  \
+            root->keys[0] = up_key;                                                                                   \
+            root->children[0] = map->root;                                                                            \
+            root->children[1] = child;                                                                                \
+            root->header.count = 1;                                                                                   \
+            map->root = &root->header;                                                                                \
+            map->height++;                                                                                            \
+        }                                                                                                             \
+        map->size++;                                                                                                  \
+        return true;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    /*************************************/                                                                           \
+    /**************Erase******************/                                                                           \
+    /*************************************/                                                                           \
+                                                                                                                      \
+    static size_t DECL_NAME##_min_count(const DECL_NAME##_node_t *node) {                                             \
+        return node->is_leaf ? DECL_NAME##_LEAF_CAPACITY / 2 : DECL_NAME##_INNER_CAPACITY / 2;                        \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Moves the last entry of children[slot - 1] to the front of children[slot] */                                   \
+    static void DECL_NAME##_borrow_left(DECL_NAME##_inner_t *parent, size_t slot) {                                   \
+        DECL_NAME##_node_t *node = parent->children[slot];                                                            \
+        DECL_NAME##_node_t *sibling = parent->children[slot - 1];                                                     \
+        if (node->is_leaf) {                                                                                          \
+            DECL_NAME##_leaf_t *leaf = (DECL_NAME##_leaf_t *)node, *left = (DECL_NAME##_leaf_t *)sibling;             \
+            DECL_NAME##_leaf_insert_at(leaf, 0, left->keys[left->header.count - 1],                                   \
+                                       left->values[left->header.count - 1]);                                         \
+            left->header.count--;                                                                                     \
+            parent->keys[slot - 1] = leaf->keys[0];                                                                   \
+            return;                                                                                                   \
+        }                                                                                                             \
+        DECL_NAME##_inner_t *inner = (DECL_NAME##_inner_t *)node, *left = (DECL_NAME##_inner_t *)sibling;             \
+        size_t count = inner->header.count;                                                                           \
+        memmove(&inner->keys[1], inner->keys, count * sizeof(KEY_TYPE));                                              \
+        memmove(&inner->children[1], inner->children, (count + 1) * sizeof(DECL_NAME##_node_t *));                    \
+        inner->keys[0] = parent->keys[slot - 1];                                                                      \
+        inner->children[0] = left->children[left->header.count];                                                      \
+        inner->header.count++;                                                                                        \
+        parent->keys[slot - 1] = left->keys[left->header.count - 1];                                                  \
+        left->header.count--;                                                                                         \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Moves the first entry of children[slot + 1] to the back of children[slot] */                                   \
+    static void DECL_NAME##_borrow_right(DECL_NAME##_inner_t *parent, size_t slot) {                                  \
+        DECL_NAME##_node_t *node = parent->children[slot];                                                            \
+        DECL_NAME##_node_t *sibling = parent->children[slot + 1];                                                     \
+        size_t count = node->count, sibling_count = sibling->count;                                                   \
+        if (node->is_leaf) {                                                                                          \
+            DECL_NAME##_leaf_t *leaf = (DECL_NAME##_leaf_t *)node, *right = (DECL_NAME##_leaf_t *)sibling;            \
+            leaf->keys[count] = right->keys[0];                                                                       \
+            leaf->values[count] = right->values[0];                                                                   \
+            memmove(right->keys, &right->keys[1], (sibling_count - 1) * sizeof(KEY_TYPE));                            \
+            memmove(right->values, &right->values[1], (sibling_count - 1) * sizeof(VALUE_TYPE));                      \
+            parent->keys[slot] = right->keys[0];                                                                      \
+        } else {                                                                                                      \
+            DECL_NAME##_inner_t *inner = (DECL_NAME##_inner_t *)node, *right = (DECL_NAME##_inner_t *)sibling;        \
+            inner->keys[count] = parent->keys[slot];                                                                  \
+            inner->children[count + 1] = right->children[0];                                                          \
+            parent->keys[slot] = right->keys[0];                                                                      \
+            memmove(right->keys, &right->keys[1], (sibling_count - 1) * sizeof(KEY_TYPE));                            \
+            memmove(right->children, &right->children[1], sibling_count * sizeof(DECL_NAME##_node_t *));              \
+        }                                                                                                             \
+        node->count++;                                                                                                \
+        sibling->count--;                                                                                             \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Appends children[slot + 1] to children[slot] and drops it from the parent */                                   \
+    static void DECL_NAME##_merge(DECL_NAME##_t *map, DECL_NAME##_inner_t *parent, size_t slot) {                     \
+        DECL_NAME##_node_t *node = parent->children[slot];                                                            \
+        DECL_NAME##_node_t *sibling = parent->children[slot + 1];                                                     \
+        size_t count = node->count, sibling_count = sibling->count;                                                   \
+        if (node->is_leaf) {                                                                                          \
+            DECL_NAME##_leaf_t *leaf = (DECL_NAME##_leaf_t *)node, *right = (DECL_NAME##_leaf_t *)sibling;            \
+            memcpy(&leaf->keys[count], right->keys, sibling_count * sizeof(KEY_TYPE));                                \
+            memcpy(&leaf->values[count], right->values, sibling_count * sizeof(VALUE_TYPE));                          \
+            node->count = (uint32_t)(count + sibling_count);                                                          \
+            leaf->next = right->next;                                                                                 \
+            if (right->next)                                                                                          \
+                right->next->prev = leaf;                                                                             \
+            else                                                                                                      \
+                map->last = leaf;                                                                                     \
+        } else {                                                                                                      \
+            DECL_NAME##_inner_t *inner = (DECL_NAME##_inner_t *)node, *right = (DECL_NAME##_inner_t *)sibling;        \
+            inner->keys[count] = parent->keys[slot];                                                                  \
+            memcpy(&inner->keys[count + 1], right->keys, sibling_count * sizeof(KEY_TYPE));                           \
+            memcpy(&inner->children[count + 1], right->children, (sibling_count + 1) * sizeof(DECL_NAME##_node_t *)); \
+            node->count = (uint32_t)(count + 1 + sibling_count);                                                      \
+        }                                                                                                             \
+        size_t tail = parent->header.count - slot - 1;                                                                \
+        memmove(&parent->keys[slot], &parent->keys[slot + 1], tail * sizeof(KEY_TYPE));                               \
+        memmove(&parent->children[slot + 1], &parent->children[slot + 2], tail * sizeof(DECL_NAME##_node_t *));       \
+        parent->header.count--;                                                                                       \
+        DECL_NAME##_free_node(map, sibling);                                                                          \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Fixes an underfull children[slot]. Returns true if it was merged, the parent then lost a key. */               \
+    static bool DECL_NAME##_rebalance(DECL_NAME##_t *map, DECL_NAME##_inner_t *parent, size_t slot) {                 \
+        size_t min = DECL_NAME##_min_count(parent->children[slot]);                                                   \
+        if (slot > 0 && parent->children[slot - 1]->count > min) {                                                    \
+            DECL_NAME##_borrow_left(parent, slot);                                                                    \
+            return false;                                                                                             \
+        }                                                                                                             \
+        if (slot < parent->header.count && parent->children[slot + 1]->count > min) {                                 \
+            DECL_NAME##_borrow_right(parent, slot);                                                                   \
+            return false;                                                                                             \
+        }                                                                                                             \
+        /* Neither sibling can spare an entry, so both halves together fit in one node */                             \
+        DECL_NAME##_merge(map, parent, slot > 0 ? slot - 1 : slot);                                                   \
+        return true;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    bool DECL_NAME##_erase(DECL_NAME##_t *map, KEY_TYPE key) {                                                        \
+        if (!map->root) return false;                                                                                 \
+        DECL_NAME##_inner_t *path[BTREE_MAP_MAX_HEIGHT];                                                              \
+        size_t slots[BTREE_MAP_MAX_HEIGHT];                                                                           \
+        size_t depth = 0;                                                                                             \
+        DECL_NAME##_node_t *node = map->root;                                                                         \
+        while (!node->is_leaf) {                                                                                      \
+            DECL_NAME##_inner_t *inner = (DECL_NAME##_inner_t *)node;                                                 \
+            size_t slot = DECL_NAME##_search(inner->keys, inner->header.count, key, 1);                               \
+            path[depth] = inner;                                                                                      \
+            slots[depth++] = slot;                                                                                    \
+            node = inner->children[slot];                                                                             \
+            btree_map_prefetch(node, DECL_NAME##_PREFETCH_BYTES);                                                     \
+        }                                                                                                             \
+                                                                                                                      \
+        DECL_NAME##_leaf_t *leaf = (DECL_NAME##_leaf_t *)node;                                                        \
+        size_t index = DECL_NAME##_search(leaf->keys, leaf->header.count, key, 0);                                    \
+        if (index == leaf->header.count || CMP(leaf->keys[index], key) != 0) return false;                            \
+        size_t tail = leaf->header.count - index - 1;                                                                 \
+        memmove(&leaf->keys[index], &leaf->keys[index + 1], tail * sizeof(KEY_TYPE));                                 \
+        memmove(&leaf->values[index], &leaf->values[index + 1], tail * sizeof(VALUE_TYPE));                           \
+        leaf->header.count--;                                                                                         \
+        map->size--;                                                                                                  \
+                                                                                                                      \
+        /* Separators are only lower bounds, so they stay valid. Rebalance upwards while merges empty parents. */     \
+        while (depth > 0 && node->count < DECL_NAME##_min_count(node)) {                                              \
+            depth--;                                                                                                  \
+            if (!DECL_NAME##_rebalance(map, path[depth], slots[depth])) break;                                        \
+            node = &path[depth]->header;                                                                              \
+        }                                                                                                             \
+        /* An inner root left with a single child hands the root over to it */                                        \
+        if (!map->root->is_leaf && map->root->count == 0) {                                                           \
+            DECL_NAME##_node_t *old_root = map->root;                                                                 \
+            map->root = ((DECL_NAME##_inner_t *)old_root)->children[0];                                               \
+            DECL_NAME##_free_node(map, old_root);                                                                     \
+            map->height--;                                                                                            \
+        }                                                                                                             \
+        return true;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    /*************************************/                                                                           \
+    /**************Bulk load**************/                                                                           \
+    /*************************************/                                                                           \
+                                                                                                                      \
+    /* Frees a partially built level: the finished nodes [0, done) and the unconsumed ones [pending, width) */        \
+    static void DECL_NAME##_free_level(DECL_NAME##_t *map, DECL_NAME##_node_t **level, size_t done, size_t pending,   \
+                                       size_t width) {                                                                \
+        for (size_t i = 0; i < done; i++) DECL_NAME##_free_subtree(map, level[i]);                                    \
+        for (size_t i = pending; i < width; i++) DECL_NAME##_free_subtree(map, level[i]);                             \
+    }                                                                                                                 \
+                                                                                                                      \
+    bool DECL_NAME##_bulk_load(DECL_NAME##_t *map, const KEY_TYPE *keys, const VALUE_TYPE *values, size_t count) {    \
+        DECL_NAME##_free(map);                                                                                        \
+        if (count == 0) return true;                                                                                  \
+        for (size_t i = 1; i < count; i++) {                                                                          \
+            if (CMP(keys[i - 1], keys[i]) >= 0) return false;                                                         \
+        }                                                                                                             \
+                                                                                                                      \
+        /* Nodes are filled evenly, so every one but a lone root is at least half full */                             \
+        const size_t leaves = (count + DECL_NAME##_LEAF_CAPACITY - 1) / DECL_NAME##_LEAF_CAPACITY;                    \
+        DECL_NAME##_node_t **level =                                                                                  \
+            (DECL_NAME##_node_t **)POCKET_MALLOC(#DECL_NAME, leaves * sizeof(DECL_NAME##_node_t *));                  \
+        KEY_TYPE *mins = (KEY_TYPE *)POCKET_MALLOC(#DECL_NAME, leaves * sizeof(KEY_TYPE));                            \
+        bool ok = level && mins;                                                                                      \
+        size_t width = leaves, offset = 0, built = 0;                                                                 \
+        DECL_NAME##_leaf_t *first = NULL, *prev = NULL;                                                               \
+        for (; ok && built < width; built++) {                                                                        \
+            DECL_NAME##_leaf_t *leaf = DECL_NAME##_new_leaf(map);                                                     \
+            if (!leaf) {                                                                                              \
+                ok = false;                                                                                           \
+                break;                                                                                                \
+            }                                                                                                         \
+            size_t take = count / width + (built < count % width);                                                    \
+            memcpy(leaf->keys, &keys[offset], take * sizeof(KEY_TYPE));                                               \
+            memcpy(leaf->values, &values[offset], take * sizeof(VALUE_TYPE));                                         \
+            leaf->header.count = (uint32_t)take;                                                                      \
+            leaf->prev = prev;                                                                                        \
+            if (prev)                                                                                                 \
+                prev->next = leaf;                                                                                    \
+            else                                                                                                      \
+                first = leaf;                                                                                         \
+            prev = leaf;                                                                                              \
+            level[built] = &leaf->header;                                                                             \
+            mins[built] = keys[offset];                                                                               \
+            offset += take;                                                                                           \
+        }                                                                                                             \
+        if (!ok && level) DECL_NAME##_free_level(map, level, built, width, width);                                    \
+        map->height = 1;                                                                                              \
+                                                                                                                      \
+        /* Each pass groups the nodes of one level under new parents until a single root remains */                   \
+        while (ok && width > 1) {                                                                                     \
+            size_t parents = (width + DECL_NAME##_INNER_CAPACITY) / (DECL_NAME##_INNER_CAPACITY + 1);                 \
+            size_t next = 0;                                                                                          \
+            for (built = 0; built < parents; built++) {                                                               \
+                DECL_NAME##_inner_t *inner = DECL_NAME##_new_inner(map);                                              \
+                if (!inner) {                                                                                         \
+                    DECL_NAME##_free_level(map, level, built, next, width);                                           \
+                    ok = false;                                                                                       \
+                    break;                                                                                            \
+                }                                                                                                     \
+                size_t take = width / parents + (built < width % parents);                                            \
+                inner->children[0] = level[next];                                                                     \
+                for (size_t i = 1; i < take; i++) {                                                                   \
+                    inner->keys[i - 1] = mins[next + i];                                                              \
+                    inner->children[i] = level[next + i];                                                             \
+                }                                                                                                     \
+                inner->header.count = (uint32_t)(take - 1);                                                           \
+                /* Never overwrites a node not consumed yet: built <= next */                                         \
+                level[built] = &inner->header;                                                                        \
+                mins[built] = mins[next];                                                                             \
+                next += take;                                                                                         \
+            }                                                                                                         \
+            width = parents;                                                                                          \
+            map->height++;                                                                                            \
+        }                                                                                                             \
+                                                                                                                      \
+        if (ok) {                                                                                                     \
+            map->root = level[0];                                                                                     \
+            map->first = first;                                                                                       \
+            map->last = prev;                                                                                         \
+            map->size = count;                                                                                        \
+        } else {                                                                                                      \
+            *map = DECL_NAME##_create();                                                                              \
+        }                                                                                                             \
+        POCKET_FREE(#DECL_NAME, level, leaves * sizeof(DECL_NAME##_node_t *));                                        \
+        POCKET_FREE(#DECL_NAME, mins, leaves * sizeof(KEY_TYPE));                                                     \
+        return ok;                                                                                                    \
+    }                                                                                                                 \
+                                                                                                                      \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *map) {                                        \
+        size_t entry_size = sizeof(KEY_TYPE) + sizeof(VALUE_TYPE);                                                    \
+        size_t slots = map->leaf_count * DECL_NAME##_LEAF_CAPACITY * entry_size;                                      \
+        size_t overhead = map->leaf_count * sizeof(DECL_NAME##_leaf_t) - slots +                                      \
+                          map->inner_count * sizeof(DECL_NAME##_inner_t);                                             \
+        return pocket_memory_usage_make(map->size * entry_size, slots, overhead);                                     \
+    }                                                                                                                 \
+                                                                                                                      \
+    /*************************************/                                                                           \
+    /**************Iterators**************/                                                                           \
+    /*************************************/                                                                           \
+                                                                                                                      \
+    static DECL_NAME##_it_t DECL_NAME##_bound(DECL_NAME##_t *map, KEY_TYPE key, int inclusive) {                      \
+        DECL_NAME##_it_t it = {NULL, 0};                                                                              \
+        if (!map->root) return it;                                                                                    \
+        it.leaf = DECL_NAME##_find_leaf(map, key);                                                                    \
+        it.index = DECL_NAME##_search(it.leaf->keys, it.leaf->header.count, key, inclusive);                          \
+        /* Everything in the next leaf is >= the separator that routed key here, so its first entry is the answer */  \
+        if (it.index == it.leaf->header.count) {                                                                      \
+            it.leaf = it.leaf->next;                                                                                  \
+            it.index = 0;                                                                                             \
+        }                                                                                                             \
+        return it;                                                                                                    \
+    }                                                                                                                 \
+                                                                                                                      \
+    DECL_NAME##_it_t DECL_NAME##_lower_bound(DECL_NAME##_t *map, KEY_TYPE key) {                                      \
+        return DECL_NAME##_bound(map, key, 0);                                                                        \
+    }                                                                                                                 \
+                                                                                                                      \
+    DECL_NAME##_it_t DECL_NAME##_upper_bound(DECL_NAME##_t *map, KEY_TYPE key) {                                      \
+        return DECL_NAME##_bound(map, key, 1);                                                                        \
+    }                                                                                                                 \
+                                                                                                                      \
+    DECL_NAME##_it_t DECL_NAME##_it_begin(DECL_NAME##_t *map) {                                                       \
+        DECL_NAME##_it_t it = {map->size ? map->first : NULL, 0};                                                     \
+        return it;                                                                                                    \
+    }                                                                                                                 \
+                                                                                                                      \
+    DECL_NAME##_it_t DECL_NAME##_it_last(DECL_NAME##_t *map) {                                                        \
+        DECL_NAME##_it_t it = {map->size ? map->last : NULL, 0};                                                      \
+        if (it.leaf) it.index = it.leaf->header.count - 1;                                                            \
+        return it;                                                                                                    \
+    }                                                                                                                 \
+                                                                                                                      \
+    bool DECL_NAME##_it_valid(const DECL_NAME##_it_t *it) { return it->leaf != NULL; }                                \
+                                                                                                                      \
+    bool DECL_NAME##_it_next(DECL_NAME##_it_t *it) {                                                                  \
+        if (!it->leaf) return false;                                                                                  \
+        if (++it->index == it->leaf->header.count) {                                                                  \
+            it->leaf = it->leaf->next;                                                                                \
+            it->index = 0;                                                                                            \
+        }                                                                                                             \
+        return it->leaf != NULL;                                                                                      \
+    }                                                                                                                 \
+                                                                                                                      \
+    bool DECL_NAME##_it_prev(DECL_NAME##_it_t *it) {                                                                  \
+        if (!it->leaf) return false;                                                                                  \
+        if (it->index > 0) {                                                                                          \
+            it->index--;                                                                                              \
+            return true;                                                                                              \
+        }                                                                                                             \
+        it->leaf = it->leaf->prev;                                                                                    \
+        it->index = it->leaf ? it->leaf->header.count - 1 : 0;                                                        \
+        return it->leaf != NULL;                                                                                      \
+    }                                                                                                                 \
+                                                                                                                      \
+    KEY_TYPE DECL_NAME##_it_key(const DECL_NAME##_it_t *it) { return it->leaf->keys[it->index]; }                     \
+                                                                                                                      \
+    VALUE_TYPE *DECL_NAME##_it_value(const DECL_NAME##_it_t *it) { return &it->leaf->values[it->index]; }
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_BTREE_MAP_H
@@ -8,6 +8,8 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 
+#include "pocket_alloc.h"
+
 #ifndef DYNAMIC_ARRAY_GROWTH_FACTOR
 #define DYNAMIC_ARRAY_GROWTH_FACTOR 2
 #endif
@@ -58,17 +60,21 @@ extern "C" {
                                                                                 \
     void DECL_NAME##_free(DECL_NAME##_t *dyn_array);                            \
                                                                                 \
-    void DECL_NAME##_clear(DECL_NAME##_t *dyn_array);
+    void DECL_NAME##_clear(DECL_NAME##_t *dyn_array);                           \
+                                                                                \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *dyn_array);
 
 #define DYN_ARRAY_IMPLEMENT(DECL_NAME, TYPE)                                               \
     DECL_NAME##_t *DECL_NAME##_create(size_t starting_capacity)                            \
     {                                                                                      \
-        DECL_NAME##_t *dyn_array = calloc(1, sizeof(DECL_NAME##_t));                       \
+        DECL_NAME##_t *dyn_array =                                                         \
+            (DECL_NAME##_t *)POCKET_CALLOC(#DECL_NAME, 1, sizeof(DECL_NAME##_t));          \
         if (unlikely_branch(!dyn_array))                                                   \
             return NULL;                                                                   \
-        dyn_array->data = malloc(starting_capacity * sizeof(TYPE));                        \
+        dyn_array->data =                                                                  \
+            (TYPE *)POCKET_MALLOC(#DECL_NAME, starting_capacity * sizeof(TYPE));           \
         if (unlikely_branch(!dyn_array->data)) {                                           \
-            free(dyn_array);                                                               \
+            POCKET_FREE(#DECL_NAME, dyn_array, sizeof(DECL_NAME##_t));                     \
             return NULL;                                                                   \
         }                                                                                  \
         dyn_array->size = 0;                                                               \
@@ -81,7 +87,9 @@ extern "C" {
         if (unlikely_branch(min_capacity <= dyn_array->capacity))                          \
             return 1;                                                                      \
         size_t new_capacity = dyn_array->capacity * DYNAMIC_ARRAY_GROWTH_FACTOR;           \
-        TYPE *new_data = realloc(dyn_array->data, new_capacity * sizeof(TYPE));            \
+        size_t old_bytes = dyn_array->capacity * sizeof(TYPE);                             \
+        TYPE *new_data = (TYPE *)POCKET_REALLOC(#DECL_NAME, dyn_array->data, old_bytes,    \
+                                                new_capacity * sizeof(TYPE));              \
         if (unlikely_branch(!new_data))                                                    \
             return 0;                                                                      \
         dyn_array->data = new_data;                                                        \
@@ -100,7 +108,9 @@ extern "C" {
     TYPE DECL_NAME##_pop_back(DECL_NAME##_t *dyn_array)                                    \
     {                                                                                      \
         if (unlikely_branch(dyn_array->size == 0)) {                                       \
-            return (TYPE)0;                                                                \
+            TYPE empty;                                                                    \
+            memset(&empty, 0, sizeof(TYPE)); /* Also works for struct types */             \
+            return empty;                                                                  \
         }                                                                                  \
         return dyn_array->data[--(dyn_array->size)];                                       \
     }                                                                                      \
@@ -108,7 +118,9 @@ extern "C" {
     TYPE DECL_NAME##_get(const DECL_NAME##_t *dyn_array, size_t index)                     \
     {                                                                                      \
         if (unlikely_branch(index >= dyn_array->size)) {                                   \
-            return (TYPE)0;                                                                \
+            TYPE empty;                                                                    \
+            memset(&empty, 0, sizeof(TYPE));                                               \
+            return empty;                                                                  \
         }                                                                                  \
         return dyn_array->data[index];                                                     \
     }                                                                                      \
@@ -159,15 +171,23 @@ extern "C" {
     {                                                                                      \
         if (likely_branch(dyn_array)) {                                                    \
             if (likely_branch(dyn_array->data)) {                                          \
-                free(dyn_array->data);                                                     \
+                size_t bytes = dyn_array->capacity * sizeof(TYPE);                         \
+                POCKET_FREE(#DECL_NAME, dyn_array->data, bytes);                           \
             }                                                                              \
-            free(dyn_array);                                                               \
+            POCKET_FREE(#DECL_NAME, dyn_array, sizeof(DECL_NAME##_t));                     \
         }                                                                                  \
     }                                                                                      \
                                                                                            \
     void DECL_NAME##_clear(DECL_NAME##_t *dyn_array)                                       \
     {                                                                                      \
         dyn_array->size = 0;                                                               \
+    }                                                                                      \
+                                                                                           \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *dyn_array)         \
+    {                                                                                      \
+        return pocket_memory_usage_make(dyn_array->size * sizeof(TYPE),                    \
+                                        dyn_array->capacity * sizeof(TYPE),                \
+                                        sizeof(DECL_NAME##_t));                            \
     }
 
 #ifdef __cplusplus
@@ -0,0 +1,186 @@
+#ifndef _POCKET_DATA_STRUCTURES_DYNAMIC_ARRAY_IO_H
+#define _POCKET_DATA_STRUCTURES_DYNAMIC_ARRAY_IO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "dynamic_array.h"
+
+/*
+ * Binary persistence for DYN_ARRAY types (POSIX only, hence not part of dynamic_array.h).
+ *
+ *   DYN_ARRAY_DECLARE(vec_f32, float)
+ *   DYN_ARRAY_IMPLEMENT(vec_f32, float)
+ *   DYN_ARRAY_IO_DECLARE(vec_f32, float)
+ *   DYN_ARRAY_IO_IMPLEMENT(vec_f32, float)
+ *
+ * The file is a 64 byte header followed by the raw elements, so saving is one writev and loading is one read.
+ * _map_file returns a read-only array whose data points straight into the mapped file: it must be released with
+ * _unmap and never passed to functions that grow or free the array.
+ *
+ * Elements are stored as raw bytes, which only makes sense for types without pointers.
+ */
+
+#define DYN_ARRAY_IO_MAGIC "PDYA"
+#define DYN_ARRAY_IO_VERSION 1
+#define DYN_ARRAY_IO_BYTE_ORDER 0x01020304u
+
+typedef struct dyn_array_io_header_t {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t element_size;
+    uint64_t count;
+    /* Pads the header to a cache line so mapped elements stay aligned */
+    unsigned char reserved[40];
+} dyn_array_io_header_t;
+
+#ifdef __cplusplus
+static_assert(sizeof(dyn_array_io_header_t) == 64, "dyn_array_io_header_t must stay 64 bytes");
+#else
+_Static_assert(sizeof(dyn_array_io_header_t) == 64, "dyn_array_io_header_t must stay 64 bytes");
+#endif
+
+static inline dyn_array_io_header_t dyn_array_io_make_header(size_t element_size, size_t count) {
+    dyn_array_io_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DYN_ARRAY_IO_MAGIC, sizeof(header.magic));
+    header.version = DYN_ARRAY_IO_VERSION;
+    header.byte_order = DYN_ARRAY_IO_BYTE_ORDER;
+    header.element_size = (uint32_t)element_size;
+    header.count = count;
+    return header;
+}
+
+static inline int dyn_array_io_header_valid(const dyn_array_io_header_t *header, size_t element_size) {
+    return memcmp(header->magic, DYN_ARRAY_IO_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == DYN_ARRAY_IO_VERSION && header->byte_order == DYN_ARRAY_IO_BYTE_ORDER &&
+           header->element_size == element_size && header->count <= SIZE_MAX / element_size;
+}
+
+/* Writes every byte of every iovec, retrying on short writes and EINTR */
+static inline int dyn_array_io_writev_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t written = writev(fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        size_t left = (size_t)written;
+        while (iovcnt > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + left;
+            iov->iov_len -= left;
+        }
+    }
+    return 1;
+}
+
+static inline int dyn_array_io_read_all(int fd, void *buffer, size_t bytes) {
+    char *dst = (char *)buffer;
+    while (bytes > 0) {
+        ssize_t got = read(fd, dst, bytes);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        if (got == 0) return 0; /* Truncated file */
+        dst += got;
+        bytes -= (size_t)got;
+    }
+    return 1;
+}
+
+#define DYN_ARRAY_IO_DECLARE(DECL_NAME, TYPE)                      \
+    int DECL_NAME##_write(const DECL_NAME##_t *dyn_array, int fd); \
+                                                                   \
+    DECL_NAME##_t *DECL_NAME##_read(int fd);                       \
+                                                                   \
+    const DECL_NAME##_t *DECL_NAME##_map_file(const char *path);   \
+                                                                   \
+    void DECL_NAME##_unmap(const DECL_NAME##_t *view);
+
+#define DYN_ARRAY_IO_IMPLEMENT(DECL_NAME, TYPE)                                                                  \
+    int DECL_NAME##_write(const DECL_NAME##_t *dyn_array, int fd) {                                              \
+        dyn_array_io_header_t header = dyn_array_io_make_header(sizeof(TYPE), dyn_array->size);                  \
+        struct iovec iov[2];                                                                                     \
+        iov[0].iov_base = &header;                                                                               \
+        iov[0].iov_len = sizeof(header);                                                                         \
+        iov[1].iov_base = dyn_array->data;                                                                       \
+        iov[1].iov_len = dyn_array->size * sizeof(TYPE);                                                         \
+        return dyn_array_io_writev_all(fd, iov, dyn_array->size ? 2 : 1);                                        \
+    }                                                                                                            \
+                                                                                                                 \
+    DECL_NAME##_t *DECL_NAME##_read(int fd) {                                                                    \
+        dyn_array_io_header_t header;                                                                            \
+        if (unlikely_branch(!dyn_array_io_read_all(fd, &header, sizeof(header))))                                \
+            return NULL;                                                                                         \
+        if (unlikely_branch(!dyn_array_io_header_valid(&header, sizeof(TYPE))))                                  \
+            return NULL;                                                                                         \
+        DECL_NAME##_t *dyn_array = DECL_NAME##_create(header.count ? (size_t)header.count : 1);                  \
+        if (unlikely_branch(!dyn_array))                                                                         \
+            return NULL;                                                                                         \
+        if (unlikely_branch(!dyn_array_io_read_all(fd, dyn_array->data, (size_t)header.count * sizeof(TYPE)))) { \
+            DECL_NAME##_free(dyn_array);                                                                         \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        dyn_array->size = (size_t)header.count;                                                                  \
+        return dyn_array;                                                                                        \
+    }                                                                                                            \
+                                                                                                                 \
+    const DECL_NAME##_t *DECL_NAME##_map_file(const char *path) {                                                \
+        int fd = open(path, O_RDONLY);                                                                           \
+        if (unlikely_branch(fd < 0))                                                                             \
+            return NULL;                                                                                         \
+        struct stat st;                                                                                          \
+        if (unlikely_branch(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(dyn_array_io_header_t))) {        \
+            close(fd);                                                                                           \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        size_t length = (size_t)st.st_size;                                                                      \
+        void *base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);                                          \
+        close(fd); /* The mapping keeps the file alive */                                                        \
+        if (unlikely_branch(base == MAP_FAILED))                                                                 \
+            return NULL;                                                                                         \
+        const dyn_array_io_header_t *header = (const dyn_array_io_header_t *)base;                               \
+        DECL_NAME##_t *view = NULL;                                                                              \
+        if (likely_branch(dyn_array_io_header_valid(header, sizeof(TYPE)) &&                                     \
+                          length == sizeof(*header) + (size_t)header->count * sizeof(TYPE)))                     \
+            view = (DECL_NAME##_t *)calloc(1, sizeof(DECL_NAME##_t));                                            \
+        if (unlikely_branch(!view)) {                                                                            \
+            munmap(base, length);                                                                                \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        view->data = (TYPE *)((char *)base + sizeof(*header));                                                   \
+        view->size = (size_t)header->count;                                                                      \
+        view->capacity = view->size;                                                                             \
+        return view;                                                                                             \
+    }                                                                                                            \
+                                                                                                                 \
+    void DECL_NAME##_unmap(const DECL_NAME##_t *view) {                                                          \
+        if (likely_branch(view)) {                                                                               \
+            char *base = (char *)view->data - sizeof(dyn_array_io_header_t);                                     \
+            munmap(base, sizeof(dyn_array_io_header_t) + view->size * sizeof(TYPE));                             \
+            free((void *)view);                                                                                  \
+        }                                                                                                        \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_DYNAMIC_ARRAY_IO_H
@@ -7,6 +7,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "bloom_filter.h"
+#include "pocket_alloc.h"
+#include "pocket_hash.h"
+
 #ifndef HASH_MAP_MAX_LOAD_FACTOR
 #define HASH_MAP_MAX_LOAD_FACTOR 0.75
 #endif
@@ -15,181 +19,247 @@
 #define HASH_MAP_GROWTH_FACTOR 2
 #endif
 
-#define HASH_MAP_DECLARE(DECL_NAME, KEY_TYPE, VALUE_TYPE)                                                          \
-    typedef enum entry_status_t {                                                                                  \
-        FREE, /* free will be 0, which is default allocated with calloc */                                         \
-        OCCUPIED,                                                                                                  \
-        TOMBSTONE,                                                                                                 \
-    } entry_status_t;                                                                                              \
-    /* Default FNV-1a hash */                                                                                      \
-    static inline uint64_t fnv_1a_hash_bytes(const void *data, size_t len) {                                       \
-        const uint8_t *ptr = (const uint8_t *)data;                                                                \
-        uint64_t hash = 1469598103934665603ULL;                                                                    \
-        for (size_t i = 0; i < len; i++) {                                                                         \
-            hash ^= ptr[i];                                                                                        \
-            hash *= 1099511628211ULL;                                                                              \
-        }                                                                                                          \
-        return hash;                                                                                               \
-    }                                                                                                              \
-    /* Provides some default hash functions definitions */                                                         \
-    static inline uint64_t default_hash_uint64(uint64_t key) { return fnv_1a_hash_bytes(&key, sizeof(uint64_t)); } \
-    static inline uint64_t default_hash_int(int key) { return fnv_1a_hash_bytes(&key, sizeof(int)); }              \
-    static inline uint64_t default_hash_double(double key) { return fnv_1a_hash_bytes(&key, sizeof(double)); }     \
-    static inline uint64_t default_hash_cstr(const char *key) { return fnv_1a_hash_bytes(key, strlen(key)); }      \
-    typedef uint64_t (*hash_fn_##KEY_TYPE##_t)(KEY_TYPE key);                                                      \
-                                                                                                                   \
-    typedef struct {                                                                                               \
-        entry_status_t status;                                                                                     \
-        KEY_TYPE key;                                                                                              \
-        VALUE_TYPE value;                                                                                          \
-    } DECL_NAME##_entry_t;                                                                                         \
-                                                                                                                   \
-    typedef struct {                                                                                               \
-        size_t capacity;                                                                                           \
-        size_t occupancy;                                                                                          \
-        DECL_NAME##_entry_t *entries;                                                                              \
-        bool (*keys_equal_fn)(KEY_TYPE, KEY_TYPE);                                                                 \
-        hash_fn_##KEY_TYPE##_t hash_fn;                                                                            \
-    } DECL_NAME##_t;                                                                                               \
-                                                                                                                   \
-    DECL_NAME##_t DECL_NAME##_create(size_t initial_capacity, bool (*keys_equal_fn)(KEY_TYPE, KEY_TYPE),           \
-                                     hash_fn_##KEY_TYPE##_t hash_fn);                                              \
-    void DECL_NAME##_free(DECL_NAME##_t *map);                                                                     \
-    VALUE_TYPE *DECL_NAME##_find(DECL_NAME##_t *map, KEY_TYPE key);                                                \
-    bool DECL_NAME##_insert(DECL_NAME##_t *map, KEY_TYPE key, VALUE_TYPE value);                                   \
-    bool DECL_NAME##_erase(DECL_NAME##_t *map, KEY_TYPE key);                                                      \
-                                                                                                                   \
-    typedef struct DECL_NAME##_it_t {                                                                              \
-        DECL_NAME##_t *map;                                                                                        \
-        size_t index;                                                                                              \
-    } DECL_NAME##_it_t;                                                                                            \
-                                                                                                                   \
-    /* Initialize iterator (points to first valid element if any) */                                               \
-    DECL_NAME##_it_t DECL_NAME##_it_begin(DECL_NAME##_t *map);                                                     \
-                                                                                                                   \
-    /* Advance to next valid element. Returns false if no more elements. */                                        \
-    bool DECL_NAME##_it_next(DECL_NAME##_it_t *it);                                                                \
-                                                                                                                   \
-    /* Access key and value at current iterator position */                                                        \
-    KEY_TYPE DECL_NAME##_it_key(DECL_NAME##_it_t *it);                                                             \
+typedef enum entry_status_t {
+    FREE, /* free will be 0, which is default allocated with calloc */
+    OCCUPIED,
+    TOMBSTONE,
+} entry_status_t;
+
+/* Provides some default hash functions definitions */
+static inline uint64_t default_hash_uint64(uint64_t key) { return fnv_1a_hash_bytes(&key, sizeof(uint64_t)); }
+static inline uint64_t default_hash_int(int key) { return fnv_1a_hash_bytes(&key, sizeof(int)); }
+static inline uint64_t default_hash_double(double key) { return fnv_1a_hash_bytes(&key, sizeof(double)); }
+static inline uint64_t default_hash_cstr(const char *key) { return fnv_1a_hash_bytes(key, strlen(key)); }
+
+#define HASH_MAP_DECLARE(DECL_NAME, KEY_TYPE, VALUE_TYPE)                                                \
+    typedef uint64_t (*hash_fn_##KEY_TYPE##_t)(KEY_TYPE key);                                            \
+                                                                                                         \
+    typedef struct {                                                                                     \
+        entry_status_t status;                                                                           \
+        KEY_TYPE key;                                                                                    \
+        VALUE_TYPE value;                                                                                \
+    } DECL_NAME##_entry_t;                                                                               \
+                                                                                                         \
+    typedef struct {                                                                                     \
+        size_t capacity;                                                                                 \
+        size_t occupancy;                                                                                \
+        size_t tombstones; /* Erased slots, they still lengthen probes until the next rehash */          \
+        DECL_NAME##_entry_t *entries;                                                                    \
+        bool (*keys_equal_fn)(KEY_TYPE, KEY_TYPE);                                                       \
+        hash_fn_##KEY_TYPE##_t hash_fn;                                                                  \
+        bloom_filter_t filter; /* Optional, blocks is NULL unless enabled */                             \
+    } DECL_NAME##_t;                                                                                     \
+                                                                                                         \
+    DECL_NAME##_t DECL_NAME##_create(size_t initial_capacity, bool (*keys_equal_fn)(KEY_TYPE, KEY_TYPE), \
+                                     hash_fn_##KEY_TYPE##_t hash_fn);                                    \
+    void DECL_NAME##_free(DECL_NAME##_t *map);                                                           \
+    VALUE_TYPE *DECL_NAME##_find(DECL_NAME##_t *map, KEY_TYPE key);                                      \
+    bool DECL_NAME##_insert(DECL_NAME##_t *map, KEY_TYPE key, VALUE_TYPE value);                         \
+    bool DECL_NAME##_erase(DECL_NAME##_t *map, KEY_TYPE key);                                            \
+                                                                                                         \
+    /*                                                                                                   \
+     * Optional blocked Bloom filter checked before probing, so most misses cost one cache line          \
+     * instead of a probe sequence. It is filled by inserts and rebuilt on every rehash, which is        \
+     * also when it forgets erased keys.                                                                 \
+     */                                                                                                  \
+    bool DECL_NAME##_enable_filter(DECL_NAME##_t *map, double false_positive_rate);                      \
+    bool DECL_NAME##_rebuild_filter(DECL_NAME##_t *map);                                                 \
+    void DECL_NAME##_disable_filter(DECL_NAME##_t *map);                                                 \
+                                                                                                         \
+    /* Bytes in live entries vs. the whole slot array, plus the tombstone count */                       \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *map);                            \
+                                                                                                         \
+    typedef struct DECL_NAME##_it_t {                                                                    \
+        DECL_NAME##_t *map;                                                                              \
+        size_t index;                                                                                    \
+    } DECL_NAME##_it_t;                                                                                  \
+                                                                                                         \
+    /* Initialize iterator (points to first valid element if any) */                                     \
+    DECL_NAME##_it_t DECL_NAME##_it_begin(DECL_NAME##_t *map);                                           \
+                                                                                                         \
+    /* Advance to next valid element. Returns false if no more elements. */                              \
+    bool DECL_NAME##_it_next(DECL_NAME##_it_t *it);                                                      \
+                                                                                                         \
+    /* Access key and value at current iterator position */                                              \
+    KEY_TYPE DECL_NAME##_it_key(DECL_NAME##_it_t *it);                                                   \
     VALUE_TYPE DECL_NAME##_it_value(DECL_NAME##_it_t *it);
 
-#define HASH_MAP_IMPLEMENT(DECL_NAME, KEY_TYPE, VALUE_TYPE)                                                           \
-                                                                                                                      \
-    static DECL_NAME##_entry_t *find_entry_##KEY_TYPE##_##VALUE_TYPE(                                                 \
-        DECL_NAME##_entry_t *entries, size_t capacity, KEY_TYPE key, bool (*keys_equal_fn)(KEY_TYPE, KEY_TYPE),       \
-        hash_fn_##KEY_TYPE##_t hash_fn) {                                                                             \
-        uint64_t hash = hash_fn(key);                                                                                 \
-        size_t index = hash % capacity;                                                                               \
-        DECL_NAME##_entry_t *tombstone = NULL;                                                                        \
-        while (1) {                                                                                                   \
-            DECL_NAME##_entry_t *entry = &entries[index];                                                             \
-            switch (entry->status) {                                                                                  \
-                case (OCCUPIED):                                                                                      \
-                    if (keys_equal_fn(entry->key, key)) {                                                             \
-                        return entry;                                                                                 \
-                    }                                                                                                 \
-                    break;                                                                                            \
-                case TOMBSTONE:                                                                                       \
-                    tombstone = (tombstone == NULL) ? entry : tombstone;                                              \
-                    break;                                                                                            \
-                case FREE:                                                                                            \
-                    return tombstone ? tombstone : entry;                                                             \
-            }                                                                                                         \
-            index = (index + 1) % capacity;                                                                           \
-        }                                                                                                             \
-    }                                                                                                                 \
-                                                                                                                      \
-    DECL_NAME##_t DECL_NAME##_create(size_t initial_capacity, bool (*keys_equal_fn)(KEY_TYPE, KEY_TYPE),              \
-                                     hash_fn_##KEY_TYPE##_t hash_fn) {                                                \
-        DECL_NAME##_t map = {0};                                                                                      \
-        map.capacity = 1;                                                                                             \
-        while (map.capacity < initial_capacity) map.capacity <<= 1;                                                   \
-        map.entries = calloc(map.capacity, sizeof(DECL_NAME##_entry_t));                                              \
-        map.keys_equal_fn = keys_equal_fn;                                                                            \
-        map.hash_fn = hash_fn;                                                                                        \
-        return map;                                                                                                   \
-    }                                                                                                                 \
-                                                                                                                      \
-    void DECL_NAME##_free(DECL_NAME##_t *map) {                                                                       \
-        free(map->entries);                                                                                           \
-        map->entries = NULL;                                                                                          \
-        map->capacity = 0;                                                                                            \
-        map->occupancy = 0;                                                                                           \
-    }                                                                                                                 \
-                                                                                                                      \
-    static bool DECL_NAME##_rehash(DECL_NAME##_t *map, size_t new_capacity) {                                         \
-        DECL_NAME##_entry_t *new_entries = calloc(new_capacity, sizeof(DECL_NAME##_entry_t));                         \
-        if (!new_entries) return false;                                                                               \
-        /* Copy old entries into newly allocated entry array */                                                       \
-        for (size_t i = 0; i < map->capacity; i++) {                                                                  \
-            DECL_NAME##_entry_t *entry = &map->entries[i];                                                            \
-            if (entry->status != OCCUPIED) {                                                                          \
-                continue;                                                                                             \
-            }                                                                                                         \
-            DECL_NAME##_entry_t *dest = find_entry_##KEY_TYPE##_##VALUE_TYPE(new_entries, new_capacity, entry->key,   \
-                                                                             map->keys_equal_fn, map->hash_fn);       \
-            dest->key = entry->key;                                                                                   \
-            dest->value = entry->value;                                                                               \
-            dest->status = entry->status;                                                                             \
-        }                                                                                                             \
-                                                                                                                      \
-        free(map->entries);                                                                                           \
-        map->entries = new_entries;                                                                                   \
-        map->capacity = new_capacity;                                                                                 \
-        return true;                                                                                                  \
-    }                                                                                                                 \
-                                                                                                                      \
-    VALUE_TYPE *DECL_NAME##_find(DECL_NAME##_t *map, KEY_TYPE key) {                                                  \
-        if (map->occupancy == 0) return NULL;                                                                         \
-        DECL_NAME##_entry_t *entry =                                                                                  \
-            find_entry_##KEY_TYPE##_##VALUE_TYPE(map->entries, map->capacity, key, map->keys_equal_fn, map->hash_fn); \
-        return entry->status == OCCUPIED ? &entry->value : NULL;                                                      \
-    }                                                                                                                 \
-                                                                                                                      \
-    bool DECL_NAME##_insert(DECL_NAME##_t *map, KEY_TYPE key, VALUE_TYPE value) {                                     \
-        if (map->occupancy + 1 > map->capacity * HASH_MAP_MAX_LOAD_FACTOR) {                                          \
-            if (!DECL_NAME##_rehash(map, map->capacity * HASH_MAP_GROWTH_FACTOR)) return false;                       \
-        }                                                                                                             \
-        DECL_NAME##_entry_t *entry =                                                                                  \
-            find_entry_##KEY_TYPE##_##VALUE_TYPE(map->entries, map->capacity, key, map->keys_equal_fn, map->hash_fn); \
-        if (entry->status == FREE) map->occupancy++;                                                                  \
-        entry->key = key;                                                                                             \
-        entry->value = value;                                                                                         \
-        entry->status = OCCUPIED;                                                                                     \
-        return true;                                                                                                  \
-    }                                                                                                                 \
-                                                                                                                      \
-    bool DECL_NAME##_erase(DECL_NAME##_t *map, KEY_TYPE key) {                                                        \
-        if (map->occupancy == 0) return false;                                                                        \
-        DECL_NAME##_entry_t *entry =                                                                                  \
-            find_entry_##KEY_TYPE##_##VALUE_TYPE(map->entries, map->capacity, key, map->keys_equal_fn, map->hash_fn); \
-        if (entry->status == FREE) return false;                                                                      \
-        entry->status = TOMBSTONE;                                                                                    \
-        map->occupancy--;                                                                                             \
-        return true;                                                                                                  \
-    }                                                                                                                 \
-                                                                                                                      \
-    DECL_NAME##_it_t DECL_NAME##_it_begin(DECL_NAME##_t *map) {                                                       \
-        DECL_NAME##_it_t it = {map, 0};                                                                               \
-        /* Advance until we find a non-empty slot */                                                                  \
-        while (it.index < map->capacity && map->entries[it.index].status == OCCUPIED) {                               \
-            it.index++;                                                                                               \
-        }                                                                                                             \
-        return it;                                                                                                    \
-    }                                                                                                                 \
-                                                                                                                      \
-    bool DECL_NAME##_it_next(DECL_NAME##_it_t *it) {                                                                  \
-        if (!it->map) return false;                                                                                   \
-        it->index++;                                                                                                  \
-        while (it->index < it->map->capacity && it->map->entries[it->index].status == OCCUPIED) {                     \
-            it->index++;                                                                                              \
-        }                                                                                                             \
-        return it->index < it->map->capacity;                                                                         \
-    }                                                                                                                 \
-                                                                                                                      \
-    KEY_TYPE DECL_NAME##_it_key(DECL_NAME##_it_t *it) { return it->map->entries[it->index].key; }                     \
-                                                                                                                      \
+#define HASH_MAP_IMPLEMENT(DECL_NAME, KEY_TYPE, VALUE_TYPE)                                                     \
+                                                                                                                \
+    static DECL_NAME##_entry_t *DECL_NAME##_find_entry(DECL_NAME##_entry_t *entries, size_t capacity,           \
+                                                       KEY_TYPE key, uint64_t hash,                             \
+                                                       bool (*keys_equal_fn)(KEY_TYPE, KEY_TYPE)) {             \
+        size_t index = hash % capacity;                                                                         \
+        DECL_NAME##_entry_t *tombstone = NULL;                                                                  \
+        while (1) {                                                                                             \
+            DECL_NAME##_entry_t *entry = &entries[index];                                                       \
+            switch (entry->status) {                                                                            \
+                case (OCCUPIED):                                                                                \
+                    if (keys_equal_fn(entry->key, key)) {                                                       \
+                        return entry;                                                                           \
+                    }                                                                                           \
+                    break;                                                                                      \
+                case TOMBSTONE:                                                                                 \
+                    tombstone = (tombstone == NULL) ? entry : tombstone;                                        \
+                    break;                                                                                      \
+                case FREE:                                                                                      \
+                    return tombstone ? tombstone : entry;                                                       \
+            }                                                                                                   \
+            index = (index + 1) % capacity;                                                                     \
+        }                                                                                                       \
+    }                                                                                                           \
+                                                                                                                \
+    DECL_NAME##_t DECL_NAME##_create(size_t initial_capacity, bool (*keys_equal_fn)(KEY_TYPE, KEY_TYPE),        \
+                                     hash_fn_##KEY_TYPE##_t hash_fn) {                                          \
+        DECL_NAME##_t map;                                                                                      \
+        memset(&map, 0, sizeof(map));                                                                           \
+        map.capacity = 1;                                                                                       \
+        while (map.capacity < initial_capacity) map.capacity <<= 1;                                             \
+        map.entries =                                                                                           \
+            (DECL_NAME##_entry_t *)POCKET_CALLOC(#DECL_NAME, map.capacity, sizeof(DECL_NAME##_entry_t));        \
+        map.keys_equal_fn = keys_equal_fn;                                                                      \
+        map.hash_fn = hash_fn;                                                                                  \
+        return map;                                                                                             \
+    }                                                                                                           \
+                                                                                                                \
+    void DECL_NAME##_free(DECL_NAME##_t *map) {                                                                 \
+        POCKET_FREE(#DECL_NAME, map->entries, map->capacity * sizeof(DECL_NAME##_entry_t));                     \
+        bloom_filter_free(&map->filter);                                                                        \
+        map->entries = NULL;                                                                                    \
+        map->capacity = 0;                                                                                      \
+        map->occupancy = 0;                                                                                     \
+        map->tombstones = 0;                                                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    static bool DECL_NAME##_rehash(DECL_NAME##_t *map, size_t new_capacity) {                                   \
+        DECL_NAME##_entry_t *new_entries =                                                                      \
+            (DECL_NAME##_entry_t *)POCKET_CALLOC(#DECL_NAME, new_capacity, sizeof(DECL_NAME##_entry_t));        \
+        if (!new_entries) return false;                                                                         \
+        /* A filter sized for the new capacity, which also drops erased keys */                                 \
+        bloom_filter_t filter = {NULL, NULL, 0, 0, 0};                                                          \
+        if (map->filter.blocks) {                                                                               \
+            size_t expected = new_capacity * HASH_MAP_MAX_LOAD_FACTOR;                                          \
+            filter = bloom_filter_create(expected, map->filter.false_positive_rate);                            \
+            if (!filter.blocks) {                                                                               \
+                POCKET_FREE(#DECL_NAME, new_entries, new_capacity * sizeof(DECL_NAME##_entry_t));               \
+                return false;                                                                                   \
+            }                                                                                                   \
+        }                                                                                                       \
+        /* Copy old entries into newly allocated entry array */                                                 \
+        for (size_t i = 0; i < map->capacity; i++) {                                                            \
+            DECL_NAME##_entry_t *entry = &map->entries[i];                                                      \
+            if (entry->status != OCCUPIED) {                                                                    \
+                continue;                                                                                       \
+            }                                                                                                   \
+            uint64_t hash = map->hash_fn(entry->key);                                                           \
+            DECL_NAME##_entry_t *dest =                                                                         \
+                DECL_NAME##_find_entry(new_entries, new_capacity, entry->key, hash, map->keys_equal_fn);        \
+            if (filter.blocks) bloom_filter_add(&filter, hash);                                                 \
+            dest->key = entry->key;                                                                             \
+            dest->value = entry->value;                                                                         \
+            dest->status = entry->status;                                                                       \
+        }                                                                                                       \
+                                                                                                                \
+        POCKET_FREE(#DECL_NAME, map->entries, map->capacity * sizeof(DECL_NAME##_entry_t));                     \
+        map->entries = new_entries;                                                                             \
+        map->capacity = new_capacity;                                                                           \
+        map->tombstones = 0;                                                                                    \
+        if (filter.blocks) {                                                                                    \
+            bloom_filter_free(&map->filter);                                                                    \
+            map->filter = filter;                                                                               \
+        }                                                                                                       \
+        return true;                                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    bool DECL_NAME##_enable_filter(DECL_NAME##_t *map, double false_positive_rate) {                            \
+        bloom_filter_free(&map->filter);                                                                        \
+        map->filter = bloom_filter_create(map->capacity * HASH_MAP_MAX_LOAD_FACTOR, false_positive_rate);       \
+        if (!map->filter.blocks) return false;                                                                  \
+        for (size_t i = 0; i < map->capacity; i++)                                                              \
+            if (map->entries[i].status == OCCUPIED)                                                             \
+                bloom_filter_add(&map->filter, map->hash_fn(map->entries[i].key));                              \
+        return true;                                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    bool DECL_NAME##_rebuild_filter(DECL_NAME##_t *map) {                                                       \
+        if (!map->filter.blocks) return false;                                                                  \
+        return DECL_NAME##_enable_filter(map, map->filter.false_positive_rate);                                 \
+    }                                                                                                           \
+                                                                                                                \
+    void DECL_NAME##_disable_filter(DECL_NAME##_t *map) { bloom_filter_free(&map->filter); }                    \
+                                                                                                                \
+    VALUE_TYPE *DECL_NAME##_find(DECL_NAME##_t *map, KEY_TYPE key) {                                            \
+        if (map->occupancy == 0) return NULL;                                                                   \
+        uint64_t hash = map->hash_fn(key);                                                                      \
+        if (map->filter.blocks && !bloom_filter_may_contain(&map->filter, hash)) return NULL;                   \
+        DECL_NAME##_entry_t *entry =                                                                            \
+            DECL_NAME##_find_entry(map->entries, map->capacity, key, hash, map->keys_equal_fn);                 \
+        return entry->status == OCCUPIED ? &entry->value : NULL;                                                \
+    }                                                                                                           \
+                                                                                                                \
+    bool DECL_NAME##_insert(DECL_NAME##_t *map, KEY_TYPE key, VALUE_TYPE value) {                               \
+        /* Tombstones count towards the load so probing always ends on a FREE slot */                           \
+        if (map->occupancy + map->tombstones + 1 > map->capacity * HASH_MAP_MAX_LOAD_FACTOR) {                  \
+            /* Mostly tombstones: clean them up in place instead of growing */                                  \
+            size_t new_capacity = map->occupancy + 1 > map->capacity * HASH_MAP_MAX_LOAD_FACTOR / 2             \
+                                      ? map->capacity * HASH_MAP_GROWTH_FACTOR                                  \
+                                      : map->capacity;                                                          \
+            if (!DECL_NAME##_rehash(map, new_capacity)) return false;                                           \
+        }                                                                                                       \
+        uint64_t hash = map->hash_fn(key);                                                                      \
+        DECL_NAME##_entry_t *entry =                                                                            \
+            DECL_NAME##_find_entry(map->entries, map->capacity, key, hash, map->keys_equal_fn);                 \
+        if (entry->status != OCCUPIED) map->occupancy++;                                                        \
+        if (entry->status == TOMBSTONE) map->tombstones--;                                                      \
+        entry->key = key;                                                                                       \
+        entry->value = value;                                                                                   \
+        entry->status = OCCUPIED;                                                                               \
+        if (map->filter.blocks) bloom_filter_add(&map->filter, hash);                                           \
+        return true;                                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    bool DECL_NAME##_erase(DECL_NAME##_t *map, KEY_TYPE key) {                                                  \
+        if (map->occupancy == 0) return false;                                                                  \
+        uint64_t hash = map->hash_fn(key);                                                                      \
+        if (map->filter.blocks && !bloom_filter_may_contain(&map->filter, hash)) return false;                  \
+        DECL_NAME##_entry_t *entry =                                                                            \
+            DECL_NAME##_find_entry(map->entries, map->capacity, key, hash, map->keys_equal_fn);                 \
+        if (entry->status != OCCUPIED) return false;                                                            \
+        entry->status = TOMBSTONE;                                                                              \
+        map->occupancy--;                                                                                       \
+        map->tombstones++;                                                                                      \
+        return true;                                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *map) {                                  \
+        size_t entry_size = sizeof(DECL_NAME##_entry_t);                                                        \
+        size_t filter_bytes = bloom_filter_memory_usage(&map->filter).reserved_bytes;                           \
+        pocket_memory_usage_t usage =                                                                           \
+            pocket_memory_usage_make(map->occupancy * entry_size, map->capacity * entry_size, filter_bytes);    \
+        usage.tombstones = map->tombstones;                                                                     \
+        return usage;                                                                                           \
+    }                                                                                                           \
+                                                                                                                \
+    DECL_NAME##_it_t DECL_NAME##_it_begin(DECL_NAME##_t *map) {                                                 \
+        DECL_NAME##_it_t it = {map, 0};                                                                         \
+        /* Advance until we find a non-empty slot */                                                            \
+        while (it.index < map->capacity && map->entries[it.index].status != OCCUPIED) {                         \
+            it.index++;                                                                                         \
+        }                                                                                                       \
+        return it;                                                                                              \
+    }                                                                                                           \
+                                                                                                                \
+    bool DECL_NAME##_it_next(DECL_NAME##_it_t *it) {                                                            \
+        if (!it->map) return false;                                                                             \
+        it->index++;                                                                                            \
+        while (it->index < it->map->capacity && it->map->entries[it->index].status != OCCUPIED) {               \
+            it->index++;                                                                                        \
+        }                                                                                                       \
+        return it->index < it->map->capacity;                                                                   \
+    }                                                                                                           \
+                                                                                                                \
+    KEY_TYPE DECL_NAME##_it_key(DECL_NAME##_it_t *it) { return it->map->entries[it->index].key; }               \
+                                                                                                                \
     VALUE_TYPE DECL_NAME##_it_value(DECL_NAME##_it_t *it) { return it->map->entries[it->index].value; }
 
 #endif /* _POCKET_HASH_MAP_H */
@@ -0,0 +1,749 @@
+#ifndef _POCKET_DATA_STRUCTURES_POCKET_HPP
+#define _POCKET_DATA_STRUCTURES_POCKET_HPP
+
+#if !defined(__cplusplus) || (__cplusplus < 201703L && (!defined(_MSVC_LANG) || _MSVC_LANG < 201703L))
+#error "pocket.hpp needs C++17"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "dynamic_array.h"
+#include "hash_map.h"
+#include "pocket_string.h"
+
+/*
+ * C++17 front-end over the C containers: pocket::vector<T>, pocket::hash_map<K, V, Hash, Eq> and pocket::string.
+ *
+ * They keep the data layouts of the C versions and their growth, probing and hashing rules, but construct elements
+ * in place, move instead of copying and run destructors, so they hold any type including move-only ones:
+ *  - vector<T> is {data, size, capacity}, the struct DYN_ARRAY_DECLARE generates.
+ *  - hash_map<K, V> stores the {status, key, value} entries of HASH_MAP_DECLARE, probed the same way. Only the
+ *    header differs: it holds the Hash and Eq objects instead of function pointers.
+ *  - string is a string_t and calls the C functions, so it keeps the small string buffer and the cached hash.
+ * pocket::hash gives the same values as the C default hashes, and is constexpr where the input allows it.
+ *
+ * Memory goes through POCKET_MALLOC & co like the C containers. Allocation failures throw std::bad_alloc.
+ */
+
+namespace pocket {
+
+/*************************************/
+/**************Hashing****************/
+/*************************************/
+
+namespace detail {
+
+constexpr std::uint64_t fnv_offset_basis = 1469598103934665603ULL;
+constexpr std::uint64_t fnv_prime = 1099511628211ULL;
+
+// fnv_1a_hash_bytes, usable in constant expressions
+constexpr std::uint64_t fnv_1a(const char *data, std::size_t size) noexcept {
+    std::uint64_t hash = fnv_offset_basis;
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+// fnv_1a_hash_bytes(&value, sizeof(value)) without reading memory, assuming a little-endian target
+constexpr std::uint64_t fnv_1a_bits(std::uint64_t bits, std::size_t bytes) noexcept {
+    std::uint64_t hash = fnv_offset_basis;
+    for (std::size_t i = 0; i < bytes; i++) {
+        hash ^= (bits >> (8 * i)) & 0xFF;
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+}  // namespace detail
+
+template <class T, class = void>
+struct hash;
+
+template <class T>
+struct hash<T, std::enable_if_t<std::is_integral_v<T>>> {
+    constexpr std::uint64_t operator()(T value) const noexcept {
+        return detail::fnv_1a_bits(static_cast<std::uint64_t>(value), sizeof(T));
+    }
+};
+
+template <class T>
+struct hash<T, std::enable_if_t<std::is_enum_v<T>>> {
+    constexpr std::uint64_t operator()(T value) const noexcept {
+        return detail::fnv_1a_bits(static_cast<std::uint64_t>(static_cast<std::underlying_type_t<T>>(value)),
+                                   sizeof(T));
+    }
+};
+
+template <class T>
+struct hash<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    std::uint64_t operator()(T value) const noexcept { return fnv_1a_hash_bytes(&value, sizeof(T)); }
+};
+
+template <class T>
+struct hash<T *> {
+    std::uint64_t operator()(T *value) const noexcept { return fnv_1a_hash_bytes(&value, sizeof(T *)); }
+};
+
+template <>
+struct hash<std::string_view> {
+    constexpr std::uint64_t operator()(std::string_view value) const noexcept {
+        return detail::fnv_1a(value.data(), value.size());
+    }
+};
+
+/*************************************/
+/**************Vector*****************/
+/*************************************/
+
+namespace detail {
+
+// Frees a raw buffer unless released, so a throwing element constructor does not leak it
+struct buffer_guard {
+    const char *name;
+    void *ptr;
+    std::size_t bytes;
+    ~buffer_guard() {
+        if (ptr) POCKET_FREE(name, ptr, bytes);
+    }
+    void *release() noexcept { return std::exchange(ptr, nullptr); }
+};
+
+template <class T>
+T *allocate(const char *name, std::size_t count) {
+    (void)name;  // Only used when POCKET_ALLOC_TRACING is on
+    if (count == 0) return nullptr;
+    if (count > SIZE_MAX / sizeof(T)) throw std::bad_alloc();
+    void *ptr = POCKET_MALLOC(name, count * sizeof(T));
+    if (unlikely_branch(!ptr)) throw std::bad_alloc();
+    return static_cast<T *>(ptr);
+}
+
+// Moves count elements into uninitialized dst and destroys the sources
+template <class T>
+void relocate(T *dst, T *src, std::size_t count) noexcept {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (count) std::memmove(static_cast<void *>(dst), static_cast<const void *>(src), count * sizeof(T));
+    } else {
+        for (std::size_t i = 0; i < count; i++) {
+            ::new (static_cast<void *>(dst + i)) T(std::move(src[i]));
+            src[i].~T();
+        }
+    }
+}
+
+}  // namespace detail
+
+// Picks the capacity-only constructor: vector<T> v(pocket::with_capacity, n) is empty with room for n elements
+struct with_capacity_t {
+    explicit with_capacity_t() = default;
+};
+inline constexpr with_capacity_t with_capacity{};
+
+template <class T>
+class vector {
+    static_assert(std::is_nothrow_move_constructible_v<T> || std::is_trivially_copyable_v<T>,
+                  "pocket::vector relocates elements by moving them, which must not throw");
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    vector() noexcept = default;
+
+    // count value-initialized elements, like std::vector. Delegating lets the destructor clean up if one throws.
+    explicit vector(size_type count) : vector() { resize(count); }
+
+    vector(with_capacity_t, size_type capacity) { reserve(capacity); }
+
+    vector(std::initializer_list<T> values) {
+        reserve(values.size());
+        for (const T &value : values) ::new (static_cast<void *>(data_ + size_++)) T(value);
+    }
+
+    vector(const vector &other) {
+        reserve(other.size_);
+        for (const T &value : other) ::new (static_cast<void *>(data_ + size_++)) T(value);
+    }
+
+    vector(vector &&other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+
+    vector &operator=(const vector &other) {
+        if (this != &other) {
+            vector copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    vector &operator=(vector &&other) noexcept {
+        vector moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    ~vector() {
+        clear();
+        if (data_) POCKET_FREE("pocket::vector", data_, capacity_ * sizeof(T));
+    }
+
+    void swap(vector &other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    /* Capacity */
+    size_type size() const noexcept { return size_; }
+    size_type capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    void reserve(size_type new_capacity) {
+        if (new_capacity <= capacity_) return;
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (new_capacity > SIZE_MAX / sizeof(T)) throw std::bad_alloc();
+            void *grown = POCKET_REALLOC("pocket::vector", data_, capacity_ * sizeof(T), new_capacity * sizeof(T));
+            if (unlikely_branch(!grown)) throw std::bad_alloc();
+            data_ = static_cast<T *>(grown);
+        } else {
+            T *grown = detail::allocate<T>("pocket::vector", new_capacity);
+            detail::relocate(grown, data_, size_);
+            if (data_) POCKET_FREE("pocket::vector", data_, capacity_ * sizeof(T));
+            data_ = grown;
+        }
+        capacity_ = new_capacity;
+    }
+
+    // New elements are value-initialized
+    void resize(size_type new_size) {
+        if (new_size > capacity_) reserve(new_size);
+        for (; size_ < new_size; size_++) ::new (static_cast<void *>(data_ + size_)) T();
+        while (size_ > new_size) data_[--size_].~T();
+    }
+
+    void clear() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (size_type i = 0; i < size_; i++) data_[i].~T();
+        size_ = 0;
+    }
+
+    /* Element access */
+    T &operator[](size_type index) noexcept { return data_[index]; }
+    const T &operator[](size_type index) const noexcept { return data_[index]; }
+
+    T &at(size_type index) {
+        if (unlikely_branch(index >= size_)) throw std::out_of_range("pocket::vector::at");
+        return data_[index];
+    }
+    const T &at(size_type index) const { return const_cast<vector *>(this)->at(index); }
+
+    T &front() noexcept { return data_[0]; }
+    T &back() noexcept { return data_[size_ - 1]; }
+    const T &front() const noexcept { return data_[0]; }
+    const T &back() const noexcept { return data_[size_ - 1]; }
+    T *data() noexcept { return data_; }
+    const T *data() const noexcept { return data_; }
+
+    iterator begin() noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+
+    /* Modifiers */
+
+    // Constructs the element directly in the array. args may refer to an element of the vector itself.
+    template <class... Args>
+    T &emplace_back(Args &&...args) {
+        if (likely_branch(size_ < capacity_)) {
+            ::new (static_cast<void *>(data_ + size_)) T(std::forward<Args>(args)...);
+        } else {
+            // Build the new element in the new buffer before the old ones move out from under args
+            size_type new_capacity = capacity_ ? capacity_ * DYNAMIC_ARRAY_GROWTH_FACTOR : 4;
+            detail::buffer_guard guard{"pocket::vector", detail::allocate<T>("pocket::vector", new_capacity),
+                                       new_capacity * sizeof(T)};
+            T *grown = static_cast<T *>(guard.ptr);
+            ::new (static_cast<void *>(grown + size_)) T(std::forward<Args>(args)...);
+            detail::relocate(grown, data_, size_);
+            if (data_) POCKET_FREE("pocket::vector", data_, capacity_ * sizeof(T));
+            data_ = static_cast<T *>(guard.release());
+            capacity_ = new_capacity;
+        }
+        return data_[size_++];
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    void pop_back() noexcept { data_[--size_].~T(); }
+
+    // Shifts the tail up by one and constructs the element at pos
+    template <class... Args>
+    iterator emplace(const_iterator pos, Args &&...args) {
+        size_type index = static_cast<size_type>(pos - data_);
+        if (index == size_) return &emplace_back(std::forward<Args>(args)...);
+        T value(std::forward<Args>(args)...);  // args may point into the part that moves
+        if (size_ == capacity_) reserve(capacity_ * DYNAMIC_ARRAY_GROWTH_FACTOR);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memmove(static_cast<void *>(data_ + index + 1), static_cast<const void *>(data_ + index),
+                         (size_ - index) * sizeof(T));
+            ::new (static_cast<void *>(data_ + index)) T(std::move(value));
+        } else {
+            ::new (static_cast<void *>(data_ + size_)) T(std::move(data_[size_ - 1]));
+            for (size_type i = size_ - 1; i > index; i--) data_[i] = std::move(data_[i - 1]);
+            data_[index] = std::move(value);
+        }
+        size_++;
+        return data_ + index;
+    }
+
+    iterator insert(const_iterator pos, const T &value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+
+    iterator erase(const_iterator pos) {
+        size_type index = static_cast<size_type>(pos - data_);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memmove(static_cast<void *>(data_ + index), static_cast<const void *>(data_ + index + 1),
+                         (size_ - index - 1) * sizeof(T));
+        } else {
+            for (size_type i = index; i + 1 < size_; i++) data_[i] = std::move(data_[i + 1]);
+            data_[size_ - 1].~T();
+        }
+        size_--;
+        return data_ + index;
+    }
+
+    /* Same accounting as DYN_ARRAY's _memory_usage */
+    pocket_memory_usage_t memory_usage() const noexcept {
+        return pocket_memory_usage_make(size_ * sizeof(T), capacity_ * sizeof(T), sizeof(vector));
+    }
+
+   private:
+    T *data_ = nullptr;
+    size_type size_ = 0;
+    size_type capacity_ = 0;
+};
+
+/*************************************/
+/**************Hash Map***************/
+/*************************************/
+
+template <class K, class V, class Hash = pocket::hash<K>, class Eq = std::equal_to<K>>
+class hash_map {
+    // Rehashing moves every entry to the new slot array, which must not fail halfway. Hash and Eq must not throw
+    // either: lookups are noexcept.
+    static_assert(std::is_nothrow_move_constructible_v<K> || std::is_trivially_copyable_v<K>,
+                  "pocket::hash_map relocates keys by moving them, which must not throw");
+    static_assert(std::is_nothrow_move_constructible_v<V> || std::is_trivially_copyable_v<V>,
+                  "pocket::hash_map relocates values by moving them, which must not throw");
+
+    // HASH_MAP's entry layout. The key and value are only alive while status is OCCUPIED.
+    struct entry {
+        entry_status_t status;
+        alignas(K) unsigned char key_storage[sizeof(K)];
+        alignas(V) unsigned char value_storage[sizeof(V)];
+
+        K &key() noexcept { return *std::launder(reinterpret_cast<K *>(key_storage)); }
+        V &value() noexcept { return *std::launder(reinterpret_cast<V *>(value_storage)); }
+        void destroy() noexcept {
+            key().~K();
+            value().~V();
+        }
+    };
+
+   public:
+    using key_type = K;
+    using mapped_type = V;
+    using size_type = std::size_t;
+
+    // What iterators point at, works with structured bindings: for (auto [key, value] : map)
+    template <class Value>
+    struct basic_reference {
+        const K &key;
+        Value &value;
+    };
+    using reference = basic_reference<V>;
+    using const_reference = basic_reference<const V>;
+
+    template <class Map, class Reference>
+    class basic_iterator {
+       public:
+        basic_iterator(Map *map, size_type index) noexcept : map_(map), index_(index) { skip(); }
+        Reference operator*() const noexcept {
+            entry &slot = map_->entries_[index_];
+            return Reference{slot.key(), slot.value()};
+        }
+        basic_iterator &operator++() noexcept {
+            index_++;
+            skip();
+            return *this;
+        }
+        bool operator==(const basic_iterator &other) const noexcept { return index_ == other.index_; }
+        bool operator!=(const basic_iterator &other) const noexcept { return index_ != other.index_; }
+
+       private:
+        void skip() noexcept {
+            while (index_ < map_->capacity_ && map_->entries_[index_].status != OCCUPIED) index_++;
+        }
+        Map *map_;
+        size_type index_;
+    };
+    using iterator = basic_iterator<hash_map, reference>;
+    using const_iterator = basic_iterator<const hash_map, const_reference>;
+
+    hash_map() noexcept(std::is_nothrow_default_constructible_v<Hash> && std::is_nothrow_default_constructible_v<Eq>) =
+        default;
+
+    // Rounded up to a power of two like HASH_MAP's _create
+    explicit hash_map(size_type initial_capacity, const Hash &hash = Hash(), const Eq &eq = Eq())
+        : hash_(hash), eq_(eq) {
+        size_type capacity = 1;
+        while (capacity < initial_capacity) capacity <<= 1;
+        allocate_entries(capacity);
+    }
+
+    hash_map(const hash_map &other) : hash_(other.hash_), eq_(other.eq_) {
+        allocate_entries(other.capacity_);
+        for (const_reference item : other) emplace(item.key, item.value);
+    }
+
+    hash_map(hash_map &&other) noexcept
+        : capacity_(std::exchange(other.capacity_, 0)),
+          occupancy_(std::exchange(other.occupancy_, 0)),
+          tombstones_(std::exchange(other.tombstones_, 0)),
+          entries_(std::exchange(other.entries_, nullptr)),
+          hash_(std::move(other.hash_)),
+          eq_(std::move(other.eq_)) {}
+
+    hash_map &operator=(const hash_map &other) {
+        if (this != &other) {
+            hash_map copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    hash_map &operator=(hash_map &&other) noexcept {
+        hash_map moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    ~hash_map() {
+        clear();
+        if (entries_) POCKET_FREE("pocket::hash_map", entries_, capacity_ * sizeof(entry));
+    }
+
+    void swap(hash_map &other) noexcept {
+        std::swap(capacity_, other.capacity_);
+        std::swap(occupancy_, other.occupancy_);
+        std::swap(tombstones_, other.tombstones_);
+        std::swap(entries_, other.entries_);
+        std::swap(hash_, other.hash_);
+        std::swap(eq_, other.eq_);
+    }
+
+    size_type size() const noexcept { return occupancy_; }
+    size_type capacity() const noexcept { return capacity_; }
+    bool empty() const noexcept { return occupancy_ == 0; }
+
+    // Destroys every entry, keeping the slot array
+    void clear() noexcept {
+        for (size_type i = 0; i < capacity_; i++) {
+            if (entries_[i].status == OCCUPIED) entries_[i].destroy();
+            entries_[i].status = FREE;
+        }
+        occupancy_ = tombstones_ = 0;
+    }
+
+    // Grows so that count entries fit without a rehash
+    void reserve(size_type count) {
+        size_type capacity = capacity_ ? capacity_ : 1;
+        while (count + 1 > capacity * HASH_MAP_MAX_LOAD_FACTOR) capacity *= HASH_MAP_GROWTH_FACTOR;
+        if (capacity > capacity_) rehash(capacity);
+    }
+
+    /* Lookup */
+    V *find(const K &key) noexcept {
+        if (occupancy_ == 0) return nullptr;
+        entry *slot = find_entry(entries_, capacity_, key, hash_(key));
+        return slot->status == OCCUPIED ? &slot->value() : nullptr;
+    }
+    const V *find(const K &key) const noexcept { return const_cast<hash_map *>(this)->find(key); }
+    bool contains(const K &key) const noexcept { return find(key) != nullptr; }
+
+    V &at(const K &key) {
+        V *value = find(key);
+        if (unlikely_branch(!value)) throw std::out_of_range("pocket::hash_map::at");
+        return *value;
+    }
+
+    /*
+     * Constructs the value from args only if key is absent, like std::unordered_map::try_emplace. Returns the value
+     * and whether it was inserted. Neither key nor args are touched when the key is already there.
+     */
+    template <class... Args>
+    std::pair<V *, bool> emplace(const K &key, Args &&...args) {
+        return emplace_key(key, std::forward<Args>(args)...);
+    }
+    template <class... Args>
+    std::pair<V *, bool> emplace(K &&key, Args &&...args) {
+        return emplace_key(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Inserts or overwrites, like HASH_MAP's _insert
+    template <class M>
+    std::pair<V *, bool> insert_or_assign(const K &key, M &&value) {
+        auto result = emplace(key, std::forward<M>(value));
+        if (!result.second) *result.first = std::forward<M>(value);
+        return result;
+    }
+    template <class M>
+    std::pair<V *, bool> insert_or_assign(K &&key, M &&value) {
+        auto result = emplace(std::move(key), std::forward<M>(value));
+        if (!result.second) *result.first = std::forward<M>(value);
+        return result;
+    }
+
+    V &operator[](const K &key) { return *emplace(key).first; }
+    V &operator[](K &&key) { return *emplace(std::move(key)).first; }
+
+    // Leaves a tombstone like HASH_MAP's _erase, the key and value are destroyed right away
+    bool erase(const K &key) noexcept {
+        if (occupancy_ == 0) return false;
+        entry *slot = find_entry(entries_, capacity_, key, hash_(key));
+        if (slot->status != OCCUPIED) return false;
+        slot->destroy();
+        slot->status = TOMBSTONE;
+        occupancy_--;
+        tombstones_++;
+        return true;
+    }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, capacity_); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, capacity_); }
+
+    /* Same accounting as HASH_MAP's _memory_usage */
+    pocket_memory_usage_t memory_usage() const noexcept {
+        pocket_memory_usage_t usage =
+            pocket_memory_usage_make(occupancy_ * sizeof(entry), capacity_ * sizeof(entry), 0);
+        usage.tombstones = tombstones_;
+        return usage;
+    }
+
+   private:
+    void allocate_entries(size_type capacity) {
+        void *entries = POCKET_CALLOC("pocket::hash_map", capacity, sizeof(entry));  // FREE is 0
+        if (unlikely_branch(!entries)) throw std::bad_alloc();
+        entries_ = static_cast<entry *>(entries);
+        capacity_ = capacity;
+    }
+
+    // HASH_MAP's find_entry: the key's slot, or the first tombstone or free slot where it would go
+    entry *find_entry(entry *entries, size_type capacity, const K &key, std::uint64_t hash) const {
+        size_type index = hash % capacity;
+        entry *tombstone = nullptr;
+        while (1) {
+            entry *slot = &entries[index];
+            switch (slot->status) {
+                case OCCUPIED:
+                    if (eq_(slot->key(), key)) return slot;
+                    break;
+                case TOMBSTONE:
+                    if (!tombstone) tombstone = slot;
+                    break;
+                case FREE:
+                    return tombstone ? tombstone : slot;
+            }
+            index = (index + 1) % capacity;
+        }
+    }
+
+    void rehash(size_type new_capacity) {
+        void *allocation = POCKET_CALLOC("pocket::hash_map", new_capacity, sizeof(entry));
+        if (unlikely_branch(!allocation)) throw std::bad_alloc();
+        entry *new_entries = static_cast<entry *>(allocation);
+        for (size_type i = 0; i < capacity_; i++) {
+            entry &old = entries_[i];
+            if (old.status != OCCUPIED) continue;
+            // Keys are distinct and the new array has no tombstones, so the first free slot is the one
+            size_type index = hash_(old.key()) % new_capacity;
+            while (new_entries[index].status != FREE) index = (index + 1) % new_capacity;
+            entry *dest = &new_entries[index];
+            ::new (static_cast<void *>(dest->key_storage)) K(std::move(old.key()));
+            ::new (static_cast<void *>(dest->value_storage)) V(std::move(old.value()));
+            dest->status = OCCUPIED;
+            old.destroy();
+        }
+        if (entries_) POCKET_FREE("pocket::hash_map", entries_, capacity_ * sizeof(entry));
+        entries_ = new_entries;
+        capacity_ = new_capacity;
+        tombstones_ = 0;
+    }
+
+    template <class KeyRef, class... Args>
+    std::pair<V *, bool> emplace_key(KeyRef &&key, Args &&...args) {
+        std::uint64_t hash = hash_(key);
+        if (occupancy_ > 0) {
+            entry *slot = find_entry(entries_, capacity_, key, hash);
+            if (slot->status == OCCUPIED) return {&slot->value(), false};
+        }
+        // Same policy as HASH_MAP's _insert: tombstones count towards the load, mostly tombstones rehash in place
+        if (occupancy_ + tombstones_ + 1 > capacity_ * HASH_MAP_MAX_LOAD_FACTOR) {
+            size_type new_capacity = occupancy_ + 1 > capacity_ * HASH_MAP_MAX_LOAD_FACTOR / 2
+                                         ? (capacity_ ? capacity_ * HASH_MAP_GROWTH_FACTOR : 16)
+                                         : capacity_;
+            rehash(new_capacity);
+        }
+        entry *slot = find_entry(entries_, capacity_, key, hash);
+        // Key first, then value. The slot only turns OCCUPIED once both are built, so a throw leaves it as it was.
+        K *new_key = ::new (static_cast<void *>(slot->key_storage)) K(std::forward<KeyRef>(key));
+        try {
+            ::new (static_cast<void *>(slot->value_storage)) V(std::forward<Args>(args)...);
+        } catch (...) {
+            new_key->~K();
+            throw;
+        }
+        if (slot->status == TOMBSTONE) tombstones_--;
+        slot->status = OCCUPIED;
+        occupancy_++;
+        return {&slot->value(), true};
+    }
+
+    size_type capacity_ = 0;
+    size_type occupancy_ = 0;
+    size_type tombstones_ = 0;
+    entry *entries_ = nullptr;
+    Hash hash_{};
+    Eq eq_{};
+};
+
+/*************************************/
+/**************String*****************/
+/*************************************/
+
+// Owns a string_t. raw() hands it to the C functions, e.g. string_appendf(&s.raw(), ...).
+class string {
+   public:
+    using size_type = std::size_t;
+    static constexpr size_type npos = SIZE_MAX;
+
+    string() noexcept : str_(string_create_empty()) {}
+    string(const char *c_str) : string(std::string_view(c_str)) {}
+    string(std::string_view view) : str_(string_create_n(view.data(), view.size())) {
+        if (unlikely_branch(string_size(&str_) != view.size())) throw std::bad_alloc();
+    }
+    string(const string &other) : string(other.view()) {}
+    string(string &&other) noexcept : str_(other.str_) { other.str_ = string_create_empty(); }
+
+    // Adopts a string_t, which must not be freed by the caller afterwards
+    static string adopt(string_t str) noexcept {
+        string result;
+        result.str_ = str;
+        return result;
+    }
+
+    string &operator=(const string &other) {
+        if (this != &other) {
+            string copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+    string &operator=(string &&other) noexcept {
+        string moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    ~string() { string_free(&str_); }
+
+    // A string_t is a plain 24 byte value whose small buffer is found through its tag, so bytes can be swapped
+    void swap(string &other) noexcept { std::swap(str_, other.str_); }
+
+    string_t &raw() noexcept { return str_; }
+    const string_t &raw() const noexcept { return str_; }
+
+    size_type size() const noexcept { return string_size(&str_); }
+    size_type capacity() const noexcept { return string_capacity(&str_); }
+    bool empty() const noexcept { return size() == 0; }
+    const char *c_str() const noexcept { return string_get_cstr(&str_); }
+    const char *data() const noexcept { return string_get_cstr(&str_); }
+    // The caller may write through the pointer, so the cached hash is dropped
+    char *data() noexcept {
+        if (string_is_heap(&str_)) string_heap_header(&str_)->hash = 0;
+        return string_data(&str_);
+    }
+    std::string_view view() const noexcept { return std::string_view(c_str(), size()); }
+    operator std::string_view() const noexcept { return view(); }
+
+    char operator[](size_type pos) const noexcept { return c_str()[pos]; }
+    char &operator[](size_type pos) noexcept { return data()[pos]; }
+
+    void reserve(size_type new_capacity) { check(string_reserve(&str_, new_capacity)); }
+    void clear() noexcept { string_clear(&str_); }
+    void push_back(char ch) { check(string_push_back(&str_, ch)); }
+    void pop_back() noexcept { string_pop_back(&str_); }
+    string &append(std::string_view view) {
+        check(string_append_n(&str_, view.data(), view.size()));
+        return *this;
+    }
+    string &operator+=(std::string_view view) { return append(view); }
+    string &operator+=(char ch) {
+        push_back(ch);
+        return *this;
+    }
+
+    size_type find(std::string_view needle, size_type pos = 0) const noexcept {
+        size_t found = string_view_find(string_view_of(&str_), string_view_create_n(needle.data(), needle.size()), pos);
+        return found == STRING_NPOS ? npos : found;
+    }
+
+    // Cached in the heap header like string_hash, and equal to pocket::hash<std::string_view> of the contents
+    std::uint64_t hash() const noexcept { return string_hash(&str_); }
+
+    int compare(const string &other) const noexcept { return string_compare(&str_, &other.str_); }
+    friend bool operator==(const string &a, const string &b) noexcept { return string_equals(&a.str_, &b.str_); }
+    friend bool operator!=(const string &a, const string &b) noexcept { return !(a == b); }
+    friend bool operator<(const string &a, const string &b) noexcept { return a.compare(b) < 0; }
+    friend bool operator==(const string &a, std::string_view b) noexcept { return a.view() == b; }
+    friend bool operator!=(const string &a, std::string_view b) noexcept { return a.view() != b; }
+    friend bool operator==(const string &a, const char *b) noexcept { return a.view() == b; }
+    friend bool operator!=(const string &a, const char *b) noexcept { return a.view() != b; }
+
+    pocket_memory_usage_t memory_usage() const noexcept { return string_memory_usage(&str_); }
+
+   private:
+    static void check(int ok) {
+        if (unlikely_branch(!ok)) throw std::bad_alloc();
+    }
+
+    string_t str_;
+};
+
+static_assert(sizeof(string) == sizeof(string_t), "pocket::string must stay a plain string_t");
+
+template <>
+struct hash<string> {
+    std::uint64_t operator()(const string &value) const noexcept { return value.hash(); }
+};
+
+}  // namespace pocket
+
+#endif  // _POCKET_DATA_STRUCTURES_POCKET_HPP
@@ -0,0 +1,247 @@
+#ifndef _POCKET_DATA_STRUCTURES_POCKET_ALLOC_H
+#define _POCKET_DATA_STRUCTURES_POCKET_ALLOC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * Allocation hooks shared by the containers. Every call names the container type it allocates for (the DECL_NAME
+ * of a generated type, "string_t" for strings) and passes the byte counts involved, so that nothing has to be
+ * stored next to the allocation.
+ *
+ * POCKET_ALIGNED_ALLOC/POCKET_ALIGNED_FREE do the same for aligned_alloc. The byte count may be anything, it is
+ * rounded up to the multiple of the alignment aligned_alloc requires, and the free must be given the same alignment
+ * and byte count as the allocation.
+ *
+ * By default the macros are plain malloc/calloc/realloc/free and the extra arguments vanish. Building with
+ * POCKET_ALLOC_TRACING defined (in every translation unit, e.g. -DPOCKET_ALLOC_TRACING) routes them through
+ * counters kept per container name: allocations, reallocations, frees, live bytes and peak bytes. Exactly one
+ * translation unit must then expand POCKET_ALLOC_TRACING_IMPLEMENT() at file scope, and
+ * pocket_alloc_report(stdout) prints the table.
+ *
+ * Independently of tracing, containers expose NAME_memory_usage() returning a pocket_memory_usage_t for a single
+ * instance.
+ */
+
+typedef struct pocket_memory_usage_t {
+    size_t used_bytes;      // Bytes holding live elements
+    size_t reserved_bytes;  // Bytes allocated for elements, used or not
+    size_t slack_bytes;     // reserved_bytes - used_bytes
+    size_t overhead_bytes;  // Headers and bookkeeping next to the elements
+    size_t tombstones;      // Erased hash map slots that still take up room
+} pocket_memory_usage_t;
+
+static inline pocket_memory_usage_t pocket_memory_usage_make(size_t used, size_t reserved, size_t overhead) {
+    pocket_memory_usage_t usage = {used, reserved, reserved - used, overhead, 0};
+    return usage;
+}
+
+/* Bytes an aligned allocation really takes: a nonzero multiple of alignment (a power of two). 0 on overflow. */
+static inline size_t pocket_aligned_size(size_t alignment, size_t bytes) {
+    if (bytes > SIZE_MAX - (alignment - 1)) return 0;
+    size_t rounded = (bytes + alignment - 1) & ~(alignment - 1);
+    return rounded ? rounded : alignment;
+}
+
+static inline void *pocket_aligned_alloc(size_t alignment, size_t bytes) {
+    size_t rounded = pocket_aligned_size(alignment, bytes);
+    return rounded ? aligned_alloc(alignment, rounded) : NULL;
+}
+
+#ifdef POCKET_ALLOC_TRACING
+
+#include <stdatomic.h>
+#include <string.h>
+
+#ifndef POCKET_ALLOC_MAX_NAMES
+#define POCKET_ALLOC_MAX_NAMES 256
+#endif
+
+typedef struct pocket_alloc_stats_t {
+    const char *name;
+    size_t allocations;
+    size_t reallocations;
+    size_t frees;
+    size_t failures;
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t total_bytes;  // Sum of every allocation and growth, a measure of allocator traffic
+} pocket_alloc_stats_t;
+
+void *pocket_alloc_traced_malloc(const char *name, size_t bytes);
+void *pocket_alloc_traced_calloc(const char *name, size_t count, size_t size);
+void *pocket_alloc_traced_realloc(const char *name, void *ptr, size_t old_bytes, size_t new_bytes);
+void pocket_alloc_traced_free(const char *name, void *ptr, size_t bytes);
+void *pocket_alloc_traced_aligned_alloc(const char *name, size_t alignment, size_t bytes);
+
+/* Counters for one container name (all zero if it never allocated), and for the whole process with name NULL */
+pocket_alloc_stats_t pocket_alloc_get_stats(const char *name);
+void pocket_alloc_report(FILE *out);
+void pocket_alloc_reset(void);
+
+#define POCKET_MALLOC(NAME, BYTES) pocket_alloc_traced_malloc(NAME, BYTES)
+#define POCKET_CALLOC(NAME, COUNT, SIZE) pocket_alloc_traced_calloc(NAME, COUNT, SIZE)
+#define POCKET_REALLOC(NAME, PTR, OLD_BYTES, NEW_BYTES) pocket_alloc_traced_realloc(NAME, PTR, OLD_BYTES, NEW_BYTES)
+#define POCKET_FREE(NAME, PTR, BYTES) pocket_alloc_traced_free(NAME, PTR, BYTES)
+#define POCKET_ALIGNED_ALLOC(NAME, ALIGN, BYTES) pocket_alloc_traced_aligned_alloc(NAME, ALIGN, BYTES)
+#define POCKET_ALIGNED_FREE(NAME, ALIGN, PTR, BYTES) \
+    pocket_alloc_traced_free(NAME, PTR, pocket_aligned_size(ALIGN, BYTES))
+
+#else
+
+/* The size arguments are still evaluated (and then optimized out) so they never trigger unused warnings */
+#define POCKET_MALLOC(NAME, BYTES) malloc(BYTES)
+#define POCKET_CALLOC(NAME, COUNT, SIZE) calloc(COUNT, SIZE)
+#define POCKET_REALLOC(NAME, PTR, OLD_BYTES, NEW_BYTES) ((void)(OLD_BYTES), realloc(PTR, NEW_BYTES))
+#define POCKET_FREE(NAME, PTR, BYTES) ((void)(BYTES), free(PTR))
+#define POCKET_ALIGNED_ALLOC(NAME, ALIGN, BYTES) pocket_aligned_alloc(ALIGN, BYTES)
+#define POCKET_ALIGNED_FREE(NAME, ALIGN, PTR, BYTES) ((void)(ALIGN), (void)(BYTES), free(PTR))
+
+static inline void pocket_alloc_report(FILE *out) {
+    fprintf(out, "pocket_alloc: tracing disabled, build with -DPOCKET_ALLOC_TRACING\n");
+}
+
+#endif  // POCKET_ALLOC_TRACING
+
+/*
+ * Counter storage and the traced functions. The table is a fixed array searched linearly: names are string
+ * literals, so pointer comparison almost always hits first. Once POCKET_ALLOC_MAX_NAMES names are in use, further
+ * names share a separate "(other)" entry. A spinlock keeps the counters consistent when several threads allocate.
+ */
+#ifdef POCKET_ALLOC_TRACING
+#define POCKET_ALLOC_TRACING_IMPLEMENT()                                                                            \
+    static pocket_alloc_stats_t pocket_alloc_table[POCKET_ALLOC_MAX_NAMES];                                         \
+    static pocket_alloc_stats_t pocket_alloc_total;                                                                 \
+    static pocket_alloc_stats_t pocket_alloc_other; /* Every name that found the table full */                      \
+    static atomic_flag pocket_alloc_lock = ATOMIC_FLAG_INIT;                                                        \
+                                                                                                                    \
+    static pocket_alloc_stats_t *pocket_alloc_entry(const char *name) {                                             \
+        for (size_t i = 0; i < POCKET_ALLOC_MAX_NAMES; i++) {                                                       \
+            pocket_alloc_stats_t *entry = &pocket_alloc_table[i];                                                   \
+            if (entry->name == name || (entry->name && strcmp(entry->name, name) == 0)) return entry;               \
+            if (!entry->name) {                                                                                     \
+                entry->name = name;                                                                                 \
+                return entry;                                                                                       \
+            }                                                                                                       \
+        }                                                                                                           \
+        pocket_alloc_other.name = "(other)";                                                                        \
+        return &pocket_alloc_other;                                                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Applies one event to the entry for name and to the process total */                                          \
+    static void pocket_alloc_record(const char *name, int ok, size_t old_bytes, size_t new_bytes, int kind) {       \
+        while (atomic_flag_test_and_set_explicit(&pocket_alloc_lock, memory_order_acquire)) {                       \
+        }                                                                                                           \
+        pocket_alloc_stats_t *targets[2] = {pocket_alloc_entry(name), &pocket_alloc_total};                         \
+        for (int i = 0; i < 2; i++) {                                                                               \
+            pocket_alloc_stats_t *stats = targets[i];                                                               \
+            if (!ok) {                                                                                              \
+                stats->failures++;                                                                                  \
+                continue;                                                                                           \
+            }                                                                                                       \
+            stats->allocations += kind == 0;                                                                        \
+            stats->reallocations += kind == 1;                                                                      \
+            stats->frees += kind == 2;                                                                              \
+            stats->live_bytes = stats->live_bytes - old_bytes + new_bytes;                                          \
+            if (new_bytes > old_bytes) stats->total_bytes += new_bytes - old_bytes;                                 \
+            if (stats->live_bytes > stats->peak_bytes) stats->peak_bytes = stats->live_bytes;                       \
+        }                                                                                                           \
+        atomic_flag_clear_explicit(&pocket_alloc_lock, memory_order_release);                                       \
+    }                                                                                                               \
+                                                                                                                    \
+    void *pocket_alloc_traced_malloc(const char *name, size_t bytes) {                                              \
+        void *ptr = malloc(bytes);                                                                                  \
+        pocket_alloc_record(name, ptr != NULL, 0, bytes, 0);                                                        \
+        return ptr;                                                                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    void *pocket_alloc_traced_calloc(const char *name, size_t count, size_t size) {                                 \
+        void *ptr = calloc(count, size);                                                                            \
+        pocket_alloc_record(name, ptr != NULL, 0, count * size, 0);                                                 \
+        return ptr;                                                                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    void *pocket_alloc_traced_realloc(const char *name, void *ptr, size_t old_bytes, size_t new_bytes) {            \
+        void *new_ptr = realloc(ptr, new_bytes);                                                                    \
+        pocket_alloc_record(name, new_ptr != NULL, ptr ? old_bytes : 0, new_bytes, ptr ? 1 : 0);                    \
+        return new_ptr;                                                                                             \
+    }                                                                                                               \
+                                                                                                                    \
+    void pocket_alloc_traced_free(const char *name, void *ptr, size_t bytes) {                                      \
+        if (!ptr) return;                                                                                           \
+        free(ptr);                                                                                                  \
+        pocket_alloc_record(name, 1, bytes, 0, 2);                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    void *pocket_alloc_traced_aligned_alloc(const char *name, size_t alignment, size_t bytes) {                     \
+        void *ptr = pocket_aligned_alloc(alignment, bytes);                                                         \
+        pocket_alloc_record(name, ptr != NULL, 0, pocket_aligned_size(alignment, bytes), 0);                        \
+        return ptr;                                                                                                 \
+    }                                                                                                               \
+                                                                                                                    \
+    pocket_alloc_stats_t pocket_alloc_get_stats(const char *name) {                                                 \
+        pocket_alloc_stats_t stats;                                                                                 \
+        memset(&stats, 0, sizeof(stats));                                                                           \
+        while (atomic_flag_test_and_set_explicit(&pocket_alloc_lock, memory_order_acquire)) {                       \
+        }                                                                                                           \
+        if (!name) {                                                                                                \
+            stats = pocket_alloc_total;                                                                             \
+        } else {                                                                                                    \
+            for (size_t i = 0; i < POCKET_ALLOC_MAX_NAMES && pocket_alloc_table[i].name; i++) {                     \
+                if (strcmp(pocket_alloc_table[i].name, name) == 0) stats = pocket_alloc_table[i];                   \
+            }                                                                                                       \
+            if (pocket_alloc_other.name && strcmp(pocket_alloc_other.name, name) == 0) stats = pocket_alloc_other;  \
+        }                                                                                                           \
+        atomic_flag_clear_explicit(&pocket_alloc_lock, memory_order_release);                                       \
+        stats.name = name;                                                                                          \
+        return stats;                                                                                               \
+    }                                                                                                               \
+                                                                                                                    \
+    void pocket_alloc_report(FILE *out) {                                                                           \
+        /* Copy everything under the lock so the rows are one consistent snapshot, then print without it */         \
+        pocket_alloc_stats_t rows[POCKET_ALLOC_MAX_NAMES + 1];                                                      \
+        size_t count = 0;                                                                                           \
+        while (atomic_flag_test_and_set_explicit(&pocket_alloc_lock, memory_order_acquire)) {                       \
+        }                                                                                                           \
+        while (count < POCKET_ALLOC_MAX_NAMES && pocket_alloc_table[count].name) {                                  \
+            rows[count] = pocket_alloc_table[count];                                                                \
+            count++;                                                                                                \
+        }                                                                                                           \
+        if (pocket_alloc_other.name) rows[count++] = pocket_alloc_other;                                            \
+        pocket_alloc_stats_t total = pocket_alloc_total;                                                            \
+        atomic_flag_clear_explicit(&pocket_alloc_lock, memory_order_release);                                       \
+                                                                                                                    \
+        fprintf(out, "%-24s %10s %10s %10s %14s %14s %14s\n", "container", "allocs", "reallocs", "frees", "live",   \
+                "peak", "total");                                                                                   \
+        for (size_t i = 0; i < count; i++) {                                                                        \
+            const pocket_alloc_stats_t *s = &rows[i];                                                               \
+            fprintf(out, "%-24s %10zu %10zu %10zu %14zu %14zu %14zu\n", s->name, s->allocations, s->reallocations,  \
+                    s->frees, s->live_bytes, s->peak_bytes, s->total_bytes);                                        \
+        }                                                                                                           \
+        fprintf(out, "%-24s %10zu %10zu %10zu %14zu %14zu %14zu\n", "(all)", total.allocations,                     \
+                total.reallocations, total.frees, total.live_bytes, total.peak_bytes, total.total_bytes);           \
+        if (total.failures) fprintf(out, "%zu allocation(s) failed\n", total.failures);                             \
+    }                                                                                                               \
+                                                                                                                    \
+    void pocket_alloc_reset(void) {                                                                                 \
+        while (atomic_flag_test_and_set_explicit(&pocket_alloc_lock, memory_order_acquire)) {                       \
+        }                                                                                                           \
+        memset(pocket_alloc_table, 0, sizeof(pocket_alloc_table));                                                  \
+        memset(&pocket_alloc_total, 0, sizeof(pocket_alloc_total));                                                 \
+        memset(&pocket_alloc_other, 0, sizeof(pocket_alloc_other));                                                 \
+        atomic_flag_clear_explicit(&pocket_alloc_lock, memory_order_release);                                       \
+    }
+#else
+#define POCKET_ALLOC_TRACING_IMPLEMENT()
+#endif  // POCKET_ALLOC_TRACING
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_POCKET_ALLOC_H
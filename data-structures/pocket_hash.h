@@ -0,0 +1,30 @@
+#ifndef _POCKET_DATA_STRUCTURES_POCKET_HASH_H
+#define _POCKET_DATA_STRUCTURES_POCKET_HASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Byte hashing shared by the containers, kept apart from hash_map.h so that headers which only need to hash (like
+ * pocket_string.h) do not pull in the HASH_MAP generator and its entry_status_t enumerators.
+ */
+
+/* Default FNV-1a hash */
+static inline uint64_t fnv_1a_hash_bytes(const void *data, size_t len) {
+    const uint8_t *ptr = (const uint8_t *)data;
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= ptr[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_POCKET_HASH_H
@@ -5,91 +5,207 @@
 extern "C" {
 #endif
 
+#include <locale.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "dynamic_array.h"
-DYN_ARRAY_DECLARE(dyn_array_char, char)
-DYN_ARRAY_IMPLEMENT(dyn_array_char, char)
+#include "pocket_hash.h"
+
+/*
+ * string_t is a 24 byte value with two representations:
+ *  - small: up to STRING_SSO_CAPACITY chars and their '\0' live inline, the last byte holds the length.
+ *  - heap:  ptr/size describe a malloc'd buffer, the last byte holds STRING_HEAP_TAG. The buffer is preceded by a
+ *           string_heap_header_t holding its capacity and a cached hash.
+ * Short strings therefore never allocate. Note that for small strings string_get_cstr points inside the string_t
+ * itself, so the pointer does not survive copying or moving the string_t.
+ */
+
+#define STRING_SSO_BUFFER_SIZE 24
+#define STRING_SSO_CAPACITY (STRING_SSO_BUFFER_SIZE - 2)
+#define STRING_HEAP_TAG 0xFF
+
+typedef struct string_heap_header_t {
+    size_t capacity;  // Not counting '\0'
+    uint64_t hash;    // Cached string_hash, 0 when unknown
+} string_heap_header_t;
 
 typedef struct string_t {
-    dyn_array_char_t *data;
+    union {
+        struct {
+            char *ptr;
+            size_t size;
+        } heap;
+        char small[STRING_SSO_BUFFER_SIZE];
+    };
 } string_t;
 
+#ifdef __cplusplus
+static_assert(sizeof(string_t) == STRING_SSO_BUFFER_SIZE, "string_t must stay 24 bytes");
+#else
+_Static_assert(sizeof(string_t) == STRING_SSO_BUFFER_SIZE, "string_t must stay 24 bytes");
+#endif
+
 /*************************************/
-/*******Constructors & Destructor*****/
+/**************Representation*********/
 /*************************************/
 
-string_t string_create(const char *c_str) {
-    string_t str;
-    size_t len = strlen(c_str);
-    // +1 for the nullterminated char
-    str.data = dyn_array_char_create(len + 1);
-    for (size_t i = 0; i < len; i++) {
-        dyn_array_char_push_back(str.data, c_str[i]);
+static inline int string_is_heap(const string_t *str) {
+    return (unsigned char)str->small[STRING_SSO_BUFFER_SIZE - 1] == STRING_HEAP_TAG;
+}
+
+static inline char *string_data(string_t *str) { return string_is_heap(str) ? str->heap.ptr : str->small; }
+
+static inline string_heap_header_t *string_heap_header(const string_t *str) {
+    return (string_heap_header_t *)str->heap.ptr - 1;
+}
+
+// Updates the length and writes the matching '\0'. Every mutation goes through here, so it also drops the cached hash.
+static inline void string_set_size(string_t *str, size_t size) {
+    if (string_is_heap(str)) {
+        string_heap_header(str)->hash = 0;
+        str->heap.size = size;
+        str->heap.ptr[size] = '\0';
+    } else {
+        str->small[STRING_SSO_BUFFER_SIZE - 1] = (char)size;
+        str->small[size] = '\0';
     }
-    dyn_array_char_push_back(str.data, '\0');
-    return str;
 }
 
-string_t string_create_empty() {
+static inline char *string_heap_alloc(size_t capacity) {
+    string_heap_header_t *header =
+        (string_heap_header_t *)POCKET_MALLOC("string_t", sizeof(string_heap_header_t) + capacity + 1);
+    if (unlikely_branch(!header)) return NULL;
+    header->capacity = capacity;
+    header->hash = 0;
+    return (char *)(header + 1);
+}
+
+/*************************************/
+/*******Constructors & Destructor*****/
+/*************************************/
+
+static inline string_t string_create_empty() {
     string_t str;
-    str.data = dyn_array_char_create(1);
-    dyn_array_char_push_back(str.data, '\0');
+    str.small[0] = '\0';
+    str.small[STRING_SSO_BUFFER_SIZE - 1] = 0;
     return str;
 }
 
-string_t string_copy(const string_t *src_str) {
-    string_t str;
-    str.data = NULL;
-    if (likely_branch(src_str && src_str->data)) {
-        str.data = dyn_array_char_create(src_str->data->size);
-        for (size_t i = 0; i < src_str->data->size; i++) {
-            str.data->data[i] = src_str->data->data[i];
-        }
+// Creates a string from the first len chars of c_str, which does not need to be null terminated
+static inline string_t string_create_n(const char *c_str, size_t len) {
+    string_t str = string_create_empty();
+    if (len > STRING_SSO_CAPACITY) {
+        char *buffer = string_heap_alloc(len);
+        if (unlikely_branch(!buffer)) return str;
+        str.heap.ptr = buffer;
+        str.small[STRING_SSO_BUFFER_SIZE - 1] = (char)STRING_HEAP_TAG;
     }
+    memcpy(string_data(&str), c_str, len);
+    string_set_size(&str, len);
     return str;
 }
 
-void string_free(string_t *str) { dyn_array_char_free(str->data); }
+static inline string_t string_create(const char *c_str) { return string_create_n(c_str, strlen(c_str)); }
+
+static inline string_t string_copy(const string_t *src_str) {
+    if (unlikely_branch(!src_str)) return string_create_empty();
+    if (!string_is_heap(src_str)) return *src_str;
+    return string_create_n(src_str->heap.ptr, src_str->heap.size);
+}
+
+static inline void string_free(string_t *str) {
+    if (string_is_heap(str)) {
+        string_heap_header_t *header = string_heap_header(str);
+        POCKET_FREE("string_t", header, sizeof(string_heap_header_t) + header->capacity + 1);
+    }
+    *str = string_create_empty();
+}
 
 /*************************************/
 /**************Capacity***************/
 /*************************************/
 
-size_t string_size(const string_t *str) {
-    // -1 because we are not counting '\0'f
-    if (likely_branch(str && str->data) && str->data->size > 1)
-        return dyn_array_char_size(str->data) - 1;
-    else
-        return 0;
+static inline size_t string_size(const string_t *str) {
+    if (unlikely_branch(!str)) return 0;
+    return string_is_heap(str) ? str->heap.size : (size_t)(unsigned char)str->small[STRING_SSO_BUFFER_SIZE - 1];
+}
+
+static inline int string_empty(const string_t *str) { return string_size(str) == 0; }
+
+// Number of chars (not counting '\0') the string can hold without reallocating
+static inline size_t string_capacity(const string_t *str) {
+    return string_is_heap(str) ? string_heap_header(str)->capacity : STRING_SSO_CAPACITY;
 }
 
-int string_empty(const string_t *str) { return string_size(str) == 0; }
+// Makes room for at least new_capacity characters (plus '\0') so that appends up to that size never reallocate
+static inline int string_reserve(string_t *str, size_t new_capacity) {
+    size_t capacity = string_capacity(str);
+    if (likely_branch(new_capacity <= capacity)) return 1;
+    size_t grown = capacity * DYNAMIC_ARRAY_GROWTH_FACTOR;
+    if (grown < new_capacity) grown = new_capacity;
 
-void string_clear(string_t *str) {
-    dyn_array_char_clear(str->data);
-    dyn_array_char_push_back(str->data, '\0');
+    if (string_is_heap(str)) {
+        string_heap_header_t *header = (string_heap_header_t *)POCKET_REALLOC(
+            "string_t", string_heap_header(str), sizeof(string_heap_header_t) + capacity + 1,
+            sizeof(string_heap_header_t) + grown + 1);
+        if (unlikely_branch(!header)) return 0;
+        header->capacity = grown;
+        str->heap.ptr = (char *)(header + 1);
+        return 1;
+    }
+
+    // Small -> heap: copy out before ptr/size overwrite the inline chars
+    size_t size = string_size(str);
+    char *buffer = string_heap_alloc(grown);
+    if (unlikely_branch(!buffer)) return 0;
+    memcpy(buffer, str->small, size + 1);
+    str->heap.ptr = buffer;
+    str->heap.size = size;
+    str->small[STRING_SSO_BUFFER_SIZE - 1] = (char)STRING_HEAP_TAG;
+    return 1;
+}
+
+static inline void string_clear(string_t *str) { string_set_size(str, 0); }
+
+// Chars in use vs. chars reserved. Inline strings live in the string_t itself and have no overhead.
+static inline pocket_memory_usage_t string_memory_usage(const string_t *str) {
+    size_t overhead = string_is_heap(str) ? sizeof(string_heap_header_t) + 1 : 0;
+    return pocket_memory_usage_make(string_size(str), string_capacity(str), overhead);
 }
 
 /*************************************/
 /**************Element Access*********/
 /*************************************/
 
-const char *string_get_cstr(const string_t *str) { return (const char *)str->data->data; }
+static inline const char *string_get_cstr(const string_t *str) {
+    return string_is_heap(str) ? str->heap.ptr : str->small;
+}
 
-char string_at(const string_t *str, size_t pos) {
-    if (likely_branch(pos < string_size(str))) return dyn_array_char_get(str->data, pos);
+static inline char string_at(const string_t *str, size_t pos) {
+    if (likely_branch(pos < string_size(str))) return string_get_cstr(str)[pos];
     return '\0';
 }
 
-char string_front(const string_t *str) {
-    if (likely_branch(string_size(str) > 0)) return dyn_array_char_get(str->data, 0);
+static inline char string_front(const string_t *str) {
+    if (likely_branch(string_size(str) > 0)) return string_get_cstr(str)[0];
     return '\0';
 }
 
-char string_back(const string_t *str) {
-    if (likely_branch(string_size(str) > 0)) return dyn_array_char_get(str->data, str->data->size - 2);
+static inline char string_back(const string_t *str) {
+    size_t len = string_size(str);
+    if (likely_branch(len > 0)) return string_get_cstr(str)[len - 1];
     return '\0';
 }
 
@@ -97,53 +213,1041 @@ char string_back(const string_t *str) {
 /**************Modifiers***************/
 /*************************************/
 
-int string_push_back(string_t *str, char ch) { return dyn_array_char_insert(str->data, str->data->size - 1, ch); }
+static inline int string_push_back(string_t *str, char ch) {
+    size_t len = string_size(str);
+    if (unlikely_branch(!string_reserve(str, len + 1))) return 0;
+    string_data(str)[len] = ch;
+    string_set_size(str, len + 1);
+    return 1;
+}
 
-int string_pop_back(string_t *str) { return dyn_array_char_remove(str->data, str->data->size - 2); }
+static inline int string_pop_back(string_t *str) {
+    size_t len = string_size(str);
+    if (unlikely_branch(len == 0)) return 0;
+    string_set_size(str, len - 1);
+    return 1;
+}
 
-int string_append_cstr(string_t *dst_str, const char *src) {
-    size_t src_len = strlen(src);
-    // Remove '\0'
-    dst_str->data->size -= 1;
+static inline int string_append_n(string_t *dst_str, const char *src, size_t src_len) {
+    size_t len = string_size(dst_str);
+    // src may point into dst_str's own buffer, which string_reserve can move
+    const char *buffer = string_get_cstr(dst_str);
+    int aliased = src >= buffer && src <= buffer + len;
+    size_t offset = aliased ? (size_t)(src - buffer) : 0;
+    if (unlikely_branch(!string_reserve(dst_str, len + src_len))) return 0;
+    if (aliased) src = string_get_cstr(dst_str) + offset;
 
-    for (size_t i = 0; i < src_len; i++) {
-        dyn_array_char_push_back(dst_str->data, src[i]);
+    memcpy(string_data(dst_str) + len, src, src_len);
+    string_set_size(dst_str, len + src_len);
+    return 1;
+}
+
+static inline int string_append_cstr(string_t *dst_str, const char *src) {
+    return string_append_n(dst_str, src, strlen(src));
+}
+
+// printf-style append, formatting straight into the spare capacity
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+static inline int string_appendf(string_t *dst_str, const char *fmt, ...) {
+    size_t len = string_size(dst_str);
+    size_t spare = string_capacity(dst_str) - len + 1;  // Includes the room for '\0'
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(string_data(dst_str) + len, spare, fmt, args);
+    va_end(args);
+    if (unlikely_branch(written < 0)) {
+        string_set_size(dst_str, len);
+        return 0;
     }
-    if (dyn_array_char_get(dst_str->data, dst_str->data->size - 1) != '\0') {
-        dyn_array_char_push_back(dst_str->data, '\0');
+    if ((size_t)written >= spare) {
+        // Did not fit, grow once to the exact size and format again
+        if (unlikely_branch(!string_reserve(dst_str, len + (size_t)written))) {
+            string_set_size(dst_str, len);
+            return 0;
+        }
+        va_start(args, fmt);
+        vsnprintf(string_data(dst_str) + len, (size_t)written + 1, fmt, args);
+        va_end(args);
     }
+    string_set_size(dst_str, len + (size_t)written);
+    return 1;
+}
 
-    return 0;
+static inline int string_concat(string_t *dst_str, const string_t *src_str) {
+    return string_append_n(dst_str, string_get_cstr(src_str), string_size(src_str));
 }
 
-int string_concat(string_t *dst_str, const string_t *src_str) {
-    if (likely_branch(string_size(dst_str) > 0 && string_size(src_str) > 0)) {
-        return string_append_cstr(dst_str, string_get_cstr(src_str));
+static inline int string_erase(string_t *str, size_t pos) {
+    size_t len = string_size(str);
+    if (likely_branch(pos < len)) {
+        char *data = string_data(str);
+        memmove(data + pos, data + pos + 1, len - pos - 1);
+        string_set_size(str, len - 1);
+        return 1;
     }
     return 0;
 }
 
-int string_erase(string_t *str, size_t pos) {
-    if (likely_branch(pos < string_size(str))) {
-        return dyn_array_char_remove(str->data, pos);
+static inline int string_insert(string_t *str, size_t pos, char ch) {
+    size_t len = string_size(str);
+    if (likely_branch(pos <= len)) {
+        if (unlikely_branch(!string_reserve(str, len + 1))) return 0;
+        char *data = string_data(str);
+        memmove(data + pos + 1, data + pos, len - pos);
+        data[pos] = ch;
+        string_set_size(str, len + 1);
+        return 1;
     }
     return 0;
 }
 
-int string_insert(string_t *str, size_t pos, char ch) {
-    if (likely_branch(pos <= string_size(str))) {
-        return dyn_array_char_insert(str->data, pos, ch);
+/*************************************/
+/**************String Operations******/
+/*************************************/
+
+// Lexicographic byte comparison using the known lengths, embedded '\0' included
+static inline int string_compare(const string_t *a, const string_t *b) {
+    size_t a_size = string_size(a), b_size = string_size(b);
+    size_t common = a_size < b_size ? a_size : b_size;
+    int result = common ? memcmp(string_get_cstr(a), string_get_cstr(b), common) : 0;
+    if (result != 0) return result;
+    return (a_size > b_size) - (a_size < b_size);
+}
+
+/*
+ * FNV-1a of the contents, the same function hash_map.h uses for its default hashes. Heap strings remember the
+ * result in their header until the next mutation, so hashing an unchanged key again is O(1). Short strings fit in
+ * a few words and are simply hashed again.
+ */
+static inline uint64_t string_hash(const string_t *str) {
+    if (!string_is_heap(str)) return fnv_1a_hash_bytes(str->small, string_size(str));
+    string_heap_header_t *header = string_heap_header(str);
+    if (header->hash == 0) header->hash = fnv_1a_hash_bytes(str->heap.ptr, str->heap.size);
+    return header->hash;
+}
+
+static inline int string_equals(const string_t *a, const string_t *b) {
+    size_t size = string_size(a);
+    if (size != string_size(b)) return 0;
+    // Two known, different hashes settle it without touching the chars
+    if (string_is_heap(a) && string_is_heap(b)) {
+        uint64_t a_hash = string_heap_header(a)->hash, b_hash = string_heap_header(b)->hash;
+        if (a_hash && b_hash && a_hash != b_hash) return 0;
     }
-    return 0;
+    return size == 0 || memcmp(string_get_cstr(a), string_get_cstr(b), size) == 0;
 }
 
+/*
+ * Hash and equality for string_t keys in HASH_MAP (include hash_map.h for the generator itself):
+ *
+ *   HASH_MAP_DECLARE(routes, string_t, int)
+ *   HASH_MAP_IMPLEMENT(routes, string_t, int)
+ *   routes_t map = routes_create(64, string_keys_equal, default_hash_string);
+ *
+ * The map stores the string_t by value, so it shares the heap buffer with the inserted key: insert a string the
+ * map can own (e.g. a string_copy) and do not mutate it while it is a key.
+ */
+static inline uint64_t default_hash_string(string_t key) { return string_hash(&key); }
+
+static inline bool string_keys_equal(string_t a, string_t b) { return string_equals(&a, &b); }
+
 /*************************************/
-/**************String Operations******/
+/**************String Views***********/
+/*************************************/
+
+/*
+ * A string_view_t is a non-owning (pointer, length) slice of some other buffer, usually a string_t. It is not null
+ * terminated and becomes dangling as soon as the underlying buffer is modified or freed.
+ */
+typedef struct string_view_t {
+    const char *data;
+    size_t size;
+} string_view_t;
+
+static inline string_view_t string_view_create_n(const char *data, size_t size) {
+    string_view_t view = {data, size};
+    return view;
+}
+
+static inline string_view_t string_view_create(const char *c_str) { return string_view_create_n(c_str, strlen(c_str)); }
+
+static inline string_view_t string_view_of(const string_t *str) {
+    return string_view_create_n(string_get_cstr(str), string_size(str));
+}
+
+// View of at most len chars starting at pos, both clamped to the view like std::string_view::substr
+static inline string_view_t string_view_substr(string_view_t view, size_t pos, size_t len) {
+    if (unlikely_branch(pos > view.size)) pos = view.size;
+    if (len > view.size - pos) len = view.size - pos;
+    return string_view_create_n(view.data + pos, len);
+}
+
+static inline string_view_t string_substr_view(const string_t *str, size_t pos, size_t len) {
+    return string_view_substr(string_view_of(str), pos, len);
+}
+
+static inline string_t string_create_from_view(string_view_t view) { return string_create_n(view.data, view.size); }
+
+static inline int string_view_compare(string_view_t a, string_view_t b) {
+    size_t common = a.size < b.size ? a.size : b.size;
+    int result = common ? memcmp(a.data, b.data, common) : 0;
+    if (result != 0) return result;
+    return (a.size > b.size) - (a.size < b.size);
+}
+
+static inline int string_view_equals(string_view_t a, string_view_t b) {
+    return a.size == b.size && (a.size == 0 || memcmp(a.data, b.data, a.size) == 0);
+}
+
+static inline int string_view_starts_with(string_view_t view, string_view_t prefix) {
+    return prefix.size <= view.size && (prefix.size == 0 || memcmp(view.data, prefix.data, prefix.size) == 0);
+}
+
+static inline int string_view_ends_with(string_view_t view, string_view_t suffix) {
+    return suffix.size <= view.size &&
+           (suffix.size == 0 || memcmp(view.data + view.size - suffix.size, suffix.data, suffix.size) == 0);
+}
+
+static inline int string_is_space(char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); }
+
+static inline string_view_t string_view_trim_left(string_view_t view) {
+    while (view.size > 0 && string_is_space(view.data[0])) {
+        view.data++;
+        view.size--;
+    }
+    return view;
+}
+
+static inline string_view_t string_view_trim_right(string_view_t view) {
+    while (view.size > 0 && string_is_space(view.data[view.size - 1])) view.size--;
+    return view;
+}
+
+static inline string_view_t string_view_trim(string_view_t view) {
+    return string_view_trim_right(string_view_trim_left(view));
+}
+
+/*
+ * Splits view on every delim, keeping empty fields ("a,,b" -> "a", "", "b"). Up to max_parts views are stored in
+ * parts; the return value is the total number of fields, which may be larger than max_parts.
+ */
+static inline size_t string_split(string_view_t view, char delim, string_view_t *parts, size_t max_parts) {
+    size_t count = 0;
+    const char *end = view.data + view.size;
+    const char *field = view.data;
+    while (1) {
+        const char *hit = field < end ? (const char *)memchr(field, delim, (size_t)(end - field)) : NULL;
+        const char *field_end = hit ? hit : end;
+        if (count < max_parts) parts[count] = string_view_create_n(field, (size_t)(field_end - field));
+        count++;
+        if (!hit) return count;
+        field = hit + 1;
+    }
+}
+
+/*
+ * strtok-like tokenizer without allocation or writes to the source. Skips any run of chars from delims, stores the
+ * next token in *token and advances *rest past it. Returns 0 once no token is left.
+ *
+ *   string_view_t rest = string_view_of(&line), token;
+ *   while (string_tokenize(&rest, " \t", &token)) { ... }
+ */
+static inline int string_tokenize(string_view_t *rest, const char *delims, string_view_t *token) {
+    unsigned char is_delim[256] = {0};
+    for (const unsigned char *d = (const unsigned char *)delims; *d; d++) is_delim[*d] = 1;
+
+    size_t i = 0;
+    while (i < rest->size && is_delim[(unsigned char)rest->data[i]]) i++;
+    if (i == rest->size) {
+        *rest = string_view_create_n(rest->data + i, 0);
+        return 0;
+    }
+    size_t start = i;
+    while (i < rest->size && !is_delim[(unsigned char)rest->data[i]]) i++;
+    *token = string_view_create_n(rest->data + start, i - start);
+    *rest = string_view_create_n(rest->data + i, rest->size - i);
+    return 1;
+}
+
+/*************************************/
+/**************Search*****************/
+/*************************************/
+
+/*
+ * Searching scans STRING_VEC_WIDTH bytes per step with AVX2 (32) or SSE2 (16) when the compiler targets them, and
+ * falls back to memchr/memcmp otherwise. Substring search uses the first/last byte filter: a position is only
+ * memcmp'd when both the first and the last byte of the needle match there.
+ * All functions return STRING_NPOS when nothing is found.
+ */
+
+#define STRING_NPOS ((size_t)-1)
+
+#if defined(__AVX2__)
+typedef __m256i string_vec_t;
+#define STRING_VEC_WIDTH 32
+#define string_vec_splat(ch) _mm256_set1_epi8((char)(ch))
+#define string_vec_load(ptr) _mm256_loadu_si256((const __m256i *)(const void *)(ptr))
+#define string_vec_eq_mask(a, b) ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8((a), (b))))
+#elif defined(__SSE2__)
+typedef __m128i string_vec_t;
+#define STRING_VEC_WIDTH 16
+#define string_vec_splat(ch) _mm_set1_epi8((char)(ch))
+#define string_vec_load(ptr) _mm_loadu_si128((const __m128i *)(const void *)(ptr))
+#define string_vec_eq_mask(a, b) ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8((a), (b))))
+#endif
+
+static inline size_t string_memchr(const char *data, size_t size, char ch) {
+#ifdef STRING_VEC_WIDTH
+    string_vec_t needle = string_vec_splat(ch);
+    size_t i = 0;
+    for (; i + STRING_VEC_WIDTH <= size; i += STRING_VEC_WIDTH) {
+        uint32_t mask = string_vec_eq_mask(string_vec_load(data + i), needle);
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    for (; i < size; i++) {
+        if (data[i] == ch) return i;
+    }
+    return STRING_NPOS;
+#else
+    const char *hit = size ? (const char *)memchr(data, ch, size) : NULL;
+    return hit ? (size_t)(hit - data) : STRING_NPOS;
+#endif
+}
+
+static inline size_t string_memrchr(const char *data, size_t size, char ch) {
+    size_t i = size;
+#ifdef STRING_VEC_WIDTH
+    string_vec_t needle = string_vec_splat(ch);
+    for (; i >= STRING_VEC_WIDTH; i -= STRING_VEC_WIDTH) {
+        uint32_t mask = string_vec_eq_mask(string_vec_load(data + i - STRING_VEC_WIDTH), needle);
+        if (mask) return i - STRING_VEC_WIDTH + (size_t)(31 - __builtin_clz(mask));
+    }
+#endif
+    while (i > 0) {
+        if (data[--i] == ch) return i;
+    }
+    return STRING_NPOS;
+}
+
+static inline size_t string_count_byte(const char *data, size_t size, char ch) {
+    size_t count = 0, i = 0;
+#ifdef STRING_VEC_WIDTH
+    string_vec_t needle = string_vec_splat(ch);
+    for (; i + STRING_VEC_WIDTH <= size; i += STRING_VEC_WIDTH) {
+        count += (size_t)__builtin_popcount(string_vec_eq_mask(string_vec_load(data + i), needle));
+    }
+#endif
+    for (; i < size; i++) count += data[i] == ch;
+    return count;
+}
+
+static inline size_t string_memmem(const char *data, size_t size, const char *needle, size_t needle_size) {
+    if (needle_size == 0) return 0;
+    if (needle_size > size) return STRING_NPOS;
+    if (needle_size == 1) return string_memchr(data, size, needle[0]);
+
+    size_t last = needle_size - 1;
+    size_t i = 0;
+#ifdef STRING_VEC_WIDTH
+    string_vec_t first_byte = string_vec_splat(needle[0]);
+    string_vec_t last_byte = string_vec_splat(needle[last]);
+    for (; i + last + STRING_VEC_WIDTH <= size; i += STRING_VEC_WIDTH) {
+        uint32_t mask = string_vec_eq_mask(string_vec_load(data + i), first_byte) &
+                        string_vec_eq_mask(string_vec_load(data + i + last), last_byte);
+        while (mask) {
+            size_t candidate = i + (size_t)__builtin_ctz(mask);
+            if (memcmp(data + candidate + 1, needle + 1, needle_size - 2) == 0) return candidate;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (i + needle_size <= size) {
+        size_t hit = string_memchr(data + i, size - i - last, needle[0]);
+        if (hit == STRING_NPOS) return STRING_NPOS;
+        i += hit;
+        if (data[i + last] == needle[last] && memcmp(data + i + 1, needle + 1, needle_size - 2) == 0) return i;
+        i++;
+    }
+    return STRING_NPOS;
+}
+
+static inline size_t string_view_find_char(string_view_t view, char ch, size_t pos) {
+    if (unlikely_branch(pos >= view.size)) return STRING_NPOS;
+    size_t hit = string_memchr(view.data + pos, view.size - pos, ch);
+    return hit == STRING_NPOS ? STRING_NPOS : pos + hit;
+}
+
+static inline size_t string_view_rfind_char(string_view_t view, char ch) {
+    return string_memrchr(view.data, view.size, ch);
+}
+
+static inline size_t string_view_find(string_view_t view, string_view_t needle, size_t pos) {
+    if (unlikely_branch(pos > view.size)) return STRING_NPOS;
+    size_t hit = string_memmem(view.data + pos, view.size - pos, needle.data, needle.size);
+    return hit == STRING_NPOS ? STRING_NPOS : pos + hit;
+}
+
+static inline size_t string_view_rfind(string_view_t view, string_view_t needle) {
+    if (needle.size == 0) return view.size;
+    if (needle.size > view.size) return STRING_NPOS;
+    // Walk candidate positions of the needle's last byte backwards
+    size_t last = needle.size - 1;
+    size_t end = view.size;
+    while (end > last) {
+        size_t hit = string_memrchr(view.data + last, end - last, needle.data[last]);
+        if (hit == STRING_NPOS) return STRING_NPOS;
+        if (memcmp(view.data + hit, needle.data, last) == 0) return hit;
+        end = hit + last;
+    }
+    return STRING_NPOS;
+}
+
+static inline size_t string_view_find_any_of(string_view_t view, const char *chars, size_t pos) {
+    size_t nchars = strlen(chars);
+    if (unlikely_branch(pos >= view.size || nchars == 0)) return STRING_NPOS;
+    if (nchars == 1) return string_view_find_char(view, chars[0], pos);
+    size_t i = pos;
+#ifdef STRING_VEC_WIDTH
+    // A few compares per block beat the table lookup for small sets
+    if (nchars <= 8) {
+        string_vec_t set[8];
+        for (size_t k = 0; k < nchars; k++) set[k] = string_vec_splat(chars[k]);
+        for (; i + STRING_VEC_WIDTH <= view.size; i += STRING_VEC_WIDTH) {
+            string_vec_t block = string_vec_load(view.data + i);
+            uint32_t mask = 0;
+            for (size_t k = 0; k < nchars; k++) mask |= string_vec_eq_mask(block, set[k]);
+            if (mask) return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+#endif
+    unsigned char in_set[256] = {0};
+    for (size_t k = 0; k < nchars; k++) in_set[(unsigned char)chars[k]] = 1;
+    for (; i < view.size; i++) {
+        if (in_set[(unsigned char)view.data[i]]) return i;
+    }
+    return STRING_NPOS;
+}
+
+// Non-overlapping occurrences, like Python's str.count
+static inline size_t string_view_count(string_view_t view, string_view_t needle) {
+    if (needle.size == 1) return string_count_byte(view.data, view.size, needle.data[0]);
+    if (unlikely_branch(needle.size == 0)) return view.size + 1;
+    size_t count = 0, pos = 0;
+    while ((pos = string_view_find(view, needle, pos)) != STRING_NPOS) {
+        count++;
+        pos += needle.size;
+    }
+    return count;
+}
+
+static inline size_t string_find(const string_t *str, const char *needle, size_t pos) {
+    return string_view_find(string_view_of(str), string_view_create(needle), pos);
+}
+
+static inline size_t string_find_char(const string_t *str, char ch, size_t pos) {
+    return string_view_find_char(string_view_of(str), ch, pos);
+}
+
+static inline size_t string_rfind(const string_t *str, const char *needle) {
+    return string_view_rfind(string_view_of(str), string_view_create(needle));
+}
+
+static inline size_t string_find_any_of(const string_t *str, const char *chars, size_t pos) {
+    return string_view_find_any_of(string_view_of(str), chars, pos);
+}
+
+static inline size_t string_count(const string_t *str, const char *needle) {
+    return string_view_count(string_view_of(str), string_view_create(needle));
+}
+
+/*
+ * Replaces every non-overlapping occurrence of from with to in a single pass. Shrinking replacements are done in
+ * place, growing ones build the result in a buffer sized up front. from/to must not point into str.
+ */
+static inline int string_replace_all(string_t *str, const char *from, const char *to) {
+    string_view_t view = string_view_of(str);
+    size_t from_len = strlen(from), to_len = strlen(to);
+    if (unlikely_branch(from_len == 0)) return 0;
+    size_t first = string_memmem(view.data, view.size, from, from_len);
+    if (first == STRING_NPOS) return 1;
+
+    if (to_len <= from_len) {
+        char *data = string_data(str);
+        size_t read = first, write = first;
+        while (read != STRING_NPOS) {
+            memcpy(data + write, to, to_len);
+            write += to_len;
+            read += from_len;
+            size_t next = string_memmem(data + read, view.size - read, from, from_len);
+            size_t keep = next == STRING_NPOS ? view.size - read : next;
+            memmove(data + write, data + read, keep);
+            write += keep;
+            read = next == STRING_NPOS ? STRING_NPOS : read + next;
+        }
+        string_set_size(str, write);
+        return 1;
+    }
+
+    size_t count = string_view_count(view, string_view_create_n(from, from_len));
+    string_t result = string_create_empty();
+    if (unlikely_branch(!string_reserve(&result, view.size + count * (to_len - from_len)))) return 0;
+    size_t pos = 0, hit = first;
+    while (hit != STRING_NPOS) {
+        string_append_n(&result, view.data + pos, hit - pos);
+        string_append_n(&result, to, to_len);
+        pos = hit + from_len;
+        hit = string_view_find(view, string_view_create_n(from, from_len), pos);
+    }
+    string_append_n(&result, view.data + pos, view.size - pos);
+    string_free(str);
+    *str = result;
+    return 1;
+}
+
+/*************************************/
+/**************Numbers****************/
 /*************************************/
 
-int string_compare(const string_t *a, const string_t *b) { return strcmp(string_get_cstr(a), string_get_cstr(b)); }
+/*
+ * Number formatting writes straight into the spare capacity instead of going through snprintf and a temporary
+ * buffer, two digits at a time from a lookup table. Parsing works on views, accepts exactly the number and nothing
+ * else (no whitespace, no trailing chars) and is independent of the locale: the rare double fallbacks that go through
+ * snprintf/strtod switch the calling thread to the "C" numeric locale around those calls.
+ *
+ * string_append_double prints the shortest decimal that reads back to the same double: plain fixed notation for
+ * values that have an exact short decimal form (0.1, 1234.5, 3), %.17g-style exponents otherwise.
+ */
+
+static const char string_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Powers of ten that are exact as doubles
+static const double string_pow10[23] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static inline unsigned string_count_digits(uint64_t value) {
+    unsigned digits = 1;
+    while (value >= 10000) {
+        value /= 10000;
+        digits += 4;
+    }
+    return digits + (value >= 10) + (value >= 100) + (value >= 1000);
+}
+
+// Writes the digits of value so that the last one ends right before end
+static inline void string_write_digits(char *end, uint64_t value) {
+    while (value >= 100) {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        end -= 2;
+        memcpy(end, string_digit_pairs + pair, 2);
+    }
+    if (value >= 10) {
+        memcpy(end - 2, string_digit_pairs + value * 2, 2);
+    } else {
+        end[-1] = (char)('0' + value);
+    }
+}
+
+// Appends an optional '-' and the digits of magnitude with a single reserve
+static inline int string_append_magnitude(string_t *str, int negative, uint64_t magnitude) {
+    size_t len = string_size(str);
+    size_t total = (size_t)negative + string_count_digits(magnitude);
+    if (unlikely_branch(!string_reserve(str, len + total))) return 0;
+    char *dst = string_data(str) + len;
+    if (negative) *dst = '-';
+    string_write_digits(dst + total, magnitude);
+    string_set_size(str, len + total);
+    return 1;
+}
+
+static inline int string_append_uint(string_t *str, uint64_t value) { return string_append_magnitude(str, 0, value); }
+
+static inline int string_append_int(string_t *str, int64_t value) {
+    // Negate in unsigned arithmetic so INT64_MIN does not overflow
+    uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+    return string_append_magnitude(str, value < 0, magnitude);
+}
+
+/*
+ * Shortest fixed notation: the smallest k such that round(|value| * 10^k) / 10^k reads back as value. Both the
+ * scaled integer (below 2^53) and 10^k (k <= 22) are exact doubles, so the division is correctly rounded and the
+ * check is exact. Returns 0 when value has no such short form.
+ */
+static inline int string_append_double_fixed(string_t *str, double value) {
+    double magnitude = value < 0 ? -value : value;
+    const double limit = 9007199254740992.0;  // 2^53
+    if (magnitude >= limit) return 0;
+    for (unsigned k = 0; k < 23; k++) {
+        double scaled = magnitude * string_pow10[k];
+        if (scaled >= limit) return 0;
+        uint64_t mantissa = (uint64_t)(scaled + 0.5);
+        if ((double)mantissa / string_pow10[k] != magnitude) continue;
+        if (k == 0) return string_append_magnitude(str, value < 0, mantissa);
+
+        // mantissa * 10^-k: digits, with the point k places from the right and zeros padded in front
+        unsigned digits = string_count_digits(mantissa);
+        unsigned int_digits = digits > k ? digits - k : 1;
+        size_t total = (size_t)(value < 0) + int_digits + 1 + k;
+        size_t len = string_size(str);
+        if (unlikely_branch(!string_reserve(str, len + total))) return -1;
+        char *dst = string_data(str) + len;
+        char *end = dst + total;
+        if (value < 0) *dst++ = '-';
+        memset(dst, '0', (size_t)(end - dst));
+        string_write_digits(end, mantissa);
+        // Slide the integer part one char left to open the decimal point
+        memmove(dst, dst + 1, int_digits);
+        dst[int_digits] = '.';
+        string_set_size(str, len + total);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Runs the snprintf/strtod fallbacks in the "C" locale, so a ',' decimal separator in LC_NUMERIC neither ends up in
+ * the output nor stops the parse early. uselocale only affects the calling thread. The locale object is created on
+ * first use and kept for the life of the process. Without POSIX 2008 locales the calls stay in the current locale.
+ */
+#if defined(LC_NUMERIC_MASK)
+static inline locale_t string_c_locale(void) {
+    static locale_t c_locale = (locale_t)0;
+#if defined(__GNUC__) || defined(__clang__)
+    locale_t current = __atomic_load_n(&c_locale, __ATOMIC_ACQUIRE);
+    if (likely_branch(current)) return current;
+    locale_t created = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    if (unlikely_branch(!created)) return (locale_t)0;
+    // Another thread may have won the race, keep its object
+    if (!__atomic_compare_exchange_n(&c_locale, &current, created, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        freelocale(created);
+        return current;
+    }
+    return created;
+#else
+    if (!c_locale) c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    return c_locale;
+#endif
+}
+
+typedef locale_t string_c_numeric_t;
+
+// Returns the locale to restore, (locale_t)0 when the switch did not happen
+static inline string_c_numeric_t string_c_numeric_enter(void) {
+    locale_t c_locale = string_c_locale();
+    return likely_branch(c_locale) ? uselocale(c_locale) : (locale_t)0;
+}
+
+static inline void string_c_numeric_leave(string_c_numeric_t previous) {
+    if (likely_branch(previous)) uselocale(previous);
+}
+#else
+typedef int string_c_numeric_t;
+static inline string_c_numeric_t string_c_numeric_enter(void) { return 0; }
+static inline void string_c_numeric_leave(string_c_numeric_t previous) { (void)previous; }
+#endif
+
+/*
+ * Shortest round trip digits with Grisu3 (F. Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with
+ * Integers", 2010). value is scaled by a cached power of ten into a 64 bit fixed point window and the digits are
+ * generated with integer arithmetic only. For about 0.5% of inputs Grisu3 cannot prove its result is the shortest
+ * and closest one and gives up; those go to string_double_digits_exact.
+ */
+
+// 64 bit significand with a binary exponent: f * 2^e
+typedef struct string_diy_fp_t {
+    uint64_t f;
+    int e;
+} string_diy_fp_t;
+
+// Normalized 10^k for k = -348, -340, ..., 340, rounded to nearest: {significand, binary exponent, k}
+static const struct {
+    uint64_t f;
+    int16_t e;
+    int16_t k;
+} string_cached_pow10[87] = {
+    {0xfa8fd5a0081c0288ull, -1220, -348}, {0xbaaee17fa23ebf76ull, -1193, -340}, {0x8b16fb203055ac76ull, -1166, -332},
+    {0xcf42894a5dce35eaull, -1140, -324}, {0x9a6bb0aa55653b2dull, -1113, -316}, {0xe61acf033d1a45dfull, -1087, -308},
+    {0xab70fe17c79ac6caull, -1060, -300}, {0xff77b1fcbebcdc4full, -1034, -292}, {0xbe5691ef416bd60cull, -1007, -284},
+    {0x8dd01fad907ffc3cull, -980, -276}, {0xd3515c2831559a83ull, -954, -268}, {0x9d71ac8fada6c9b5ull, -927, -260},
+    {0xea9c227723ee8bcbull, -901, -252}, {0xaecc49914078536dull, -874, -244}, {0x823c12795db6ce57ull, -847, -236},
+    {0xc21094364dfb5637ull, -821, -228}, {0x9096ea6f3848984full, -794, -220}, {0xd77485cb25823ac7ull, -768, -212},
+    {0xa086cfcd97bf97f4ull, -741, -204}, {0xef340a98172aace5ull, -715, -196}, {0xb23867fb2a35b28eull, -688, -188},
+    {0x84c8d4dfd2c63f3bull, -661, -180}, {0xc5dd44271ad3cdbaull, -635, -172}, {0x936b9fcebb25c996ull, -608, -164},
+    {0xdbac6c247d62a584ull, -582, -156}, {0xa3ab66580d5fdaf6ull, -555, -148}, {0xf3e2f893dec3f126ull, -529, -140},
+    {0xb5b5ada8aaff80b8ull, -502, -132}, {0x87625f056c7c4a8bull, -475, -124}, {0xc9bcff6034c13053ull, -449, -116},
+    {0x964e858c91ba2655ull, -422, -108}, {0xdff9772470297ebdull, -396, -100}, {0xa6dfbd9fb8e5b88full, -369, -92},
+    {0xf8a95fcf88747d94ull, -343, -84}, {0xb94470938fa89bcfull, -316, -76}, {0x8a08f0f8bf0f156bull, -289, -68},
+    {0xcdb02555653131b6ull, -263, -60}, {0x993fe2c6d07b7facull, -236, -52}, {0xe45c10c42a2b3b06ull, -210, -44},
+    {0xaa242499697392d3ull, -183, -36}, {0xfd87b5f28300ca0eull, -157, -28}, {0xbce5086492111aebull, -130, -20},
+    {0x8cbccc096f5088ccull, -103, -12}, {0xd1b71758e219652cull, -77, -4}, {0x9c40000000000000ull, -50, 4},
+    {0xe8d4a51000000000ull, -24, 12}, {0xad78ebc5ac620000ull, 3, 20}, {0x813f3978f8940984ull, 30, 28},
+    {0xc097ce7bc90715b3ull, 56, 36}, {0x8f7e32ce7bea5c70ull, 83, 44}, {0xd5d238a4abe98068ull, 109, 52},
+    {0x9f4f2726179a2245ull, 136, 60}, {0xed63a231d4c4fb27ull, 162, 68}, {0xb0de65388cc8ada8ull, 189, 76},
+    {0x83c7088e1aab65dbull, 216, 84}, {0xc45d1df942711d9aull, 242, 92}, {0x924d692ca61be758ull, 269, 100},
+    {0xda01ee641a708deaull, 295, 108}, {0xa26da3999aef774aull, 322, 116}, {0xf209787bb47d6b85ull, 348, 124},
+    {0xb454e4a179dd1877ull, 375, 132}, {0x865b86925b9bc5c2ull, 402, 140}, {0xc83553c5c8965d3dull, 428, 148},
+    {0x952ab45cfa97a0b3ull, 455, 156}, {0xde469fbd99a05fe3ull, 481, 164}, {0xa59bc234db398c25ull, 508, 172},
+    {0xf6c69a72a3989f5cull, 534, 180}, {0xb7dcbf5354e9beceull, 561, 188}, {0x88fcf317f22241e2ull, 588, 196},
+    {0xcc20ce9bd35c78a5ull, 614, 204}, {0x98165af37b2153dfull, 641, 212}, {0xe2a0b5dc971f303aull, 667, 220},
+    {0xa8d9d1535ce3b396ull, 694, 228}, {0xfb9b7cd9a4a7443cull, 720, 236}, {0xbb764c4ca7a44410ull, 747, 244},
+    {0x8bab8eefb6409c1aull, 774, 252}, {0xd01fef10a657842cull, 800, 260}, {0x9b10a4e5e9913129ull, 827, 268},
+    {0xe7109bfba19c0c9dull, 853, 276}, {0xac2820d9623bf429ull, 880, 284}, {0x80444b5e7aa7cf85ull, 907, 292},
+    {0xbf21e44003acdd2dull, 933, 300}, {0x8e679c2f5e44ff8full, 960, 308}, {0xd433179d9c8cb841ull, 986, 316},
+    {0x9e19db92b4e31ba9ull, 1013, 324}, {0xeb96bf6ebadf77d9ull, 1039, 332}, {0xaf87023b9bf0ee6bull, 1066, 340}};
+
+static inline string_diy_fp_t string_diy_fp_make(uint64_t f, int e) {
+    string_diy_fp_t fp = {f, e};
+    return fp;
+}
+
+static inline string_diy_fp_t string_diy_fp_normalize(string_diy_fp_t fp) {
+    while (!(fp.f & 0xFFC0000000000000ull)) {
+        fp.f <<= 10;
+        fp.e -= 10;
+    }
+    while (!(fp.f & 0x8000000000000000ull)) {
+        fp.f <<= 1;
+        fp.e--;
+    }
+    return fp;
+}
+
+// Upper 64 bits of the 128 bit product, rounded
+static inline string_diy_fp_t string_diy_fp_times(string_diy_fp_t x, string_diy_fp_t y) {
+    uint64_t a = x.f >> 32, b = x.f & 0xFFFFFFFFu, c = y.f >> 32, d = y.f & 0xFFFFFFFFu;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & 0xFFFFFFFFu) + (bc & 0xFFFFFFFFu) + (1u << 31);
+    return string_diy_fp_make(ac + (ad >> 32) + (bc >> 32) + (middle >> 32), x.e + y.e + 64);
+}
+
+/*
+ * Moves the last digit towards the value while that keeps it inside the rounding interval, then checks the result
+ * is safe despite the scaling error of `unit`. Returns 0 when it cannot tell.
+ */
+static inline int string_grisu_round_weed(char *digits, int length, uint64_t distance_too_high_w,
+                                          uint64_t unsafe_interval, uint64_t rest, uint64_t ten_kappa,
+                                          uint64_t unit) {
+    uint64_t small_distance = distance_too_high_w - unit;
+    uint64_t big_distance = distance_too_high_w + unit;
+    while (rest < small_distance && unsafe_interval - rest >= ten_kappa &&
+           (rest + ten_kappa < small_distance || small_distance - rest >= rest + ten_kappa - small_distance)) {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+    if (rest < big_distance && unsafe_interval - rest >= ten_kappa &&
+        (rest + ten_kappa < big_distance || big_distance - rest > rest + ten_kappa - big_distance)) {
+        return 0;
+    }
+    return 2 * unit <= rest && rest <= unsafe_interval - 4 * unit;
+}
+
+/*
+ * Writes the shortest digits of value (positive, finite, non zero) to digits, without a point: value reads back
+ * from digits * 10^exponent. Returns the digit count, 0 when Grisu3 gave up.
+ */
+static inline int string_double_digits_grisu(double value, char digits[18], int *exponent) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t significand = bits & 0x000FFFFFFFFFFFFFull;
+    int biased = (int)((bits >> 52) & 0x7FF);
+    string_diy_fp_t v = biased ? string_diy_fp_make(significand | 0x0010000000000000ull, biased - 1075)
+                               : string_diy_fp_make(significand, -1074);
+
+    // The rounding interval [minus, plus]: halfway to the neighbours, the lower one is closer at a power of two
+    string_diy_fp_t plus = string_diy_fp_normalize(string_diy_fp_make((v.f << 1) + 1, v.e - 1));
+    string_diy_fp_t minus = significand == 0 && biased > 1 ? string_diy_fp_make((v.f << 2) - 1, v.e - 2)
+                                                           : string_diy_fp_make((v.f << 1) - 1, v.e - 1);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    string_diy_fp_t w = string_diy_fp_normalize(v);
+
+    // Cached power that brings the binary exponent of the products into [-60, -32]
+    double estimate = (-61 - w.e) * 0.30102999566398114;
+    int k = (int)estimate;
+    if (k < estimate) k++;
+    int index = (348 + k - 1) / 8 + 1;
+    string_diy_fp_t power = string_diy_fp_make(string_cached_pow10[index].f, string_cached_pow10[index].e);
+    *exponent = -string_cached_pow10[index].k;
+
+    w = string_diy_fp_times(w, power);
+    minus = string_diy_fp_times(minus, power);
+    plus = string_diy_fp_times(plus, power);
+
+    // Digit generation on the widened interval (too_low, too_high), which surely contains the value
+    uint64_t unit = 1;
+    uint64_t too_low = minus.f - unit, too_high = plus.f + unit;
+    uint64_t unsafe_interval = too_high - too_low;
+    int shift = -w.e;
+    uint64_t one = 1ull << shift;
+    uint32_t integrals = (uint32_t)(too_high >> shift);
+    uint64_t fractionals = too_high & (one - 1);
+    uint32_t divisor = 1;
+    int kappa = 1;
+    while (integrals / divisor >= 10) {
+        divisor *= 10;
+        kappa++;
+    }
+
+    int length = 0;
+    while (kappa > 0) {
+        digits[length++] = (char)('0' + integrals / divisor);
+        integrals %= divisor;
+        kappa--;
+        uint64_t rest = ((uint64_t)integrals << shift) + fractionals;
+        if (rest < unsafe_interval) {
+            *exponent += kappa;
+            int ok = string_grisu_round_weed(digits, length, too_high - w.f, unsafe_interval, rest,
+                                             (uint64_t)divisor << shift, unit);
+            return ok ? length : 0;
+        }
+        divisor /= 10;
+    }
+    while (length < 17) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafe_interval *= 10;
+        digits[length++] = (char)('0' + (fractionals >> shift));
+        fractionals &= one - 1;
+        kappa--;
+        if (fractionals < unsafe_interval) {
+            *exponent += kappa;
+            int ok = string_grisu_round_weed(digits, length, (too_high - w.f) * unit, unsafe_interval, fractionals,
+                                             one, unit);
+            return ok ? length : 0;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Fallback for the inputs Grisu3 rejects: the fewest significant digits P for which %.Pe reads back, found by
+ * bisection between 1 and 17, so at most five snprintf/strtod pairs run in the "C" locale. 17 digits always read
+ * back and `high` only ever takes counts that did, so the result always round trips.
+ */
+static inline int string_double_digits_exact(double value, char digits[18], int *exponent) {
+    char buffer[32];
+    int low = 1, high = 17;
+    string_c_numeric_t previous = string_c_numeric_enter();
+    while (low < high) {
+        int middle = (low + high) / 2;
+        snprintf(buffer, sizeof(buffer), "%.*e", middle - 1, value);
+        if (strtod(buffer, NULL) == value) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    snprintf(buffer, sizeof(buffer), "%.*e", low - 1, value);
+    string_c_numeric_leave(previous);
+
+    // d.ddde[+-]x -> digits and the exponent of the last digit
+    int length = 0;
+    const char *p = buffer;
+    for (; *p != 'e'; p++) {
+        if (*p >= '0' && *p <= '9') digits[length++] = *p;
+    }
+    *exponent = atoi(p + 1) - (length - 1);
+    return length;
+}
+
+static inline int string_append_double(string_t *str, double value) {
+    if (isnan(value)) return string_append_n(str, "nan", 3);
+    if (isinf(value)) return value < 0 ? string_append_n(str, "-inf", 4) : string_append_n(str, "inf", 3);
+    if (value == 0) return signbit(value) ? string_append_n(str, "-0", 2) : string_append_n(str, "0", 1);
+
+    int fixed = string_append_double_fixed(str, value);
+    if (fixed != 0) return fixed > 0;
+
+    // Very large, very small or long fractions: the shortest digits, laid out the way %.<digits>g would
+    char digits[18];
+    int exponent;
+    double magnitude = value < 0 ? -value : value;
+    int length = string_double_digits_grisu(magnitude, digits, &exponent);
+    if (unlikely_branch(length == 0)) length = string_double_digits_exact(magnitude, digits, &exponent);
+    while (length > 1 && digits[length - 1] == '0') {
+        length--;
+        exponent++;
+    }
 
-int string_equals(const string_t *a, const string_t *b) { return string_compare(a, b) == 0; }
+    char buffer[32];
+    char *out = buffer;
+    if (value < 0) *out++ = '-';
+    int point = length + exponent;  // Digits before the decimal point
+    if (point > -4 && point <= length) {
+        if (point <= 0) {
+            *out++ = '0';
+            *out++ = '.';
+            for (int i = point; i < 0; i++) *out++ = '0';
+            memcpy(out, digits, (size_t)length);
+            out += length;
+        } else {
+            memcpy(out, digits, (size_t)point);
+            out += point;
+            if (point < length) {
+                *out++ = '.';
+                memcpy(out, digits + point, (size_t)(length - point));
+                out += length - point;
+            }
+        }
+    } else {
+        int scientific = point - 1;
+        *out++ = digits[0];
+        if (length > 1) {
+            *out++ = '.';
+            memcpy(out, digits + 1, (size_t)(length - 1));
+            out += length - 1;
+        }
+        *out++ = 'e';
+        *out++ = scientific < 0 ? '-' : '+';
+        unsigned magnitude_exp = (unsigned)(scientific < 0 ? -scientific : scientific);
+        if (magnitude_exp < 10) *out++ = '0';
+        char *end = out + string_count_digits(magnitude_exp);
+        string_write_digits(end, magnitude_exp);
+        out = end;
+    }
+    return string_append_n(str, buffer, (size_t)(out - buffer));
+}
+
+/*
+ * Parsing. Every function returns 1 and stores the result when the whole view is a valid number, and 0 on empty
+ * input, stray chars or overflow (out is left untouched).
+ */
+
+static inline int string_view_parse_uint(string_view_t view, uint64_t *out) {
+    if (unlikely_branch(view.size == 0)) return 0;
+    uint64_t value = 0;
+    for (size_t i = 0; i < view.size; i++) {
+        unsigned digit = (unsigned)(unsigned char)view.data[i] - '0';
+        if (unlikely_branch(digit > 9)) return 0;
+        if (unlikely_branch(value > (UINT64_MAX - digit) / 10)) return 0;
+        value = value * 10 + digit;
+    }
+    *out = value;
+    return 1;
+}
+
+static inline int string_view_parse_int(string_view_t view, int64_t *out) {
+    int negative = view.size > 0 && view.data[0] == '-';
+    if (view.size > 0 && (view.data[0] == '-' || view.data[0] == '+')) view = string_view_substr(view, 1, view.size);
+    uint64_t magnitude;
+    if (unlikely_branch(!string_view_parse_uint(view, &magnitude))) return 0;
+    if (negative) {
+        if (unlikely_branch(magnitude > (uint64_t)INT64_MAX + 1)) return 0;
+        *out = magnitude == (uint64_t)INT64_MAX + 1 ? INT64_MIN : -(int64_t)magnitude;
+    } else {
+        if (unlikely_branch(magnitude > (uint64_t)INT64_MAX)) return 0;
+        *out = (int64_t)magnitude;
+    }
+    return 1;
+}
+
+/*
+ * Accepts [+-]digits[.digits][(e|E)[+-]digits] plus inf/infinity/nan. When the significant digits fit in 2^53 and
+ * the decimal exponent is within +-22, the result is one exact multiplication or division (Clinger's fast path);
+ * everything else goes to strtod on a null terminated copy. Finite input beyond DBL_MAX, or nonzero input that
+ * would round to 0, is rejected; subnormal results are accepted.
+ */
+static inline int string_view_parse_double(string_view_t view, double *out) {
+    const char *p = view.data, *end = view.data + view.size;
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    size_t rest = (size_t)(end - p);
+    if (rest > 0 && (*p < '0' || *p > '9') && *p != '.') {
+        static const char *const words[] = {"inf", "infinity", "nan"};
+        for (int i = 0; i < 3; i++) {
+            if (rest != strlen(words[i])) continue;
+            size_t j = 0;
+            while (j < rest && (p[j] | 0x20) == words[i][j]) j++;  // ASCII case-insensitive
+            if (j == rest) {
+                double special = i < 2 ? HUGE_VAL : NAN;
+                *out = negative ? -special : special;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    uint64_t mantissa = 0;
+    int significant = 0, digits = 0, exponent = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        if (mantissa == 0 && *p == '0') continue;  // Leading zeros are not significant
+        if (significant < 19) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        } else {
+            exponent++;
+        }
+        significant++;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            if (mantissa == 0 && *p == '0') {
+                exponent--;
+                continue;
+            }
+            if (significant < 19) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                exponent--;
+            }
+            significant++;
+        }
+    }
+    if (unlikely_branch(digits == 0)) return 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        int exp_negative = 0;
+        if (p < end && (*p == '-' || *p == '+')) exp_negative = *p++ == '-';
+        if (unlikely_branch(p == end)) return 0;
+        int explicit_exponent = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (explicit_exponent < 100000) explicit_exponent = explicit_exponent * 10 + (*p - '0');
+        }
+        exponent += exp_negative ? -explicit_exponent : explicit_exponent;
+    }
+    if (unlikely_branch(p != end)) return 0;
+
+    if (significant <= 19 && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / string_pow10[-exponent] : value * string_pow10[exponent];
+        *out = negative ? -value : value;
+        return 1;
+    }
+
+    // Syntax is already validated, strtod only has to do the rounding. It must still consume the whole copy.
+    char small[64];
+    char *copy = view.size < sizeof(small) ? small : (char *)malloc(view.size + 1);
+    if (unlikely_branch(!copy)) return 0;
+    memcpy(copy, view.data, view.size);
+    copy[view.size] = '\0';
+    char *parsed_end;
+    string_c_numeric_t scope = string_c_numeric_enter();
+    double value = strtod(copy, &parsed_end);
+    string_c_numeric_leave(scope);
+    int ok = parsed_end == copy + view.size;
+    if (copy != small) free(copy);
+    if (unlikely_branch(!ok)) return 0;
+    // Like the integer parsers, out of range is an error: no saturation to inf and no flushing a nonzero to 0
+    if (unlikely_branch(isinf(value) || (value == 0 && mantissa != 0))) return 0;
+    *out = value;
+    return 1;
+}
+
+static inline int string_parse_uint(const string_t *str, uint64_t *out) {
+    return string_view_parse_uint(string_view_of(str), out);
+}
+
+static inline int string_parse_int(const string_t *str, int64_t *out) {
+    return string_view_parse_int(string_view_of(str), out);
+}
+
+static inline int string_parse_double(const string_t *str, double *out) {
+    return string_view_parse_double(string_view_of(str), out);
+}
 
 #ifdef __cplusplus
 }
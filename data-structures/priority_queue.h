@@ -0,0 +1,291 @@
+#ifndef _POCKET_DATA_STRUCTURES_PRIORITY_QUEUE_H
+#define _POCKET_DATA_STRUCTURES_PRIORITY_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynamic_array.h"
+
+/*
+ * Priority queue as an implicit 4-ary heap stored in a DYN_ARRAY.
+ *
+ *   PRIORITY_QUEUE_DECLARE(timers, deadline_t, DEADLINE_CMP)
+ *   PRIORITY_QUEUE_IMPLEMENT(timers, deadline_t, DEADLINE_CMP)
+ *
+ * CMP(a, b) returns <0, 0 or >0 like strcmp, and the element ordered first (the smallest) is on top. CMP may be a
+ * function or a function-like macro and is expanded inline. Four children per node halve the height of a binary
+ * heap and the children of a node share one or two cache lines, so pops touch fewer lines.
+ *
+ * push_bounded keeps only the k greatest elements pushed so far, evicting the top, which is the usual top-K setup.
+ *
+ * A queue created with handles also hands out a handle per pushed element, which stays valid until the element is
+ * popped or removed and allows changing its priority (decrease-key) or removing it in O(log n). The handle map
+ * costs two extra size_t per element, queues without handles pay nothing for it.
+ */
+
+#define PRIORITY_QUEUE_ARITY 4
+
+/*
+ * Marks free handles, whose position_of entry then links to the next free handle instead of a heap position. The
+ * last free handle links to PRIORITY_QUEUE_FREE_END, which unlike PRIORITY_QUEUE_NO_HANDLE survives masking out the
+ * mark.
+ */
+#define PRIORITY_QUEUE_FREE_HANDLE (SIZE_MAX ^ (SIZE_MAX >> 1))
+#define PRIORITY_QUEUE_FREE_END (SIZE_MAX >> 1)
+#define PRIORITY_QUEUE_NO_HANDLE SIZE_MAX
+
+#define PRIORITY_QUEUE_DECLARE(DECL_NAME, TYPE, CMP)                                                          \
+    DYN_ARRAY_DECLARE(DECL_NAME##_items, TYPE)                                                                \
+    DYN_ARRAY_DECLARE(DECL_NAME##_index, size_t)                                                              \
+                                                                                                              \
+    typedef struct DECL_NAME##_t {                                                                            \
+        DECL_NAME##_items_t *items;                                                                           \
+        DECL_NAME##_index_t *handle_at;   /* Handle of each heap position, NULL for queues without handles */ \
+        DECL_NAME##_index_t *position_of; /* Heap position of each handle */                                  \
+        size_t free_handle;               /* Head of the free handle list */                                  \
+    } DECL_NAME##_t;                                                                                          \
+                                                                                                              \
+    /* items is NULL if the allocation failed */                                                              \
+    DECL_NAME##_t DECL_NAME##_create(size_t initial_capacity, bool with_handles);                             \
+    void DECL_NAME##_free(DECL_NAME##_t *queue);                                                              \
+    void DECL_NAME##_clear(DECL_NAME##_t *queue);                                                             \
+    size_t DECL_NAME##_size(const DECL_NAME##_t *queue);                                                      \
+                                                                                                              \
+    int DECL_NAME##_push(DECL_NAME##_t *queue, TYPE value);                                                   \
+                                                                                                              \
+    /* Return a zero value when empty */                                                                      \
+    TYPE DECL_NAME##_top(const DECL_NAME##_t *queue);                                                         \
+    TYPE DECL_NAME##_pop(DECL_NAME##_t *queue);                                                               \
+                                                                                                              \
+    /* Adds count elements at once and restores the heap in O(size) (Floyd). Not for queues with handles. */  \
+    int DECL_NAME##_heapify(DECL_NAME##_t *queue, const TYPE *values, size_t count);                          \
+                                                                                                              \
+    /* Pushes value while keeping at most k elements, the greatest ones. Returns 1 if value was kept.         \
+       Not for queues with handles. */                                                                        \
+    int DECL_NAME##_push_bounded(DECL_NAME##_t *queue, TYPE value, size_t k);                                 \
+                                                                                                              \
+    /* Handle map, only for queues created with handles */                                                    \
+    int DECL_NAME##_push_handle(DECL_NAME##_t *queue, TYPE value, size_t *handle);                            \
+    int DECL_NAME##_contains(const DECL_NAME##_t *queue, size_t handle);                                      \
+    TYPE DECL_NAME##_get(const DECL_NAME##_t *queue, size_t handle);                                          \
+    /* Changes the element's value, moving it up (decrease-key) or down as needed */                          \
+    int DECL_NAME##_update(DECL_NAME##_t *queue, size_t handle, TYPE value);                                  \
+    int DECL_NAME##_remove(DECL_NAME##_t *queue, size_t handle);                                              \
+                                                                                                              \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *queue);
+
+#define PRIORITY_QUEUE_IMPLEMENT(DECL_NAME, TYPE, CMP)                                                      \
+    DYN_ARRAY_IMPLEMENT(DECL_NAME##_items, TYPE)                                                            \
+    DYN_ARRAY_IMPLEMENT(DECL_NAME##_index, size_t)                                                          \
+                                                                                                            \
+    DECL_NAME##_t DECL_NAME##_create(size_t initial_capacity, bool with_handles) {                          \
+        DECL_NAME##_t queue = {NULL, NULL, NULL, PRIORITY_QUEUE_NO_HANDLE};                                 \
+        /* The dynamic array cannot grow from a capacity of 0 */                                            \
+        size_t capacity = initial_capacity ? initial_capacity : 16;                                         \
+        queue.items = DECL_NAME##_items_create(capacity);                                                   \
+        if (with_handles && queue.items) {                                                                  \
+            queue.handle_at = DECL_NAME##_index_create(capacity);                                           \
+            queue.position_of = DECL_NAME##_index_create(capacity);                                         \
+            if (!queue.handle_at || !queue.position_of) DECL_NAME##_free(&queue);                           \
+        }                                                                                                   \
+        return queue;                                                                                       \
+    }                                                                                                       \
+                                                                                                            \
+    void DECL_NAME##_free(DECL_NAME##_t *queue) {                                                           \
+        DECL_NAME##_items_free(queue->items);                                                               \
+        DECL_NAME##_index_free(queue->handle_at);                                                           \
+        DECL_NAME##_index_free(queue->position_of);                                                         \
+        queue->items = NULL;                                                                                \
+        queue->handle_at = queue->position_of = NULL;                                                       \
+        queue->free_handle = PRIORITY_QUEUE_NO_HANDLE;                                                      \
+    }                                                                                                       \
+                                                                                                            \
+    void DECL_NAME##_clear(DECL_NAME##_t *queue) {                                                          \
+        queue->items->size = 0;                                                                             \
+        if (queue->handle_at) {                                                                             \
+            queue->handle_at->size = 0;                                                                     \
+            queue->position_of->size = 0;                                                                   \
+            queue->free_handle = PRIORITY_QUEUE_NO_HANDLE;                                                  \
+        }                                                                                                   \
+    }                                                                                                       \
+                                                                                                            \
+    size_t DECL_NAME##_size(const DECL_NAME##_t *queue) { return queue->items->size; }                      \
+                                                                                                            \
+    /* Writes value (and its handle) at a heap position */                                                  \
+    static inline void DECL_NAME##_place(DECL_NAME##_t *queue, size_t pos, TYPE value, size_t handle) {     \
+        queue->items->data[pos] = value;                                                                    \
+        if (queue->handle_at) {                                                                             \
+            queue->handle_at->data[pos] = handle;                                                           \
+            queue->position_of->data[handle] = pos;                                                         \
+        }                                                                                                   \
+    }                                                                                                       \
+                                                                                                            \
+    static inline size_t DECL_NAME##_handle_at(const DECL_NAME##_t *queue, size_t pos) {                    \
+        return queue->handle_at ? queue->handle_at->data[pos] : PRIORITY_QUEUE_NO_HANDLE;                   \
+    }                                                                                                       \
+                                                                                                            \
+    /* Moves parents down until value fits at pos: the hole moves instead of swapping at every level */     \
+    static void DECL_NAME##_sift_up(DECL_NAME##_t *queue, size_t pos, TYPE value, size_t handle) {          \
+        TYPE *data = queue->items->data;                                                                    \
+        while (pos > 0) {                                                                                   \
+            size_t parent = (pos - 1) / PRIORITY_QUEUE_ARITY;                                               \
+            if (CMP(value, data[parent]) >= 0) break;                                                       \
+            DECL_NAME##_place(queue, pos, data[parent], DECL_NAME##_handle_at(queue, parent));              \
+            pos = parent;                                                                                   \
+        }                                                                                                   \
+        DECL_NAME##_place(queue, pos, value, handle);                                                       \
+    }                                                                                                       \
+                                                                                                            \
+    /* Moves the smallest child up until value fits at pos */                                               \
+    static void DECL_NAME##_sift_down(DECL_NAME##_t *queue, size_t pos, TYPE value, size_t handle) {        \
+        TYPE *data = queue->items->data;                                                                    \
+        size_t size = queue->items->size;                                                                   \
+        while (1) {                                                                                         \
+            size_t first = pos * PRIORITY_QUEUE_ARITY + 1;                                                  \
+            if (first >= size) break;                                                                       \
+            size_t end = size - first > PRIORITY_QUEUE_ARITY ? first + PRIORITY_QUEUE_ARITY : size;         \
+            size_t best = first;                                                                            \
+            for (size_t child = first + 1; child < end; child++) {                                          \
+                if (CMP(data[child], data[best]) < 0) best = child;                                         \
+            }                                                                                               \
+            if (CMP(data[best], value) >= 0) break;                                                         \
+            DECL_NAME##_place(queue, pos, data[best], DECL_NAME##_handle_at(queue, best));                  \
+            pos = best;                                                                                     \
+        }                                                                                                   \
+        DECL_NAME##_place(queue, pos, value, handle);                                                       \
+    }                                                                                                       \
+                                                                                                            \
+    int DECL_NAME##_push(DECL_NAME##_t *queue, TYPE value) {                                                \
+        if (queue->handle_at) return DECL_NAME##_push_handle(queue, value, NULL);                           \
+        if (unlikely_branch(!DECL_NAME##_items_push_back(queue->items, value))) return 0;                   \
+        DECL_NAME##_sift_up(queue, queue->items->size - 1, value, PRIORITY_QUEUE_NO_HANDLE);                \
+        return 1;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    TYPE DECL_NAME##_top(const DECL_NAME##_t *queue) { return DECL_NAME##_items_get(queue->items, 0); }     \
+                                                                                                            \
+    static void DECL_NAME##_release_handle(DECL_NAME##_t *queue, size_t handle) {                           \
+        size_t next = queue->free_handle;                                                                   \
+        if (next == PRIORITY_QUEUE_NO_HANDLE) next = PRIORITY_QUEUE_FREE_END;                               \
+        queue->position_of->data[handle] = PRIORITY_QUEUE_FREE_HANDLE | next;                               \
+        queue->free_handle = handle;                                                                        \
+    }                                                                                                       \
+                                                                                                            \
+    static size_t DECL_NAME##_acquire_handle(DECL_NAME##_t *queue) {                                        \
+        size_t handle = queue->free_handle;                                                                 \
+        size_t next = queue->position_of->data[handle] & ~PRIORITY_QUEUE_FREE_HANDLE;                       \
+        queue->free_handle = next == PRIORITY_QUEUE_FREE_END ? PRIORITY_QUEUE_NO_HANDLE : next;             \
+        return handle;                                                                                      \
+    }                                                                                                       \
+                                                                                                            \
+    /* Fills the hole at pos with the last element */                                                       \
+    static void DECL_NAME##_remove_at(DECL_NAME##_t *queue, size_t pos) {                                   \
+        if (queue->handle_at) DECL_NAME##_release_handle(queue, queue->handle_at->data[pos]);               \
+        size_t last = --queue->items->size;                                                                 \
+        if (queue->handle_at) queue->handle_at->size--;                                                     \
+        if (pos == last) return;                                                                            \
+        TYPE moved = queue->items->data[last];                                                              \
+        size_t moved_handle = DECL_NAME##_handle_at(queue, last);                                           \
+        size_t parent = (pos - 1) / PRIORITY_QUEUE_ARITY;                                                   \
+        if (pos > 0 && CMP(moved, queue->items->data[parent]) < 0)                                          \
+            DECL_NAME##_sift_up(queue, pos, moved, moved_handle);                                           \
+        else                                                                                                \
+            DECL_NAME##_sift_down(queue, pos, moved, moved_handle);                                         \
+    }                                                                                                       \
+                                                                                                            \
+    TYPE DECL_NAME##_pop(DECL_NAME##_t *queue) {                                                            \
+        TYPE top = DECL_NAME##_items_get(queue->items, 0);                                                  \
+        if (likely_branch(queue->items->size > 0)) DECL_NAME##_remove_at(queue, 0);                         \
+        return top;                                                                                         \
+    }                                                                                                       \
+                                                                                                            \
+    int DECL_NAME##_heapify(DECL_NAME##_t *queue, const TYPE *values, size_t count) {                       \
+        if (queue->handle_at) return 0;                                                                     \
+        DECL_NAME##_items_t *items = queue->items;                                                          \
+        while (items->capacity < items->size + count) {                                                     \
+            if (unlikely_branch(!DECL_NAME##_items_ensure_capacity(items, items->capacity + 1))) return 0;  \
+        }                                                                                                   \
+        memcpy(&items->data[items->size], values, count * sizeof(TYPE));                                    \
+        items->size += count;                                                                               \
+        /* Sift down every parent, last one first: O(size) in total */                                      \
+        if (items->size < 2) return 1;                                                                      \
+        for (size_t pos = (items->size - 2) / PRIORITY_QUEUE_ARITY + 1; pos-- > 0;)                         \
+            DECL_NAME##_sift_down(queue, pos, items->data[pos], PRIORITY_QUEUE_NO_HANDLE);                  \
+        return 1;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    int DECL_NAME##_push_bounded(DECL_NAME##_t *queue, TYPE value, size_t k) {                              \
+        if (queue->handle_at || k == 0) return 0;                                                           \
+        if (queue->items->size < k) return DECL_NAME##_push(queue, value);                                  \
+        /* Full: value replaces the top if it is greater, the old top is evicted */                         \
+        if (CMP(queue->items->data[0], value) >= 0) return 0;                                               \
+        DECL_NAME##_sift_down(queue, 0, value, PRIORITY_QUEUE_NO_HANDLE);                                   \
+        return 1;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    int DECL_NAME##_push_handle(DECL_NAME##_t *queue, TYPE value, size_t *handle) {                         \
+        if (!queue->handle_at) return 0;                                                                    \
+        /* Reserve everything first so a failed allocation changes nothing */                               \
+        size_t size = queue->items->size;                                                                   \
+        bool reuse = queue->free_handle != PRIORITY_QUEUE_NO_HANDLE;                                        \
+        if (unlikely_branch(!DECL_NAME##_items_ensure_capacity(queue->items, size + 1) ||                   \
+                            !DECL_NAME##_index_ensure_capacity(queue->handle_at, size + 1) ||               \
+                            (!reuse && !DECL_NAME##_index_ensure_capacity(queue->position_of,               \
+                                                                          queue->position_of->size + 1))))  \
+            return 0;                                                                                       \
+        size_t new_handle = reuse ? DECL_NAME##_acquire_handle(queue) : queue->position_of->size++;         \
+        queue->items->size++;                                                                               \
+        queue->handle_at->size++;                                                                           \
+        DECL_NAME##_sift_up(queue, size, value, new_handle);                                                \
+        if (handle) *handle = new_handle;                                                                   \
+        return 1;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    int DECL_NAME##_contains(const DECL_NAME##_t *queue, size_t handle) {                                   \
+        return queue->handle_at && handle < queue->position_of->size &&                                     \
+               !(queue->position_of->data[handle] & PRIORITY_QUEUE_FREE_HANDLE);                            \
+    }                                                                                                       \
+                                                                                                            \
+    TYPE DECL_NAME##_get(const DECL_NAME##_t *queue, size_t handle) {                                       \
+        size_t pos = DECL_NAME##_contains(queue, handle) ? queue->position_of->data[handle] : SIZE_MAX;     \
+        return DECL_NAME##_items_get(queue->items, pos);                                                    \
+    }                                                                                                       \
+                                                                                                            \
+    int DECL_NAME##_update(DECL_NAME##_t *queue, size_t handle, TYPE value) {                               \
+        if (!DECL_NAME##_contains(queue, handle)) return 0;                                                 \
+        size_t pos = queue->position_of->data[handle];                                                      \
+        if (CMP(value, queue->items->data[pos]) < 0)                                                        \
+            DECL_NAME##_sift_up(queue, pos, value, handle);                                                 \
+        else                                                                                                \
+            DECL_NAME##_sift_down(queue, pos, value, handle);                                               \
+        return 1;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    int DECL_NAME##_remove(DECL_NAME##_t *queue, size_t handle) {                                           \
+        if (!DECL_NAME##_contains(queue, handle)) return 0;                                                 \
+        DECL_NAME##_remove_at(queue, queue->position_of->data[handle]);                                     \
+        return 1;                                                                                           \
+    }                                                                                                       \
+                                                                                                            \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *queue) {                            \
+        pocket_memory_usage_t usage = DECL_NAME##_items_memory_usage(queue->items);                         \
+        if (queue->handle_at) {                                                                             \
+            pocket_memory_usage_t handles = DECL_NAME##_index_memory_usage(queue->handle_at);               \
+            pocket_memory_usage_t positions = DECL_NAME##_index_memory_usage(queue->position_of);           \
+            usage.overhead_bytes += handles.reserved_bytes + handles.overhead_bytes +                       \
+                                    positions.reserved_bytes + positions.overhead_bytes;                    \
+        }                                                                                                   \
+        return usage;                                                                                       \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_PRIORITY_QUEUE_H
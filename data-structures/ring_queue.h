@@ -0,0 +1,395 @@
+#ifndef _POCKET_DATA_STRUCTURES_RING_QUEUE_H
+#define _POCKET_DATA_STRUCTURES_RING_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynamic_array.h"
+
+/*
+ * Bounded ring queues over a flat, power-of-two sized slot array.
+ *
+ * MPMC_QUEUE_*: any number of producers and consumers. Every slot carries a sequence number telling whether it is
+ *               ready to be written or read for the current lap (D. Vyukov's bounded MPMC queue), so a single-item
+ *               operation costs one CAS on the shared head/tail.
+ * SPSC_QUEUE_*: exactly one producer and one consumer thread. No CAS at all, each side caches the other side's index
+ *               and only re-reads it when the queue looks full/empty.
+ *
+ * Batch operations move up to `count` items and return how many were actually moved. The MPMC batch versions claim
+ * a whole range with a single CAS and then wait for any peer still finishing a slot inside that range.
+ */
+
+#ifndef RING_QUEUE_CACHE_LINE
+#define RING_QUEUE_CACHE_LINE 64
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RING_QUEUE_CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define RING_QUEUE_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define RING_QUEUE_CPU_RELAX() ((void)0)
+#endif
+
+/* Smallest power of two >= capacity (at least 2), or 0 when that many slot_size slots cannot be allocated */
+static inline size_t ring_queue_round_capacity(size_t capacity, size_t slot_size) {
+    if (unlikely_branch(capacity > SIZE_MAX / 2 + 1)) return 0;
+    size_t rounded = 2;
+    while (rounded < capacity) rounded <<= 1;
+    return rounded <= (SIZE_MAX - RING_QUEUE_CACHE_LINE) / slot_size ? rounded : 0;
+}
+
+/* Cache line aligned allocations through the tracing hooks, name is the DECL_NAME */
+static inline void *ring_queue_aligned_alloc(const char *name, size_t bytes) {
+    (void)name;  // Only read when tracing
+    return POCKET_ALIGNED_ALLOC(name, RING_QUEUE_CACHE_LINE, bytes);
+}
+
+static inline void ring_queue_aligned_free(const char *name, void *ptr, size_t bytes) {
+    (void)name;
+    POCKET_ALIGNED_FREE(name, RING_QUEUE_CACHE_LINE, ptr, bytes);
+}
+
+/* Memory of a queue with the given slot array: padding up to whole cache lines counts as overhead */
+static inline pocket_memory_usage_t ring_queue_memory_usage(size_t used, size_t slot_bytes, size_t header_bytes) {
+    size_t overhead = pocket_aligned_size(RING_QUEUE_CACHE_LINE, header_bytes) +
+                      (pocket_aligned_size(RING_QUEUE_CACHE_LINE, slot_bytes) - slot_bytes);
+    return pocket_memory_usage_make(used < slot_bytes ? used : slot_bytes, slot_bytes, overhead);
+}
+
+/*************************************/
+/****************MPMC*****************/
+/*************************************/
+
+#define MPMC_QUEUE_DECLARE(DECL_NAME, TYPE)                                                   \
+    typedef struct DECL_NAME##_slot_t {                                                       \
+        atomic_size_t sequence;                                                               \
+        TYPE value;                                                                           \
+    } DECL_NAME##_slot_t;                                                                     \
+                                                                                              \
+    typedef struct DECL_NAME##_t {                                                            \
+        /* Producers and consumers each get their own cache line */                           \
+        _Alignas(RING_QUEUE_CACHE_LINE) atomic_size_t enqueue_pos;                            \
+        _Alignas(RING_QUEUE_CACHE_LINE) atomic_size_t dequeue_pos;                            \
+        _Alignas(RING_QUEUE_CACHE_LINE) DECL_NAME##_slot_t *slots;                            \
+        size_t mask;                                                                          \
+    } DECL_NAME##_t;                                                                          \
+                                                                                              \
+    /* Capacity is rounded up to a power of two */                                            \
+    DECL_NAME##_t *DECL_NAME##_create(size_t capacity);                                       \
+                                                                                              \
+    void DECL_NAME##_free(DECL_NAME##_t *queue);                                              \
+                                                                                              \
+    int DECL_NAME##_enqueue(DECL_NAME##_t *queue, TYPE value);                                \
+                                                                                              \
+    int DECL_NAME##_dequeue(DECL_NAME##_t *queue, TYPE *out);                                 \
+                                                                                              \
+    size_t DECL_NAME##_enqueue_batch(DECL_NAME##_t *queue, const TYPE *values, size_t count); \
+                                                                                              \
+    size_t DECL_NAME##_dequeue_batch(DECL_NAME##_t *queue, TYPE *out, size_t count);          \
+                                                                                              \
+    size_t DECL_NAME##_capacity(const DECL_NAME##_t *queue);                                  \
+                                                                                              \
+    /* Only a snapshot while other threads are running */                                     \
+    size_t DECL_NAME##_size(DECL_NAME##_t *queue);                                            \
+                                                                                              \
+    /* Only a snapshot while other threads are running */                                     \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(DECL_NAME##_t *queue);
+
+#define MPMC_QUEUE_IMPLEMENT(DECL_NAME, TYPE)                                                          \
+    DECL_NAME##_t *DECL_NAME##_create(size_t capacity) {                                               \
+        capacity = ring_queue_round_capacity(capacity, sizeof(DECL_NAME##_slot_t));                    \
+        if (unlikely_branch(!capacity)) return NULL;                                                   \
+        DECL_NAME##_t *queue = ring_queue_aligned_alloc(#DECL_NAME, sizeof(DECL_NAME##_t));            \
+        if (unlikely_branch(!queue)) return NULL;                                                      \
+        size_t slot_bytes = capacity * sizeof(DECL_NAME##_slot_t);                                     \
+        queue->slots = ring_queue_aligned_alloc(#DECL_NAME, slot_bytes);                               \
+        if (unlikely_branch(!queue->slots)) {                                                          \
+            ring_queue_aligned_free(#DECL_NAME, queue, sizeof(DECL_NAME##_t));                         \
+            return NULL;                                                                               \
+        }                                                                                              \
+        for (size_t i = 0; i < capacity; i++) {                                                        \
+            atomic_init(&queue->slots[i].sequence, i);                                                 \
+        }                                                                                              \
+        queue->mask = capacity - 1;                                                                    \
+        atomic_init(&queue->enqueue_pos, 0);                                                           \
+        atomic_init(&queue->dequeue_pos, 0);                                                           \
+        return queue;                                                                                  \
+    }                                                                                                  \
+                                                                                                       \
+    void DECL_NAME##_free(DECL_NAME##_t *queue) {                                                      \
+        if (likely_branch(queue)) {                                                                    \
+            size_t slot_bytes = (queue->mask + 1) * sizeof(DECL_NAME##_slot_t);                        \
+            ring_queue_aligned_free(#DECL_NAME, queue->slots, slot_bytes);                             \
+            ring_queue_aligned_free(#DECL_NAME, queue, sizeof(DECL_NAME##_t));                         \
+        }                                                                                              \
+    }                                                                                                  \
+                                                                                                       \
+    int DECL_NAME##_enqueue(DECL_NAME##_t *queue, TYPE value) {                                        \
+        DECL_NAME##_slot_t *slot;                                                                      \
+        size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);                  \
+        while (1) {                                                                                    \
+            slot = &queue->slots[pos & queue->mask];                                                   \
+            size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);             \
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;                                        \
+            if (diff == 0) {                                                                           \
+                if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,          \
+                                                          memory_order_relaxed, memory_order_relaxed)) \
+                    break;                                                                             \
+            } else if (diff < 0) {                                                                     \
+                return 0; /* Full */                                                                   \
+            } else {                                                                                   \
+                pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);                 \
+            }                                                                                          \
+        }                                                                                              \
+        slot->value = value;                                                                           \
+        atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);                         \
+        return 1;                                                                                      \
+    }                                                                                                  \
+                                                                                                       \
+    int DECL_NAME##_dequeue(DECL_NAME##_t *queue, TYPE *out) {                                         \
+        DECL_NAME##_slot_t *slot;                                                                      \
+        size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);                  \
+        while (1) {                                                                                    \
+            slot = &queue->slots[pos & queue->mask];                                                   \
+            size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);             \
+            intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);                                  \
+            if (diff == 0) {                                                                           \
+                if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + 1,          \
+                                                          memory_order_relaxed, memory_order_relaxed)) \
+                    break;                                                                             \
+            } else if (diff < 0) {                                                                     \
+                return 0; /* Empty */                                                                  \
+            } else {                                                                                   \
+                pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);                 \
+            }                                                                                          \
+        }                                                                                              \
+        *out = slot->value;                                                                            \
+        atomic_store_explicit(&slot->sequence, pos + queue->mask + 1, memory_order_release);           \
+        return 1;                                                                                      \
+    }                                                                                                  \
+                                                                                                       \
+    size_t DECL_NAME##_enqueue_batch(DECL_NAME##_t *queue, const TYPE *values, size_t count) {         \
+        size_t capacity = queue->mask + 1;                                                             \
+        size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);                  \
+        size_t claimed;                                                                                \
+        while (1) {                                                                                    \
+            size_t dequeued = atomic_load_explicit(&queue->dequeue_pos, memory_order_acquire);         \
+            intptr_t used = (intptr_t)(pos - dequeued);                                                \
+            if (unlikely_branch(used < 0)) { /* Stale pos */                                           \
+                pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);                 \
+                continue;                                                                              \
+            }                                                                                          \
+            size_t available = capacity - (size_t)used;                                                \
+            claimed = count < available ? count : available;                                           \
+            if (claimed == 0) return 0;                                                                \
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + claimed,        \
+                                                      memory_order_relaxed, memory_order_relaxed))     \
+                break;                                                                                 \
+        }                                                                                              \
+        for (size_t i = 0; i < claimed; i++) {                                                         \
+            DECL_NAME##_slot_t *slot = &queue->slots[(pos + i) & queue->mask];                         \
+            /* A consumer may still be copying out of this slot */                                     \
+            while (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + i) {           \
+                RING_QUEUE_CPU_RELAX();                                                                \
+            }                                                                                          \
+            slot->value = values[i];                                                                   \
+            atomic_store_explicit(&slot->sequence, pos + i + 1, memory_order_release);                 \
+        }                                                                                              \
+        return claimed;                                                                                \
+    }                                                                                                  \
+                                                                                                       \
+    size_t DECL_NAME##_dequeue_batch(DECL_NAME##_t *queue, TYPE *out, size_t count) {                  \
+        size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);                  \
+        size_t claimed;                                                                                \
+        while (1) {                                                                                    \
+            size_t enqueued = atomic_load_explicit(&queue->enqueue_pos, memory_order_acquire);         \
+            intptr_t available = (intptr_t)(enqueued - pos);                                           \
+            if (unlikely_branch(available < 0)) { /* Stale pos */                                      \
+                pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);                 \
+                continue;                                                                              \
+            }                                                                                          \
+            claimed = count < (size_t)available ? count : (size_t)available;                           \
+            if (claimed == 0) return 0;                                                                \
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + claimed,        \
+                                                      memory_order_relaxed, memory_order_relaxed))     \
+                break;                                                                                 \
+        }                                                                                              \
+        for (size_t i = 0; i < claimed; i++) {                                                         \
+            DECL_NAME##_slot_t *slot = &queue->slots[(pos + i) & queue->mask];                         \
+            /* A producer may still be writing into this slot */                                       \
+            while (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + i + 1) {       \
+                RING_QUEUE_CPU_RELAX();                                                                \
+            }                                                                                          \
+            out[i] = slot->value;                                                                      \
+            atomic_store_explicit(&slot->sequence, pos + i + queue->mask + 1, memory_order_release);   \
+        }                                                                                              \
+        return claimed;                                                                                \
+    }                                                                                                  \
+                                                                                                       \
+    size_t DECL_NAME##_capacity(const DECL_NAME##_t *queue) { return queue->mask + 1; }                \
+                                                                                                       \
+    size_t DECL_NAME##_size(DECL_NAME##_t *queue) {                                                    \
+        size_t dequeued = atomic_load_explicit(&queue->dequeue_pos, memory_order_acquire);             \
+        size_t enqueued = atomic_load_explicit(&queue->enqueue_pos, memory_order_acquire);             \
+        return enqueued > dequeued ? enqueued - dequeued : 0;                                          \
+    }                                                                                                  \
+                                                                                                       \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(DECL_NAME##_t *queue) {                             \
+        size_t slot_bytes = (queue->mask + 1) * sizeof(DECL_NAME##_slot_t);                            \
+        size_t used = DECL_NAME##_size(queue) * sizeof(DECL_NAME##_slot_t);                            \
+        return ring_queue_memory_usage(used, slot_bytes, sizeof(DECL_NAME##_t));                       \
+    }
+
+/*************************************/
+/****************SPSC*****************/
+/*************************************/
+
+#define SPSC_QUEUE_DECLARE(DECL_NAME, TYPE)                                                   \
+    typedef struct DECL_NAME##_t {                                                            \
+        /* Written by the producer only */                                                    \
+        _Alignas(RING_QUEUE_CACHE_LINE) atomic_size_t tail;                                   \
+        size_t cached_head;                                                                   \
+        /* Written by the consumer only */                                                    \
+        _Alignas(RING_QUEUE_CACHE_LINE) atomic_size_t head;                                   \
+        size_t cached_tail;                                                                   \
+        _Alignas(RING_QUEUE_CACHE_LINE) TYPE *data;                                           \
+        size_t mask;                                                                          \
+    } DECL_NAME##_t;                                                                          \
+                                                                                              \
+    /* Capacity is rounded up to a power of two */                                            \
+    DECL_NAME##_t *DECL_NAME##_create(size_t capacity);                                       \
+                                                                                              \
+    void DECL_NAME##_free(DECL_NAME##_t *queue);                                              \
+                                                                                              \
+    int DECL_NAME##_enqueue(DECL_NAME##_t *queue, TYPE value);                                \
+                                                                                              \
+    int DECL_NAME##_dequeue(DECL_NAME##_t *queue, TYPE *out);                                 \
+                                                                                              \
+    size_t DECL_NAME##_enqueue_batch(DECL_NAME##_t *queue, const TYPE *values, size_t count); \
+                                                                                              \
+    size_t DECL_NAME##_dequeue_batch(DECL_NAME##_t *queue, TYPE *out, size_t count);          \
+                                                                                              \
+    size_t DECL_NAME##_capacity(const DECL_NAME##_t *queue);                                  \
+                                                                                              \
+    /* Only a snapshot while the other side is running */                                     \
+    size_t DECL_NAME##_size(DECL_NAME##_t *queue);                                            \
+                                                                                              \
+    /* Only a snapshot while the other side is running */                                     \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(DECL_NAME##_t *queue);
+
+#define SPSC_QUEUE_IMPLEMENT(DECL_NAME, TYPE)                                                     \
+    DECL_NAME##_t *DECL_NAME##_create(size_t capacity) {                                          \
+        capacity = ring_queue_round_capacity(capacity, sizeof(TYPE));                             \
+        if (unlikely_branch(!capacity)) return NULL;                                              \
+        DECL_NAME##_t *queue = ring_queue_aligned_alloc(#DECL_NAME, sizeof(DECL_NAME##_t));       \
+        if (unlikely_branch(!queue)) return NULL;                                                 \
+        queue->data = ring_queue_aligned_alloc(#DECL_NAME, capacity * sizeof(TYPE));              \
+        if (unlikely_branch(!queue->data)) {                                                      \
+            ring_queue_aligned_free(#DECL_NAME, queue, sizeof(DECL_NAME##_t));                    \
+            return NULL;                                                                          \
+        }                                                                                         \
+        queue->mask = capacity - 1;                                                               \
+        atomic_init(&queue->tail, 0);                                                             \
+        atomic_init(&queue->head, 0);                                                             \
+        queue->cached_head = 0;                                                                   \
+        queue->cached_tail = 0;                                                                   \
+        return queue;                                                                             \
+    }                                                                                             \
+                                                                                                  \
+    void DECL_NAME##_free(DECL_NAME##_t *queue) {                                                 \
+        if (likely_branch(queue)) {                                                               \
+            ring_queue_aligned_free(#DECL_NAME, queue->data, (queue->mask + 1) * sizeof(TYPE));   \
+            ring_queue_aligned_free(#DECL_NAME, queue, sizeof(DECL_NAME##_t));                    \
+        }                                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    /* Free slots as seen by the producer, refreshing its view of head only when needed */        \
+    static inline size_t DECL_NAME##_writable(DECL_NAME##_t *queue, size_t tail, size_t wanted) { \
+        size_t capacity = queue->mask + 1;                                                        \
+        size_t available = capacity - (tail - queue->cached_head);                                \
+        if (available < wanted) {                                                                 \
+            queue->cached_head = atomic_load_explicit(&queue->head, memory_order_acquire);        \
+            available = capacity - (tail - queue->cached_head);                                   \
+        }                                                                                         \
+        return available;                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    /* Filled slots as seen by the consumer, refreshing its view of tail only when needed */      \
+    static inline size_t DECL_NAME##_readable(DECL_NAME##_t *queue, size_t head, size_t wanted) { \
+        size_t available = queue->cached_tail - head;                                             \
+        if (available < wanted) {                                                                 \
+            queue->cached_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);        \
+            available = queue->cached_tail - head;                                                \
+        }                                                                                         \
+        return available;                                                                         \
+    }                                                                                             \
+                                                                                                  \
+    int DECL_NAME##_enqueue(DECL_NAME##_t *queue, TYPE value) {                                   \
+        size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);                   \
+        if (unlikely_branch(DECL_NAME##_writable(queue, tail, 1) == 0)) return 0;                 \
+        queue->data[tail & queue->mask] = value;                                                  \
+        atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);                      \
+        return 1;                                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    int DECL_NAME##_dequeue(DECL_NAME##_t *queue, TYPE *out) {                                    \
+        size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);                   \
+        if (unlikely_branch(DECL_NAME##_readable(queue, head, 1) == 0)) return 0;                 \
+        *out = queue->data[head & queue->mask];                                                   \
+        atomic_store_explicit(&queue->head, head + 1, memory_order_release);                      \
+        return 1;                                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    size_t DECL_NAME##_enqueue_batch(DECL_NAME##_t *queue, const TYPE *values, size_t count) {    \
+        size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);                   \
+        size_t available = DECL_NAME##_writable(queue, tail, count);                              \
+        size_t n = count < available ? count : available;                                         \
+        size_t start = tail & queue->mask;                                                        \
+        size_t first = queue->mask + 1 - start;                                                   \
+        if (first > n) first = n;                                                                 \
+        /* At most two contiguous runs: up to the end of the ring, then from its start */         \
+        memcpy(&queue->data[start], values, first * sizeof(TYPE));                                \
+        memcpy(queue->data, values + first, (n - first) * sizeof(TYPE));                          \
+        atomic_store_explicit(&queue->tail, tail + n, memory_order_release);                      \
+        return n;                                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    size_t DECL_NAME##_dequeue_batch(DECL_NAME##_t *queue, TYPE *out, size_t count) {             \
+        size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);                   \
+        size_t available = DECL_NAME##_readable(queue, head, count);                              \
+        size_t n = count < available ? count : available;                                         \
+        size_t start = head & queue->mask;                                                        \
+        size_t first = queue->mask + 1 - start;                                                   \
+        if (first > n) first = n;                                                                 \
+        memcpy(out, &queue->data[start], first * sizeof(TYPE));                                   \
+        memcpy(out + first, queue->data, (n - first) * sizeof(TYPE));                             \
+        atomic_store_explicit(&queue->head, head + n, memory_order_release);                      \
+        return n;                                                                                 \
+    }                                                                                             \
+                                                                                                  \
+    size_t DECL_NAME##_capacity(const DECL_NAME##_t *queue) { return queue->mask + 1; }           \
+                                                                                                  \
+    size_t DECL_NAME##_size(DECL_NAME##_t *queue) {                                               \
+        size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);                   \
+        size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);                   \
+        return tail - head;                                                                       \
+    }                                                                                             \
+                                                                                                  \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(DECL_NAME##_t *queue) {                        \
+        size_t used = DECL_NAME##_size(queue) * sizeof(TYPE);                                     \
+        size_t slot_bytes = (queue->mask + 1) * sizeof(TYPE);                                 \
+        return ring_queue_memory_usage(used, slot_bytes, sizeof(DECL_NAME##_t));              \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_RING_QUEUE_H
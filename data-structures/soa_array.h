@@ -0,0 +1,235 @@
+#ifndef _POCKET_DATA_STRUCTURES_SOA_ARRAY_H
+#define _POCKET_DATA_STRUCTURES_SOA_ARRAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynamic_array.h"
+
+/*
+ * Structure-of-arrays generator.
+ *
+ *   SOA_ARRAY_DECLARE(particles, (float, x), (float, y), (int, id))
+ *   SOA_ARRAY_IMPLEMENT(particles, (float, x), (float, y), (int, id))
+ *
+ * generates a particles_row_t record type plus a particles_t container that keeps one contiguous column per field.
+ * All columns grow together, rows are pushed/read/written as particles_row_t and each column can be scanned directly
+ * through particles_column_<field>(). Up to 16 fields are supported.
+ */
+
+#ifndef SOA_ARRAY_ALIGNMENT
+#define SOA_ARRAY_ALIGNMENT 64
+#endif
+
+/* Columns go through the aligned allocation hooks, name is the DECL_NAME. NULL when count * size does not fit. */
+static inline void *soa_array_column_alloc(const char *name, size_t count, size_t size) {
+    (void)name;  // Only read when tracing
+    if (unlikely_branch(size && count > SIZE_MAX / size)) return NULL;
+    return POCKET_ALIGNED_ALLOC(name, SOA_ARRAY_ALIGNMENT, count * size);
+}
+
+static inline void soa_array_column_free(const char *name, void *column, size_t count, size_t size) {
+    (void)name;
+    POCKET_ALIGNED_FREE(name, SOA_ARRAY_ALIGNMENT, column, count * size);
+}
+
+/*************************************/
+/*********Field list machinery********/
+/*************************************/
+
+#define SOA_ARRAY_CAT(a, b) SOA_ARRAY_CAT_(a, b)
+#define SOA_ARRAY_CAT_(a, b) a##b
+
+#define SOA_ARRAY_NARGS(...) SOA_ARRAY_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define SOA_ARRAY_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+
+/* (type, field) -> M(CTX, type, field) */
+#define SOA_ARRAY_UNPACK(TYPE, FIELD) TYPE, FIELD
+#define SOA_ARRAY_APPLY(M, CTX, PAIR) SOA_ARRAY_APPLY_(M, CTX, SOA_ARRAY_UNPACK PAIR)
+#define SOA_ARRAY_APPLY_(M, CTX, ...) M(CTX, __VA_ARGS__)
+
+#define SOA_ARRAY_FOR_EACH(M, CTX, ...) \
+    SOA_ARRAY_CAT(SOA_ARRAY_FOR_EACH_, SOA_ARRAY_NARGS(__VA_ARGS__))(M, CTX, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_1(M, C, P) SOA_ARRAY_APPLY(M, C, P)
+#define SOA_ARRAY_FOR_EACH_2(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_1(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_3(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_2(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_4(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_3(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_5(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_4(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_6(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_5(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_7(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_6(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_8(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_7(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_9(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_8(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_10(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_9(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_11(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_10(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_12(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_11(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_13(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_12(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_14(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_13(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_15(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_14(M, C, __VA_ARGS__)
+#define SOA_ARRAY_FOR_EACH_16(M, C, P, ...) SOA_ARRAY_APPLY(M, C, P) SOA_ARRAY_FOR_EACH_15(M, C, __VA_ARGS__)
+
+/* Per-field snippets. The ones used inside function bodies expect `soa`, `capacity` and `name` to be in scope. */
+#define SOA_ARRAY_ROW_MEMBER_(CTX, TYPE, FIELD) TYPE FIELD;
+#define SOA_ARRAY_COLUMN_MEMBER_(CTX, TYPE, FIELD) TYPE *FIELD;
+#define SOA_ARRAY_COLUMN_DECL_(DECL_NAME, TYPE, FIELD) TYPE *DECL_NAME##_column_##FIELD(const DECL_NAME##_t *soa);
+#define SOA_ARRAY_COLUMN_IMPL_(DECL_NAME, TYPE, FIELD) \
+    TYPE *DECL_NAME##_column_##FIELD(const DECL_NAME##_t *soa) { return soa->FIELD; }
+#define SOA_ARRAY_ALLOC_COLUMN_(DEST, TYPE, FIELD) \
+    ok = ok && ((DEST)->FIELD = soa_array_column_alloc(name, capacity, sizeof(TYPE))) != NULL;
+#define SOA_ARRAY_FREE_COLUMN_(DEST, TYPE, FIELD) soa_array_column_free(name, (DEST)->FIELD, capacity, sizeof(TYPE));
+#define SOA_ARRAY_MOVE_COLUMN_(DEST, TYPE, FIELD)                         \
+    memcpy((DEST)->FIELD, soa->FIELD, soa->size * sizeof(TYPE));          \
+    soa_array_column_free(name, soa->FIELD, soa->capacity, sizeof(TYPE)); \
+    soa->FIELD = (DEST)->FIELD;
+#define SOA_ARRAY_ROW_SIZE_(CTX, TYPE, FIELD) +sizeof(TYPE)
+#define SOA_ARRAY_PADDING_(CTX, TYPE, FIELD) \
+    +(pocket_aligned_size(SOA_ARRAY_ALIGNMENT, soa->capacity * sizeof(TYPE)) - soa->capacity * sizeof(TYPE))
+#define SOA_ARRAY_STORE_FIELD_(ROW, TYPE, FIELD) soa->FIELD[index] = (ROW).FIELD;
+#define SOA_ARRAY_LOAD_FIELD_(ROW, TYPE, FIELD) (ROW).FIELD = soa->FIELD[index];
+#define SOA_ARRAY_REMOVE_FIELD_(CTX, TYPE, FIELD) \
+    memmove(&soa->FIELD[index], &soa->FIELD[index + 1], (soa->size - index - 1) * sizeof(TYPE));
+
+/*************************************/
+/*************Generator***************/
+/*************************************/
+
+#define SOA_ARRAY_DECLARE(DECL_NAME, ...)                                                \
+    typedef struct DECL_NAME##_row_t {                                                   \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_ROW_MEMBER_, DECL_NAME, __VA_ARGS__)                \
+    } DECL_NAME##_row_t;                                                                 \
+                                                                                         \
+    typedef struct DECL_NAME##_t {                                                       \
+        size_t size;                                                                     \
+        size_t capacity;                                                                 \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_COLUMN_MEMBER_, DECL_NAME, __VA_ARGS__)             \
+    } DECL_NAME##_t;                                                                     \
+                                                                                         \
+    DECL_NAME##_t *DECL_NAME##_create(size_t starting_capacity);                         \
+                                                                                         \
+    int DECL_NAME##_reserve(DECL_NAME##_t *soa, size_t min_capacity);                    \
+                                                                                         \
+    int DECL_NAME##_push_back(DECL_NAME##_t *soa, DECL_NAME##_row_t row);                \
+                                                                                         \
+    DECL_NAME##_row_t DECL_NAME##_get(const DECL_NAME##_t *soa, size_t index);           \
+                                                                                         \
+    int DECL_NAME##_set(DECL_NAME##_t *soa, size_t index, DECL_NAME##_row_t row);        \
+                                                                                         \
+    int DECL_NAME##_remove(DECL_NAME##_t *soa, size_t index);                            \
+                                                                                         \
+    size_t DECL_NAME##_size(const DECL_NAME##_t *soa);                                   \
+                                                                                         \
+    size_t DECL_NAME##_capacity(const DECL_NAME##_t *soa);                               \
+                                                                                         \
+    void DECL_NAME##_free(DECL_NAME##_t *soa);                                           \
+                                                                                         \
+    void DECL_NAME##_clear(DECL_NAME##_t *soa);                                          \
+                                                                                         \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *soa);            \
+                                                                                         \
+    /* Raw, SOA_ARRAY_ALIGNMENT aligned column pointers (valid until the next growth) */ \
+    SOA_ARRAY_FOR_EACH(SOA_ARRAY_COLUMN_DECL_, DECL_NAME, __VA_ARGS__)
+
+#define SOA_ARRAY_IMPLEMENT(DECL_NAME, ...)                                         \
+    DECL_NAME##_t *DECL_NAME##_create(size_t starting_capacity) {                   \
+        const char *name = #DECL_NAME;                                              \
+        DECL_NAME##_t *soa = POCKET_CALLOC(name, 1, sizeof(DECL_NAME##_t));         \
+        if (unlikely_branch(!soa)) return NULL;                                     \
+        size_t capacity = starting_capacity;                                        \
+        int ok = 1;                                                                 \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_ALLOC_COLUMN_, soa, __VA_ARGS__)               \
+        if (unlikely_branch(!ok)) {                                                 \
+            SOA_ARRAY_FOR_EACH(SOA_ARRAY_FREE_COLUMN_, soa, __VA_ARGS__)            \
+            POCKET_FREE(name, soa, sizeof(DECL_NAME##_t));                          \
+            return NULL;                                                            \
+        }                                                                           \
+        soa->capacity = capacity;                                                   \
+        return soa;                                                                 \
+    }                                                                               \
+                                                                                    \
+    int DECL_NAME##_reserve(DECL_NAME##_t *soa, size_t min_capacity) {              \
+        if (likely_branch(min_capacity <= soa->capacity)) return 1;                 \
+        const char *name = #DECL_NAME;                                              \
+        size_t capacity = soa->capacity ? soa->capacity : 1;                        \
+        while (capacity < min_capacity) {                                           \
+            /* Past the last growth step, ask for exactly what is needed */         \
+            if (capacity > SIZE_MAX / DYNAMIC_ARRAY_GROWTH_FACTOR) {                \
+                capacity = min_capacity;                                            \
+                break;                                                              \
+            }                                                                       \
+            capacity *= DYNAMIC_ARRAY_GROWTH_FACTOR;                                \
+        }                                                                           \
+        /* Allocate every column first so a failure leaves the array untouched */   \
+        DECL_NAME##_t grown = {0};                                                  \
+        int ok = 1;                                                                 \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_ALLOC_COLUMN_, &grown, __VA_ARGS__)            \
+        if (unlikely_branch(!ok)) {                                                 \
+            SOA_ARRAY_FOR_EACH(SOA_ARRAY_FREE_COLUMN_, &grown, __VA_ARGS__)         \
+            return 0;                                                               \
+        }                                                                           \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_MOVE_COLUMN_, &grown, __VA_ARGS__)             \
+        soa->capacity = capacity;                                                   \
+        return 1;                                                                   \
+    }                                                                               \
+                                                                                    \
+    int DECL_NAME##_push_back(DECL_NAME##_t *soa, DECL_NAME##_row_t row) {          \
+        if (unlikely_branch(!DECL_NAME##_reserve(soa, soa->size + 1))) return 0;    \
+        size_t index = soa->size++;                                                 \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_STORE_FIELD_, row, __VA_ARGS__)                \
+        return 1;                                                                   \
+    }                                                                               \
+                                                                                    \
+    DECL_NAME##_row_t DECL_NAME##_get(const DECL_NAME##_t *soa, size_t index) {     \
+        DECL_NAME##_row_t row;                                                      \
+        memset(&row, 0, sizeof(row));                                               \
+        if (unlikely_branch(index >= soa->size)) return row;                        \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_LOAD_FIELD_, row, __VA_ARGS__)                 \
+        return row;                                                                 \
+    }                                                                               \
+                                                                                    \
+    int DECL_NAME##_set(DECL_NAME##_t *soa, size_t index, DECL_NAME##_row_t row) {  \
+        if (unlikely_branch(index >= soa->size)) return 0;                          \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_STORE_FIELD_, row, __VA_ARGS__)                \
+        return 1;                                                                   \
+    }                                                                               \
+                                                                                    \
+    int DECL_NAME##_remove(DECL_NAME##_t *soa, size_t index) {                      \
+        if (unlikely_branch(index >= soa->size)) return 0;                          \
+        SOA_ARRAY_FOR_EACH(SOA_ARRAY_REMOVE_FIELD_, DECL_NAME, __VA_ARGS__)         \
+        soa->size--;                                                                \
+        return 1;                                                                   \
+    }                                                                               \
+                                                                                    \
+    size_t DECL_NAME##_size(const DECL_NAME##_t *soa) { return soa->size; }         \
+                                                                                    \
+    size_t DECL_NAME##_capacity(const DECL_NAME##_t *soa) { return soa->capacity; } \
+                                                                                    \
+    void DECL_NAME##_free(DECL_NAME##_t *soa) {                                     \
+        if (likely_branch(soa)) {                                                   \
+            const char *name = #DECL_NAME;                                          \
+            size_t capacity = soa->capacity;                                        \
+            SOA_ARRAY_FOR_EACH(SOA_ARRAY_FREE_COLUMN_, soa, __VA_ARGS__)            \
+            POCKET_FREE(name, soa, sizeof(DECL_NAME##_t));                          \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    void DECL_NAME##_clear(DECL_NAME##_t *soa) { soa->size = 0; }                   \
+                                                                                    \
+    pocket_memory_usage_t DECL_NAME##_memory_usage(const DECL_NAME##_t *soa) {      \
+        size_t row = 0 SOA_ARRAY_FOR_EACH(SOA_ARRAY_ROW_SIZE_, soa, __VA_ARGS__);   \
+        /* Rounding every column up to SOA_ARRAY_ALIGNMENT counts as overhead */    \
+        size_t pad = 0 SOA_ARRAY_FOR_EACH(SOA_ARRAY_PADDING_, soa, __VA_ARGS__);    \
+        size_t overhead = sizeof(DECL_NAME##_t) + pad;                              \
+        size_t used = soa->size * row, reserved = soa->capacity * row;              \
+        return pocket_memory_usage_make(used, reserved, overhead);                  \
+    }                                                                               \
+                                                                                    \
+    SOA_ARRAY_FOR_EACH(SOA_ARRAY_COLUMN_IMPL_, DECL_NAME, __VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_SOA_ARRAY_H
@@ -0,0 +1,287 @@
+#ifndef _POCKET_DATA_STRUCTURES_STRING_BUILDER_H
+#define _POCKET_DATA_STRUCTURES_STRING_BUILDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "pocket_string.h"
+
+/*
+ * string_builder_t accumulates output in a linked list of chunks. Appending fills the last chunk and starts a new,
+ * larger one when it is full, so bytes already written are never copied again. The result is either written out
+ * chunk by chunk with writev (string_builder_write_fd) or copied once into a string_t (string_builder_finish).
+ *
+ * string_builder_insert also allows inserting in the middle: only the chunk containing the position is split, so
+ * the cost is bounded by the chunk size instead of the total size (a simple rope).
+ */
+
+#ifndef STRING_BUILDER_DEFAULT_CHUNK
+#define STRING_BUILDER_DEFAULT_CHUNK 4096
+#endif
+
+#ifndef STRING_BUILDER_MAX_CHUNK
+#define STRING_BUILDER_MAX_CHUNK (1024 * 1024)
+#endif
+
+typedef struct string_builder_chunk_t {
+    struct string_builder_chunk_t *next;
+    size_t size;
+    size_t capacity;
+    char data[];
+} string_builder_chunk_t;
+
+typedef struct string_builder_t {
+    string_builder_chunk_t *head;
+    string_builder_chunk_t *tail;
+    size_t size;        // Total bytes over all chunks
+    size_t chunk_size;  // Capacity of the next chunk
+} string_builder_t;
+
+/*************************************/
+/*******Constructors & Destructor*****/
+/*************************************/
+
+static inline string_builder_t string_builder_create(size_t initial_chunk_size) {
+    string_builder_t builder;
+    memset(&builder, 0, sizeof(builder));
+    builder.chunk_size = initial_chunk_size ? initial_chunk_size : STRING_BUILDER_DEFAULT_CHUNK;
+    return builder;
+}
+
+static inline void string_builder_free(string_builder_t *builder) {
+    string_builder_chunk_t *chunk = builder->head;
+    while (chunk) {
+        string_builder_chunk_t *next = chunk->next;
+        POCKET_FREE("string_builder_t", chunk, sizeof(string_builder_chunk_t) + chunk->capacity);
+        chunk = next;
+    }
+    builder->head = builder->tail = NULL;
+    builder->size = 0;
+}
+
+static inline size_t string_builder_size(const string_builder_t *builder) { return builder->size; }
+
+/*************************************/
+/**************Chunks*****************/
+/*************************************/
+
+static inline string_builder_chunk_t *string_builder_alloc_chunk(size_t capacity) {
+    string_builder_chunk_t *chunk =
+        (string_builder_chunk_t *)POCKET_MALLOC("string_builder_t", sizeof(string_builder_chunk_t) + capacity);
+    if (unlikely_branch(!chunk)) return NULL;
+    chunk->next = NULL;
+    chunk->size = 0;
+    chunk->capacity = capacity;
+    return chunk;
+}
+
+// Allocates a chunk for at least min_capacity bytes, growing the chunk size geometrically
+static inline string_builder_chunk_t *string_builder_new_chunk(string_builder_t *builder, size_t min_capacity) {
+    size_t capacity = builder->chunk_size > min_capacity ? builder->chunk_size : min_capacity;
+    string_builder_chunk_t *chunk = string_builder_alloc_chunk(capacity);
+    if (likely_branch(chunk) && builder->chunk_size < STRING_BUILDER_MAX_CHUNK)
+        builder->chunk_size *= DYNAMIC_ARRAY_GROWTH_FACTOR;
+    return chunk;
+}
+
+static inline string_builder_chunk_t *string_builder_push_chunk(string_builder_t *builder, size_t min_capacity) {
+    string_builder_chunk_t *chunk = string_builder_new_chunk(builder, min_capacity);
+    if (unlikely_branch(!chunk)) return NULL;
+    if (builder->tail)
+        builder->tail->next = chunk;
+    else
+        builder->head = chunk;
+    builder->tail = chunk;
+    return chunk;
+}
+
+/*************************************/
+/**************Modifiers**************/
+/*************************************/
+
+static inline int string_builder_append_n(string_builder_t *builder, const char *src, size_t len) {
+    string_builder_chunk_t *tail = builder->tail;
+    if (tail) {
+        size_t fits = tail->capacity - tail->size;
+        if (fits > len) fits = len;
+        memcpy(tail->data + tail->size, src, fits);
+        tail->size += fits;
+        builder->size += fits;
+        src += fits;
+        len -= fits;
+    }
+    if (len == 0) return 1;
+    tail = string_builder_push_chunk(builder, len);
+    if (unlikely_branch(!tail)) return 0;
+    memcpy(tail->data, src, len);
+    tail->size = len;
+    builder->size += len;
+    return 1;
+}
+
+static inline int string_builder_append_cstr(string_builder_t *builder, const char *src) {
+    return string_builder_append_n(builder, src, strlen(src));
+}
+
+static inline int string_builder_append_view(string_builder_t *builder, string_view_t view) {
+    return string_builder_append_n(builder, view.data, view.size);
+}
+
+static inline int string_builder_append_string(string_builder_t *builder, const string_t *str) {
+    return string_builder_append_n(builder, string_get_cstr(str), string_size(str));
+}
+
+// printf-style append into the last chunk; starts a new chunk if the output does not fit
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+static inline int string_builder_appendf(string_builder_t *builder, const char *fmt, ...) {
+    string_builder_chunk_t *tail = builder->tail;
+    size_t spare = tail ? tail->capacity - tail->size : 0;
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(tail ? tail->data + tail->size : NULL, spare, fmt, args);
+    va_end(args);
+    if (unlikely_branch(written < 0)) return 0;
+    if ((size_t)written < spare) {
+        tail->size += (size_t)written;
+        builder->size += (size_t)written;
+        return 1;
+    }
+    tail = string_builder_push_chunk(builder, (size_t)written + 1);
+    if (unlikely_branch(!tail)) return 0;
+    va_start(args, fmt);
+    vsnprintf(tail->data, (size_t)written + 1, fmt, args);
+    va_end(args);
+    tail->size = (size_t)written;
+    builder->size += (size_t)written;
+    return 1;
+}
+
+// Inserts len bytes at byte offset pos (clamped to the size). Only the chunk containing pos is touched.
+static inline int string_builder_insert(string_builder_t *builder, size_t pos, const char *src, size_t len) {
+    if (pos >= builder->size) return string_builder_append_n(builder, src, len);
+    if (len == 0) return 1;
+
+    string_builder_chunk_t *prev = NULL, *chunk = builder->head;
+    while (pos > chunk->size || (pos == chunk->size && chunk->next)) {
+        pos -= chunk->size;
+        prev = chunk;
+        chunk = chunk->next;
+    }
+    // Room left in this chunk: shift its own tail only
+    if (chunk->capacity - chunk->size >= len) {
+        memmove(chunk->data + pos + len, chunk->data + pos, chunk->size - pos);
+        memcpy(chunk->data + pos, src, len);
+        chunk->size += len;
+        builder->size += len;
+        return 1;
+    }
+
+    // Chunks created by an insert are sized exactly, they are not the append target
+    string_builder_chunk_t *inserted = string_builder_alloc_chunk(len);
+    if (unlikely_branch(!inserted)) return 0;
+    memcpy(inserted->data, src, len);
+    inserted->size = len;
+
+    if (pos == 0) {
+        // Goes in front of chunk, nothing to split
+        inserted->next = chunk;
+        if (prev)
+            prev->next = inserted;
+        else
+            builder->head = inserted;
+    } else {
+        // Split chunk at pos: chunk -> inserted -> rest
+        string_builder_chunk_t *rest = string_builder_alloc_chunk(chunk->size - pos);
+        if (unlikely_branch(!rest)) {
+            POCKET_FREE("string_builder_t", inserted, sizeof(string_builder_chunk_t) + len);
+            return 0;
+        }
+        memcpy(rest->data, chunk->data + pos, chunk->size - pos);
+        rest->size = chunk->size - pos;
+        rest->next = chunk->next;
+        inserted->next = rest;
+        chunk->next = inserted;
+        chunk->size = pos;
+        if (builder->tail == chunk) builder->tail = rest;
+    }
+    builder->size += len;
+    return 1;
+}
+
+/*************************************/
+/**************Output*****************/
+/*************************************/
+
+// Copies everything into a single string_t with one allocation, then releases the chunks
+static inline string_t string_builder_finish(string_builder_t *builder) {
+    string_t str = string_create_empty();
+    if (likely_branch(string_reserve(&str, builder->size))) {
+        char *dst = string_data(&str);
+        for (string_builder_chunk_t *chunk = builder->head; chunk; chunk = chunk->next) {
+            memcpy(dst, chunk->data, chunk->size);
+            dst += chunk->size;
+        }
+        string_set_size(&str, builder->size);
+    }
+    string_builder_free(builder);
+    return str;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+// Writes all chunks to fd with writev, retrying short writes. The builder is left untouched.
+static inline int string_builder_write_fd(const string_builder_t *builder, int fd) {
+    struct iovec iov[IOV_MAX < 64 ? IOV_MAX : 64];
+    const int max_iov = (int)(sizeof(iov) / sizeof(iov[0]));
+    const string_builder_chunk_t *chunk = builder->head;
+    size_t offset = 0;  // Bytes of chunk already written
+    while (chunk) {
+        int count = 0;
+        for (const string_builder_chunk_t *c = chunk; c && count < max_iov; c = c->next) {
+            size_t skip = c == chunk ? offset : 0;
+            if (c->size == skip) continue;
+            iov[count].iov_base = (void *)(c->data + skip);
+            iov[count].iov_len = c->size - skip;
+            count++;
+        }
+        if (count == 0) return 1;
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        // Advance past what was written
+        size_t left = (size_t)written;
+        while (chunk && left >= chunk->size - offset) {
+            left -= chunk->size - offset;
+            offset = 0;
+            chunk = chunk->next;
+        }
+        offset += left;
+    }
+    return 1;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_STRING_BUILDER_H
@@ -0,0 +1,270 @@
+#ifndef _POCKET_DATA_STRUCTURES_STRING_INTERN_H
+#define _POCKET_DATA_STRUCTURES_STRING_INTERN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_map.h"
+#include "pocket_string.h"
+
+/*
+ * String interning: every distinct string is stored once and identified by a 32 bit id. Two interned strings are
+ * equal exactly when their ids (or their canonical pointers) are equal, and their hash is cached, so comparing and
+ * hashing them is O(1).
+ *
+ *   STRING_INTERN_DECLARE(symbols)
+ *   STRING_INTERN_IMPLEMENT(symbols)
+ *
+ *   symbols_t pool;
+ *   if (!symbols_init(&pool, false)) return;     // Out of memory
+ *   uint32_t id = symbols_intern(&pool, "timeout");
+ *   const char *name = symbols_cstr(&pool, id);  // Canonical pointer, stable until symbols_free
+ *
+ * Characters live in an arena of large chunks that never move. The id -> string table is split into blocks of
+ * doubling size that are never reallocated either, so lookups by id need no lock even on a shared pool.
+ *
+ * The pool is initialized in place because it may hold a rwlock, which must not be copied once initialized.
+ * A pool initialized with thread_safe = true guards interning with a rwlock: lookups of already interned strings take
+ * the read lock only, new strings take the write lock.
+ */
+
+#ifndef STRING_INTERN_ARENA_CHUNK
+#define STRING_INTERN_ARENA_CHUNK (64 * 1024)
+#endif
+
+#define STRING_INTERN_INVALID_ID UINT32_MAX
+
+/* Ids 0..63 go to block 0, then every block doubles: block b holds 64 << b entries */
+#define STRING_INTERN_FIRST_BLOCK_BITS 6
+#define STRING_INTERN_MAX_BLOCKS (32 - STRING_INTERN_FIRST_BLOCK_BITS)
+
+typedef struct string_intern_key_t {
+    const char *ptr;
+    size_t len;
+    uint64_t hash;
+} string_intern_key_t;
+
+typedef struct string_intern_chunk_t {
+    struct string_intern_chunk_t *next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} string_intern_chunk_t;
+
+static inline uint64_t string_intern_key_hash(string_intern_key_t key) { return key.hash; }
+
+static inline bool string_intern_keys_equal(string_intern_key_t a, string_intern_key_t b) {
+    return a.hash == b.hash && a.len == b.len && memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+static inline string_intern_key_t string_intern_make_key(const char *str, size_t len) {
+    string_intern_key_t key = {str, len, fnv_1a_hash_bytes(str, len)};
+    return key;
+}
+
+/* Copies str (plus a '\0') into the arena. Oversized strings get a chunk of their own. */
+static inline const char *string_intern_arena_copy(string_intern_chunk_t **arena, const char *str, size_t len) {
+    string_intern_chunk_t *chunk = *arena;
+    if (!chunk || chunk->capacity - chunk->used < len + 1) {
+        size_t capacity = len + 1 > STRING_INTERN_ARENA_CHUNK ? len + 1 : STRING_INTERN_ARENA_CHUNK;
+        chunk = (string_intern_chunk_t *)POCKET_MALLOC("string_intern_arena", sizeof(string_intern_chunk_t) + capacity);
+        if (unlikely_branch(!chunk)) return NULL;
+        chunk->used = 0;
+        chunk->capacity = capacity;
+        chunk->next = *arena;
+        *arena = chunk;
+    }
+    char *dst = chunk->data + chunk->used;
+    memcpy(dst, str, len);
+    dst[len] = '\0';
+    chunk->used += len + 1;
+    return dst;
+}
+
+static inline void string_intern_arena_free(string_intern_chunk_t *arena) {
+    while (arena) {
+        string_intern_chunk_t *next = arena->next;
+        POCKET_FREE("string_intern_arena", arena, sizeof(string_intern_chunk_t) + arena->capacity);
+        arena = next;
+    }
+}
+
+/* Splits an id into its block and the offset inside that block */
+static inline unsigned string_intern_block_of(uint32_t id, size_t *offset) {
+    uint64_t biased = (uint64_t)id + (1u << STRING_INTERN_FIRST_BLOCK_BITS);
+#if defined(__GNUC__) || defined(__clang__)
+    unsigned top = 63u - (unsigned)__builtin_clzll(biased);
+#else
+    unsigned top = 0;
+    while (biased >> (top + 1)) top++;
+#endif
+    *offset = (size_t)(biased - (1ull << top));
+    return top - STRING_INTERN_FIRST_BLOCK_BITS;
+}
+
+#define STRING_INTERN_DECLARE(DECL_NAME)                                                              \
+    HASH_MAP_DECLARE(DECL_NAME##_map, string_intern_key_t, uint32_t)                                  \
+                                                                                                      \
+    typedef struct DECL_NAME##_t {                                                                    \
+        DECL_NAME##_map_t map;                                                                        \
+        string_intern_key_t *blocks[STRING_INTERN_MAX_BLOCKS]; /* id -> string, blocks never move */  \
+        uint32_t count;                                                                               \
+        string_intern_chunk_t *arena;                                                                 \
+        bool thread_safe;                                                                             \
+        pthread_rwlock_t lock;                                                                        \
+    } DECL_NAME##_t;                                                                                  \
+                                                                                                      \
+    /* Initializes pool in place. 0 when out of memory or the rwlock fails, with nothing to free. */  \
+    int DECL_NAME##_init(DECL_NAME##_t *pool, bool thread_safe);                                      \
+    void DECL_NAME##_free(DECL_NAME##_t *pool);                                                       \
+                                                                                                      \
+    /* Returns the id of str, adding it on first use. STRING_INTERN_INVALID_ID when out of memory. */ \
+    uint32_t DECL_NAME##_intern_n(DECL_NAME##_t *pool, const char *str, size_t len);                  \
+    uint32_t DECL_NAME##_intern(DECL_NAME##_t *pool, const char *str);                                \
+    uint32_t DECL_NAME##_intern_view(DECL_NAME##_t *pool, string_view_t view);                        \
+    uint32_t DECL_NAME##_intern_string(DECL_NAME##_t *pool, const string_t *str);                     \
+                                                                                                      \
+    /* Returns the id of str if it was interned before, STRING_INTERN_INVALID_ID otherwise */         \
+    uint32_t DECL_NAME##_lookup_n(DECL_NAME##_t *pool, const char *str, size_t len);                  \
+                                                                                                      \
+    /* Canonical pointer for str: equal strings always give the same pointer */                       \
+    const char *DECL_NAME##_canonical(DECL_NAME##_t *pool, const char *str, size_t len);              \
+                                                                                                      \
+    /* Accessors by id, the id must come from this pool */                                            \
+    const char *DECL_NAME##_cstr(const DECL_NAME##_t *pool, uint32_t id);                             \
+    size_t DECL_NAME##_length(const DECL_NAME##_t *pool, uint32_t id);                                \
+    uint64_t DECL_NAME##_hash(const DECL_NAME##_t *pool, uint32_t id);                                \
+    string_view_t DECL_NAME##_view(const DECL_NAME##_t *pool, uint32_t id);                           \
+    size_t DECL_NAME##_count(DECL_NAME##_t *pool);
+
+#define STRING_INTERN_IMPLEMENT(DECL_NAME)                                                                          \
+    HASH_MAP_IMPLEMENT(DECL_NAME##_map, string_intern_key_t, uint32_t)                                              \
+                                                                                                                    \
+    int DECL_NAME##_init(DECL_NAME##_t *pool, bool thread_safe) {                                                   \
+        memset(pool, 0, sizeof(*pool));                                                                             \
+        pool->map = DECL_NAME##_map_create(64, string_intern_keys_equal, string_intern_key_hash);                   \
+        if (unlikely_branch(!pool->map.entries)) return 0;                                                          \
+        if (thread_safe && unlikely_branch(pthread_rwlock_init(&pool->lock, NULL) != 0)) {                          \
+            DECL_NAME##_map_free(&pool->map);                                                                       \
+            return 0;                                                                                               \
+        }                                                                                                           \
+        pool->thread_safe = thread_safe;                                                                            \
+        return 1;                                                                                                   \
+    }                                                                                                               \
+                                                                                                                    \
+    void DECL_NAME##_free(DECL_NAME##_t *pool) {                                                                    \
+        DECL_NAME##_map_free(&pool->map);                                                                           \
+        for (unsigned b = 0; b < STRING_INTERN_MAX_BLOCKS; b++) {                                                   \
+            size_t entries = (size_t)1 << (b + STRING_INTERN_FIRST_BLOCK_BITS);                                     \
+            POCKET_FREE(#DECL_NAME, pool->blocks[b], entries * sizeof(string_intern_key_t));                        \
+            pool->blocks[b] = NULL;                                                                                 \
+        }                                                                                                           \
+        string_intern_arena_free(pool->arena);                                                                      \
+        pool->arena = NULL;                                                                                         \
+        pool->count = 0;                                                                                            \
+        if (pool->thread_safe) pthread_rwlock_destroy(&pool->lock);                                                 \
+        pool->thread_safe = false;                                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    static inline const string_intern_key_t *DECL_NAME##_entry(const DECL_NAME##_t *pool, uint32_t id) {            \
+        size_t offset;                                                                                              \
+        unsigned block = string_intern_block_of(id, &offset);                                                       \
+        return &pool->blocks[block][offset];                                                                        \
+    }                                                                                                               \
+                                                                                                                    \
+    /* Adds a string known to be missing. Caller holds the write lock on shared pools. */                           \
+    static uint32_t DECL_NAME##_add(DECL_NAME##_t *pool, string_intern_key_t key) {                                 \
+        if (unlikely_branch(pool->count == STRING_INTERN_INVALID_ID)) return STRING_INTERN_INVALID_ID;              \
+        uint32_t id = pool->count;                                                                                  \
+        size_t offset;                                                                                              \
+        unsigned block = string_intern_block_of(id, &offset);                                                       \
+        if (!pool->blocks[block]) {                                                                                 \
+            size_t entries = (size_t)1 << (block + STRING_INTERN_FIRST_BLOCK_BITS);                                 \
+            size_t bytes = entries * sizeof(string_intern_key_t);                                                   \
+            pool->blocks[block] = (string_intern_key_t *)POCKET_MALLOC(#DECL_NAME, bytes);                          \
+            if (unlikely_branch(!pool->blocks[block])) return STRING_INTERN_INVALID_ID;                             \
+        }                                                                                                           \
+        key.ptr = string_intern_arena_copy(&pool->arena, key.ptr, key.len);                                         \
+        if (unlikely_branch(!key.ptr)) return STRING_INTERN_INVALID_ID;                                             \
+        if (unlikely_branch(!DECL_NAME##_map_insert(&pool->map, key, id))) return STRING_INTERN_INVALID_ID;         \
+        pool->blocks[block][offset] = key;                                                                          \
+        pool->count++;                                                                                              \
+        return id;                                                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    uint32_t DECL_NAME##_lookup_n(DECL_NAME##_t *pool, const char *str, size_t len) {                               \
+        string_intern_key_t key = string_intern_make_key(str, len);                                                 \
+        if (pool->thread_safe) pthread_rwlock_rdlock(&pool->lock);                                                  \
+        uint32_t *found = DECL_NAME##_map_find(&pool->map, key);                                                    \
+        uint32_t id = found ? *found : STRING_INTERN_INVALID_ID;                                                    \
+        if (pool->thread_safe) pthread_rwlock_unlock(&pool->lock);                                                  \
+        return id;                                                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    uint32_t DECL_NAME##_intern_n(DECL_NAME##_t *pool, const char *str, size_t len) {                               \
+        string_intern_key_t key = string_intern_make_key(str, len);                                                 \
+        if (!pool->thread_safe) {                                                                                   \
+            uint32_t *found = DECL_NAME##_map_find(&pool->map, key);                                                \
+            return found ? *found : DECL_NAME##_add(pool, key);                                                     \
+        }                                                                                                           \
+        /* Most calls hit an existing string, so try under the shared lock first */                                 \
+        pthread_rwlock_rdlock(&pool->lock);                                                                         \
+        uint32_t *found = DECL_NAME##_map_find(&pool->map, key);                                                    \
+        uint32_t id = found ? *found : STRING_INTERN_INVALID_ID;                                                    \
+        pthread_rwlock_unlock(&pool->lock);                                                                         \
+        if (likely_branch(found)) return id;                                                                        \
+        pthread_rwlock_wrlock(&pool->lock);                                                                         \
+        found = DECL_NAME##_map_find(&pool->map, key); /* Another thread may have added it */                       \
+        id = found ? *found : DECL_NAME##_add(pool, key);                                                           \
+        pthread_rwlock_unlock(&pool->lock);                                                                         \
+        return id;                                                                                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    uint32_t DECL_NAME##_intern(DECL_NAME##_t *pool, const char *str) {                                             \
+        return DECL_NAME##_intern_n(pool, str, strlen(str));                                                        \
+    }                                                                                                               \
+                                                                                                                    \
+    uint32_t DECL_NAME##_intern_view(DECL_NAME##_t *pool, string_view_t view) {                                     \
+        return DECL_NAME##_intern_n(pool, view.data, view.size);                                                    \
+    }                                                                                                               \
+                                                                                                                    \
+    uint32_t DECL_NAME##_intern_string(DECL_NAME##_t *pool, const string_t *str) {                                  \
+        return DECL_NAME##_intern_n(pool, string_get_cstr(str), string_size(str));                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    const char *DECL_NAME##_canonical(DECL_NAME##_t *pool, const char *str, size_t len) {                           \
+        uint32_t id = DECL_NAME##_intern_n(pool, str, len);                                                         \
+        return id == STRING_INTERN_INVALID_ID ? NULL : DECL_NAME##_cstr(pool, id);                                  \
+    }                                                                                                               \
+                                                                                                                    \
+    const char *DECL_NAME##_cstr(const DECL_NAME##_t *pool, uint32_t id) {                                          \
+        return DECL_NAME##_entry(pool, id)->ptr;                                                                    \
+    }                                                                                                               \
+                                                                                                                    \
+    size_t DECL_NAME##_length(const DECL_NAME##_t *pool, uint32_t id) { return DECL_NAME##_entry(pool, id)->len; }  \
+                                                                                                                    \
+    uint64_t DECL_NAME##_hash(const DECL_NAME##_t *pool, uint32_t id) { return DECL_NAME##_entry(pool, id)->hash; } \
+                                                                                                                    \
+    string_view_t DECL_NAME##_view(const DECL_NAME##_t *pool, uint32_t id) {                                        \
+        const string_intern_key_t *entry = DECL_NAME##_entry(pool, id);                                             \
+        return string_view_create_n(entry->ptr, entry->len);                                                        \
+    }                                                                                                               \
+                                                                                                                    \
+    size_t DECL_NAME##_count(DECL_NAME##_t *pool) {                                                                 \
+        if (pool->thread_safe) pthread_rwlock_rdlock(&pool->lock);                                                  \
+        size_t count = pool->count;                                                                                 \
+        if (pool->thread_safe) pthread_rwlock_unlock(&pool->lock);                                                  \
+        return count;                                                                                               \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // _POCKET_DATA_STRUCTURES_STRING_INTERN_H
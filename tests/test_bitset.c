@@ -0,0 +1,193 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bitset.h"
+#include "unity.h"
+
+/* ====== Unity test setup/teardown ====== */
+void setUp(void) {}
+void tearDown(void) {}
+
+/* ====== Helpers ====== */
+static uint64_t rng_state = 88172645463325252ull;
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Fills bitset and the byte-per-flag reference with the same random bits, about one in density set */
+static void fill_random(bitset_t *bitset, unsigned char *reference, size_t bits, unsigned density) {
+    for (size_t i = 0; i < bits; i++) {
+        reference[i] = next_random() % density == 0;
+        bitset_assign(bitset, i, reference[i]);
+    }
+}
+
+/* ====== Test cases ====== */
+void test_set_test_clear(void) {
+    bitset_t bits = bitset_create(130);
+    TEST_ASSERT_NOT_NULL(bits.words);
+    TEST_ASSERT_EQUAL_size_t(130, bitset_size(&bits));
+    TEST_ASSERT_EQUAL_size_t(0, bitset_count(&bits));
+
+    TEST_ASSERT_EQUAL(1, bitset_set(&bits, 0));
+    TEST_ASSERT_EQUAL(1, bitset_set(&bits, 63));
+    TEST_ASSERT_EQUAL(1, bitset_set(&bits, 64));
+    TEST_ASSERT_EQUAL(1, bitset_set(&bits, 129));
+    TEST_ASSERT_EQUAL(0, bitset_set(&bits, 130));  // Out of range
+    TEST_ASSERT_TRUE(bitset_test(&bits, 63));
+    TEST_ASSERT_TRUE(bitset_test(&bits, 129));
+    TEST_ASSERT_FALSE(bitset_test(&bits, 1));
+    TEST_ASSERT_FALSE(bitset_test(&bits, 500));
+    TEST_ASSERT_EQUAL_size_t(4, bitset_count(&bits));
+
+    TEST_ASSERT_EQUAL(1, bitset_clear(&bits, 63));
+    TEST_ASSERT_FALSE(bitset_test(&bits, 63));
+    TEST_ASSERT_EQUAL_size_t(3, bitset_count(&bits));
+
+    bitset_fill(&bits, true);
+    TEST_ASSERT_EQUAL_size_t(130, bitset_count(&bits));  // Bits past the size stay cleared
+    bitset_flip_all(&bits);
+    TEST_ASSERT_EQUAL_size_t(0, bitset_count(&bits));
+
+    pocket_memory_usage_t usage = bitset_memory_usage(&bits);
+    TEST_ASSERT_EQUAL_size_t(3 * sizeof(uint64_t), usage.used_bytes);
+    TEST_ASSERT_EQUAL_size_t(0, usage.reserved_bytes % 32);  // Whole 256-bit blocks
+    bitset_free(&bits);
+    TEST_ASSERT_NULL(bits.words);
+}
+
+void test_resize_and_push_back(void) {
+    bitset_t bits = bitset_create(0);
+    for (size_t i = 0; i < 1000; i++) TEST_ASSERT_EQUAL(1, bitset_push_back(&bits, i % 3 == 0));
+    TEST_ASSERT_EQUAL_size_t(1000, bitset_size(&bits));
+    TEST_ASSERT_EQUAL_size_t(334, bitset_count(&bits));
+    TEST_ASSERT_TRUE(bitset_test(&bits, 999));
+
+    // Shrinking drops the bits, growing again brings back cleared ones
+    TEST_ASSERT_EQUAL(1, bitset_resize(&bits, 100));
+    TEST_ASSERT_EQUAL_size_t(34, bitset_count(&bits));
+    TEST_ASSERT_EQUAL(1, bitset_resize(&bits, 1000));
+    TEST_ASSERT_EQUAL_size_t(34, bitset_count(&bits));
+    TEST_ASSERT_FALSE(bitset_test(&bits, 999));
+    bitset_free(&bits);
+}
+
+void test_find_first_and_next(void) {
+    enum { N = 5000 };
+    static unsigned char reference[N];
+    bitset_t bits = bitset_create(N);
+    TEST_ASSERT_EQUAL_size_t(BITSET_NPOS, bitset_find_first(&bits));
+
+    fill_random(&bits, reference, N, 50);  // Sparse, so whole words get skipped
+    size_t expected = 0;
+    for (size_t i = bitset_find_first(&bits); i != BITSET_NPOS; i = bitset_find_next(&bits, i + 1)) {
+        while (!reference[expected]) expected++;
+        TEST_ASSERT_EQUAL_size_t(expected, i);
+        expected++;
+    }
+    while (expected < N) TEST_ASSERT_FALSE(reference[expected++]);
+
+    bitset_fill(&bits, false);
+    bitset_set(&bits, N - 1);
+    TEST_ASSERT_EQUAL_size_t(N - 1, bitset_find_first(&bits));
+    TEST_ASSERT_EQUAL_size_t(BITSET_NPOS, bitset_find_next(&bits, N));
+    bitset_free(&bits);
+}
+
+void test_bulk_operations_match_a_byte_reference(void) {
+    enum { N = 10007 };  // Not a multiple of the block size
+    static unsigned char a_ref[N], b_ref[N];
+    bitset_t a = bitset_create(N), b = bitset_create(N), result = bitset_create(N);
+    fill_random(&a, a_ref, N, 2);
+    fill_random(&b, b_ref, N, 3);
+
+    size_t and_count = 0;
+    for (size_t i = 0; i < N; i++) and_count += a_ref[i] & b_ref[i];
+    TEST_ASSERT_EQUAL_size_t(and_count, bitset_and_count(&a, &b));
+
+    for (int op = BITSET_AND; op <= BITSET_ANDNOT; op++) {
+        bitset_fill(&result, false);
+        bitset_or(&result, &a);
+        TEST_ASSERT_EQUAL(1, bitset_apply(&result, &b, (bitset_op_t)op));
+        size_t count = 0;
+        for (size_t i = 0; i < N; i++) {
+            int expected = op == BITSET_AND   ? a_ref[i] & b_ref[i]
+                           : op == BITSET_OR  ? a_ref[i] | b_ref[i]
+                           : op == BITSET_XOR ? a_ref[i] ^ b_ref[i]
+                                              : a_ref[i] & !b_ref[i];
+            TEST_ASSERT_EQUAL(expected, bitset_test(&result, i));
+            count += expected;
+        }
+        TEST_ASSERT_EQUAL_size_t(count, bitset_count(&result));
+    }
+
+    bitset_t other = bitset_create(N - 1);
+    TEST_ASSERT_EQUAL(0, bitset_and(&a, &other));  // Sizes must match
+    bitset_free(&other);
+    bitset_free(&a);
+    bitset_free(&b);
+    bitset_free(&result);
+}
+
+void test_rank_and_select(void) {
+    enum { N = 100003 };
+    static unsigned char reference[N];
+    static size_t ones[N];
+    bitset_t bits = bitset_create(N);
+    fill_random(&bits, reference, N, 7);
+
+    bitset_rank_t index;
+    TEST_ASSERT_EQUAL(1, bitset_rank_build(&index, &bits));
+    size_t count = 0;
+    for (size_t i = 0; i < N; i++) {
+        TEST_ASSERT_EQUAL_size_t(count, bitset_rank(&index, i));
+        if (reference[i]) ones[count++] = i;
+    }
+    TEST_ASSERT_EQUAL_size_t(count, bitset_rank(&index, N));
+    TEST_ASSERT_EQUAL_size_t(count, bitset_count(&bits));
+    TEST_ASSERT_TRUE(count > 2 * BITSET_SELECT_SAMPLE);  // Several samples are used
+
+    for (size_t k = 0; k < count; k++) TEST_ASSERT_EQUAL_size_t(ones[k], bitset_select(&index, k));
+    TEST_ASSERT_EQUAL_size_t(BITSET_NPOS, bitset_select(&index, count));
+
+    // Around 1/8 of the bitset in extra space
+    TEST_ASSERT_TRUE(bitset_rank_memory_usage(&index).reserved_bytes <= bitset_memory_usage(&bits).reserved_bytes / 7);
+    bitset_rank_free(&index);
+
+    // All set and all cleared
+    bitset_fill(&bits, true);
+    bitset_rank_build(&index, &bits);
+    TEST_ASSERT_EQUAL_size_t(N - 1, bitset_select(&index, N - 1));
+    TEST_ASSERT_EQUAL_size_t(1000, bitset_rank(&index, 1000));
+    bitset_rank_free(&index);
+    bitset_fill(&bits, false);
+    bitset_rank_build(&index, &bits);
+    TEST_ASSERT_EQUAL_size_t(0, bitset_rank(&index, N / 2));
+    TEST_ASSERT_EQUAL_size_t(BITSET_NPOS, bitset_select(&index, 0));
+    bitset_rank_free(&index);
+    bitset_free(&bits);
+}
+
+/* ====== Main runner ====== */
+int main(void) {
+#if defined(__AVX2__) && (defined(__GNUC__) || defined(__clang__))
+    // The AVX2 build of this file is only meaningful on a machine that has it
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("bmi2")) {
+        printf("AVX2/BMI2 not supported, skipping\n");
+        return 0;
+    }
+#endif
+    UNITY_BEGIN();
+
+    RUN_TEST(test_set_test_clear);
+    RUN_TEST(test_resize_and_push_back);
+    RUN_TEST(test_find_first_and_next);
+    RUN_TEST(test_bulk_operations_match_a_byte_reference);
+    RUN_TEST(test_rank_and_select);
+
+    return UNITY_END();
+}
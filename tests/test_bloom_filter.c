@@ -0,0 +1,92 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bloom_filter.h"
+#include "unity.h"
+
+/* ====== Unity test setup/teardown ====== */
+void setUp(void) {}
+void tearDown(void) {}
+
+/* ====== Test cases ====== */
+void test_bloom_has_no_false_negatives(void) {
+    bloom_filter_t filter = bloom_filter_create(10000, 0.01);
+    TEST_ASSERT_NOT_NULL(filter.blocks);
+    TEST_ASSERT_EQUAL_UINT64(0, (uintptr_t)filter.blocks % 64);  // Cache line aligned
+    TEST_ASSERT_EQUAL(6, filter.hashes);  // Fewer than the 7 of a plain Bloom filter
+    TEST_ASSERT_FALSE(bloom_filter_may_contain(&filter, 1));
+
+    for (uint64_t i = 0; i < 10000; i++) bloom_filter_add(&filter, i);  // Sequential keys, the filter mixes them
+    for (uint64_t i = 0; i < 10000; i++) TEST_ASSERT_TRUE(bloom_filter_may_contain(&filter, i));
+
+    bloom_filter_clear(&filter);
+    TEST_ASSERT_FALSE(bloom_filter_may_contain(&filter, 1));
+    bloom_filter_free(&filter);
+    TEST_ASSERT_NULL(filter.blocks);
+}
+
+void test_bloom_false_positive_rate_is_configurable(void) {
+    double rates[] = {0.1, 0.01, 0.001, 0.0001};
+    for (int r = 0; r < 4; r++) {
+        enum { N = 20000, PROBES = 1000000 };
+        bloom_filter_t filter = bloom_filter_create(N, rates[r]);
+        for (uint64_t i = 0; i < N; i++) bloom_filter_add(&filter, i * 2);
+        size_t false_positives = 0;
+        for (uint64_t i = 0; i < PROBES; i++) false_positives += bloom_filter_may_contain(&filter, i * 2 + 1);
+        double measured = (double)false_positives / PROBES;
+        TEST_ASSERT_TRUE(measured < rates[r] * 1.5);
+        TEST_ASSERT_TRUE(measured > rates[r] / 10);  // Not simply oversized
+
+        // Lower rates cost more bits per key: 1.44 * log2(1/p) for a plain Bloom filter, a bit more when blocked
+        double bits_per_key = bloom_filter_memory_usage(&filter).reserved_bytes * 8.0 / N;
+        double plain = 1.4427 * (r + 1) * 3.3219;
+        TEST_ASSERT_TRUE(bits_per_key > plain);
+        TEST_ASSERT_TRUE(bits_per_key < plain * 1.2);
+        bloom_filter_free(&filter);
+    }
+
+    // Out of range rates fall back to the default
+    bloom_filter_t filter = bloom_filter_create(0, 0);
+    TEST_ASSERT_EQUAL_DOUBLE(BLOOM_FILTER_DEFAULT_FPR, filter.false_positive_rate);
+    bloom_filter_free(&filter);
+}
+
+void test_xor_filter_static_set(void) {
+    enum { N = 50000, PROBES = 500000 };
+    static uint64_t keys[N + 10];
+    for (uint64_t i = 0; i < N; i++) keys[i] = i * 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 10; i++) keys[N + i] = keys[i];  // Duplicates are dropped
+
+    xor_filter_t filter;
+    TEST_ASSERT_TRUE(xor_filter_build(&filter, keys, N + 10));
+    TEST_ASSERT_EQUAL_size_t(N, filter.size);
+    for (size_t i = 0; i < N; i++) TEST_ASSERT_TRUE(xor_filter_may_contain(&filter, keys[i]));
+
+    size_t false_positives = 0;
+    for (uint64_t i = 0; i < PROBES; i++)
+        false_positives += xor_filter_may_contain(&filter, i * 0x9E3779B97F4A7C15ull + 1);
+    TEST_ASSERT_TRUE(false_positives < PROBES / 256 * 2);  // About 1/256
+
+    double bits_per_key = xor_filter_memory_usage(&filter).reserved_bytes * 8.0 / N;
+    TEST_ASSERT_TRUE(bits_per_key < 10.5);
+    xor_filter_free(&filter);
+    TEST_ASSERT_FALSE(xor_filter_may_contain(&filter, keys[0]));
+
+    // Tiny and empty sets
+    TEST_ASSERT_TRUE(xor_filter_build(&filter, keys, 1));
+    TEST_ASSERT_TRUE(xor_filter_may_contain(&filter, keys[0]));
+    xor_filter_free(&filter);
+    TEST_ASSERT_TRUE(xor_filter_build(&filter, keys, 0));
+    xor_filter_free(&filter);
+}
+
+/* ====== Main runner ====== */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bloom_has_no_false_negatives);
+    RUN_TEST(test_bloom_false_positive_rate_is_configurable);
+    RUN_TEST(test_xor_filter_static_set);
+
+    return UNITY_END();
+}
@@ -0,0 +1,232 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Tiny nodes force deep trees, so splits, borrows and merges all happen with few keys */
+#define BTREE_MAP_NODE_BYTES 64
+#include "btree_map.h"
+#include "unity.h"
+
+/* ====== Declare and implement a uint64->int B-tree map ====== */
+BTREE_MAP_DECLARE(series, uint64_t, int)
+BTREE_MAP_IMPLEMENT(series, uint64_t, int, default_compare_uint64)
+
+/* CMP can also be a macro */
+#define SMALL_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+BTREE_MAP_DECLARE(small, int, int)
+BTREE_MAP_IMPLEMENT(small, int, int, SMALL_CMP)
+
+/* ====== Unity test setup/teardown ====== */
+void setUp(void) {}
+void tearDown(void) {}
+
+/* ====== Helpers ====== */
+static uint64_t rng_state = 88172645463325252ull;
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Checks ordering, separators, node occupancy and leaf links. Returns the number of entries below node. */
+static size_t check_subtree(const small_t *map, const small_node_t *node, int has_low, int low, int has_high,
+                            int high, size_t depth, size_t *leaf_depth) {
+    if (node != map->root && node->count == 0) TEST_FAIL_MESSAGE("empty non-root node");
+    if (node->is_leaf) {
+        const small_leaf_t *leaf = (const small_leaf_t *)node;
+        if (*leaf_depth == 0) *leaf_depth = depth;
+        TEST_ASSERT_EQUAL_size_t(*leaf_depth, depth);  // All leaves at the same depth
+        for (size_t i = 0; i < leaf->header.count; i++) {
+            if (i > 0) TEST_ASSERT_TRUE(leaf->keys[i - 1] < leaf->keys[i]);
+            if (has_low) TEST_ASSERT_TRUE(leaf->keys[i] >= low);
+            if (has_high) TEST_ASSERT_TRUE(leaf->keys[i] < high);
+        }
+        if (leaf->next) TEST_ASSERT_TRUE(leaf->next->prev == leaf);
+        return leaf->header.count;
+    }
+    const small_inner_t *inner = (const small_inner_t *)node;
+    size_t total = 0;
+    for (size_t i = 0; i <= inner->header.count; i++) {
+        if (i > 0 && i < inner->header.count) TEST_ASSERT_TRUE(inner->keys[i - 1] < inner->keys[i]);
+        int child_has_low = i > 0 ? 1 : has_low, child_low = i > 0 ? inner->keys[i - 1] : low;
+        int child_has_high = i < inner->header.count ? 1 : has_high;
+        int child_high = i < inner->header.count ? inner->keys[i] : high;
+        total += check_subtree(map, inner->children[i], child_has_low, child_low, child_has_high, child_high,
+                               depth + 1, leaf_depth);
+    }
+    return total;
+}
+
+static void check_tree(const small_t *map) {
+    if (!map->root) {
+        TEST_ASSERT_EQUAL_size_t(0, map->size);
+        return;
+    }
+    size_t leaf_depth = 0;
+    TEST_ASSERT_EQUAL_size_t(map->size, check_subtree(map, map->root, 0, 0, 0, 0, 1, &leaf_depth));
+    TEST_ASSERT_EQUAL_size_t(map->height, leaf_depth);
+    TEST_ASSERT_NULL(map->first->prev);
+    TEST_ASSERT_NULL(map->last->next);
+}
+
+/* ====== Test cases ====== */
+void test_insert_find_and_overwrite(void) {
+    series_t map = series_create();
+    TEST_ASSERT_NULL(series_find(&map, 1));
+
+    for (uint64_t i = 0; i < 1000; i++) TEST_ASSERT_TRUE(series_insert(&map, i * 7 % 1000, (int)i));
+    TEST_ASSERT_EQUAL_size_t(1000, series_size(&map));
+    TEST_ASSERT_TRUE(map.height > 1);
+
+    TEST_ASSERT_TRUE(series_insert(&map, 14, -1));  // Overwrite
+    TEST_ASSERT_EQUAL_size_t(1000, series_size(&map));
+    TEST_ASSERT_EQUAL(-1, *series_find(&map, 14));
+    TEST_ASSERT_EQUAL(3, *series_find(&map, 21));
+    TEST_ASSERT_NULL(series_find(&map, 1000));
+
+    series_free(&map);
+    TEST_ASSERT_NULL(map.root);
+    TEST_ASSERT_EQUAL_size_t(0, map.leaf_count + map.inner_count);
+}
+
+void test_iteration_is_sorted_both_ways(void) {
+    small_t map = small_create();
+    for (int i = 0; i < 5000; i++) small_insert(&map, (int)(next_random() % 100000), i);
+    check_tree(&map);
+
+    size_t count = 0;
+    int previous = -1;
+    for (small_it_t it = small_it_begin(&map); small_it_valid(&it); small_it_next(&it), count++) {
+        TEST_ASSERT_TRUE(small_it_key(&it) > previous);
+        previous = small_it_key(&it);
+    }
+    TEST_ASSERT_EQUAL_size_t(small_size(&map), count);
+
+    count = 0;
+    for (small_it_t it = small_it_last(&map); small_it_valid(&it); small_it_prev(&it), count++) {
+        TEST_ASSERT_TRUE(small_it_key(&it) <= previous);
+        previous = small_it_key(&it);
+    }
+    TEST_ASSERT_EQUAL_size_t(small_size(&map), count);
+    small_free(&map);
+}
+
+void test_lower_and_upper_bound_ranges(void) {
+    small_t map = small_create();
+    for (int i = 0; i < 1000; i++) small_insert(&map, i * 10, i);  // 0, 10, ..., 9990
+
+    small_it_t it = small_lower_bound(&map, 250);
+    TEST_ASSERT_EQUAL(250, small_it_key(&it));
+    it = small_upper_bound(&map, 250);
+    TEST_ASSERT_EQUAL(260, small_it_key(&it));
+    it = small_lower_bound(&map, 251);
+    TEST_ASSERT_EQUAL(260, small_it_key(&it));
+    TEST_ASSERT_EQUAL(26, *small_it_value(&it));
+    it = small_lower_bound(&map, -5);
+    TEST_ASSERT_EQUAL(0, small_it_key(&it));
+    it = small_lower_bound(&map, 9991);
+    TEST_ASSERT_FALSE(small_it_valid(&it));
+    it = small_upper_bound(&map, 9990);
+    TEST_ASSERT_FALSE(small_it_valid(&it));
+
+    // Range [1000, 2000) holds 100 keys
+    int sum = 0, count = 0;
+    for (it = small_lower_bound(&map, 1000); small_it_valid(&it) && small_it_key(&it) < 2000; small_it_next(&it)) {
+        sum += *small_it_value(&it);
+        count++;
+    }
+    TEST_ASSERT_EQUAL(100, count);
+    TEST_ASSERT_EQUAL((100 + 199) * 100 / 2, sum);
+    small_free(&map);
+}
+
+void test_erase_rebalances(void) {
+    small_t map = small_create();
+    enum { N = 4000 };
+    static int present[N];
+    for (int i = 0; i < N; i++) {
+        present[i] = 1;
+        small_insert(&map, i, i);
+    }
+    size_t full_height = map.height;
+
+    // Erase in random order, checking the invariants along the way
+    for (int round = 0; round < 3 * N; round++) {
+        int key = (int)(next_random() % N);
+        TEST_ASSERT_EQUAL(present[key], small_erase(&map, key));
+        present[key] = 0;
+        if (round % 97 == 0) check_tree(&map);
+    }
+    check_tree(&map);
+    for (int i = 0; i < N; i++) TEST_ASSERT_EQUAL(present[i], small_find(&map, i) != NULL);
+
+    for (int i = 0; i < N; i++) small_erase(&map, i);
+    TEST_ASSERT_EQUAL_size_t(0, small_size(&map));
+    TEST_ASSERT_EQUAL_size_t(1, map.height);  // Collapsed back to a single leaf
+    TEST_ASSERT_TRUE(full_height > 1);
+    small_it_t it = small_it_begin(&map);
+    TEST_ASSERT_FALSE(small_it_valid(&it));
+
+    // Still usable after being emptied
+    small_insert(&map, 5, 50);
+    TEST_ASSERT_EQUAL(50, *small_find(&map, 5));
+    check_tree(&map);
+    small_free(&map);
+}
+
+void test_appends_keep_leaves_full(void) {
+    series_t map = series_create();
+    for (uint64_t t = 0; t < 100000; t++) series_insert(&map, 1000 + t * 3, (int)t);
+
+    pocket_memory_usage_t usage = series_memory_usage(&map);
+    TEST_ASSERT_EQUAL_size_t(100000 * (sizeof(uint64_t) + sizeof(int)), usage.used_bytes);
+    TEST_ASSERT_TRUE(usage.slack_bytes < usage.reserved_bytes / 50);  // Under 2% empty slots
+    TEST_ASSERT_EQUAL(99999, *series_find(&map, 1000 + 99999 * 3));
+
+    series_it_t it = series_it_last(&map);
+    TEST_ASSERT_EQUAL_UINT64(1000 + 99999 * 3, series_it_key(&it));
+    series_free(&map);
+}
+
+void test_bulk_load(void) {
+    enum { N = 3001 };
+    static int keys[N], values[N];
+    for (int i = 0; i < N; i++) {
+        keys[i] = i * 2;
+        values[i] = -i;
+    }
+    small_t map = small_create();
+    small_insert(&map, 1, 1);  // Replaced by the load
+    TEST_ASSERT_TRUE(small_bulk_load(&map, keys, values, N));
+    TEST_ASSERT_EQUAL_size_t(N, small_size(&map));
+    check_tree(&map);
+    TEST_ASSERT_NULL(small_find(&map, 1));
+    TEST_ASSERT_EQUAL(-1500, *small_find(&map, 3000));
+
+    // Inserts and erases keep working on a loaded tree
+    for (int i = 0; i < N; i++) small_insert(&map, i * 2 + 1, i);
+    for (int i = 0; i < N; i += 2) small_erase(&map, i * 2);
+    check_tree(&map);
+    TEST_ASSERT_EQUAL_size_t(N + N / 2, small_size(&map));
+
+    // Unsorted input is rejected
+    keys[10] = keys[9];
+    TEST_ASSERT_FALSE(small_bulk_load(&map, keys, values, N));
+    TEST_ASSERT_EQUAL_size_t(0, small_size(&map));
+    TEST_ASSERT_EQUAL_size_t(0, map.leaf_count + map.inner_count);
+    small_free(&map);
+}
+
+/* ====== Main runner ====== */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_insert_find_and_overwrite);
+    RUN_TEST(test_iteration_is_sorted_both_ways);
+    RUN_TEST(test_lower_and_upper_bound_ranges);
+    RUN_TEST(test_erase_rebalances);
+    RUN_TEST(test_appends_keep_leaves_full);
+    RUN_TEST(test_bulk_load);
+
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dynamic_array.h"
+#include "dynamic_array_io.h"
+#include "unity.h"
+
+DYN_ARRAY_DECLARE(dyn_array_double, double)
+DYN_ARRAY_IMPLEMENT(dyn_array_double, double)
+DYN_ARRAY_IO_DECLARE(dyn_array_double, double)
+DYN_ARRAY_IO_IMPLEMENT(dyn_array_double, double)
+
+DYN_ARRAY_DECLARE(dyn_array_short, short)
+DYN_ARRAY_IMPLEMENT(dyn_array_short, short)
+DYN_ARRAY_IO_DECLARE(dyn_array_short, short)
+DYN_ARRAY_IO_IMPLEMENT(dyn_array_short, short)
+
+static char path[64];
+
+void setUp(void) {
+    strcpy(path, "/tmp/pocket_dyn_array_io_XXXXXX");
+    close(mkstemp(path));
+}
+
+void tearDown(void) { unlink(path); }
+
+/* Helper macro to compare size_t values using Unity */
+#define TEST_ASSERT_EQUAL_SIZE_T(expected, actual) \
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(expected), (unsigned int)(actual))
+
+static void save(const dyn_array_double_t *a) {
+    int fd = open(path, O_WRONLY | O_TRUNC);
+    TEST_ASSERT_TRUE(dyn_array_double_write(a, fd));
+    close(fd);
+}
+
+static dyn_array_double_t *make_array(size_t n) {
+    dyn_array_double_t *a = dyn_array_double_create(4);
+    for (size_t i = 0; i < n; i++) dyn_array_double_push_back(a, (double)i * 1.5);
+    return a;
+}
+
+void test_write_then_read_roundtrip(void) {
+    dyn_array_double_t *a = make_array(10000);
+    save(a);
+
+    int fd = open(path, O_RDONLY);
+    dyn_array_double_t *b = dyn_array_double_read(fd);
+    close(fd);
+
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_SIZE_T(10000, dyn_array_double_size(b));
+    TEST_ASSERT_EQUAL_MEMORY(a->data, b->data, 10000 * sizeof(double));
+
+    /* The loaded array is a regular, growable array */
+    TEST_ASSERT_TRUE(dyn_array_double_push_back(b, -1.0));
+    TEST_ASSERT_EQUAL_DOUBLE(-1.0, dyn_array_double_get(b, 10000));
+
+    dyn_array_double_free(a);
+    dyn_array_double_free(b);
+}
+
+void test_map_file_is_zero_copy_view(void) {
+    dyn_array_double_t *a = make_array(1000);
+    save(a);
+
+    const dyn_array_double_t *view = dyn_array_double_map_file(path);
+    TEST_ASSERT_NOT_NULL(view);
+    TEST_ASSERT_EQUAL_SIZE_T(1000, dyn_array_double_size(view));
+    TEST_ASSERT_EQUAL_DOUBLE(1.5 * 999, dyn_array_double_get(view, 999));
+    TEST_ASSERT_EQUAL_MEMORY(a->data, view->data, 1000 * sizeof(double));
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)view->data % 64);
+
+    dyn_array_double_unmap(view);
+    dyn_array_double_free(a);
+}
+
+void test_empty_array_roundtrip(void) {
+    dyn_array_double_t *a = make_array(0);
+    save(a);
+
+    const dyn_array_double_t *view = dyn_array_double_map_file(path);
+    TEST_ASSERT_NOT_NULL(view);
+    TEST_ASSERT_EQUAL_SIZE_T(0, dyn_array_double_size(view));
+    dyn_array_double_unmap(view);
+
+    int fd = open(path, O_RDONLY);
+    dyn_array_double_t *b = dyn_array_double_read(fd);
+    close(fd);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_SIZE_T(0, dyn_array_double_size(b));
+
+    dyn_array_double_free(a);
+    dyn_array_double_free(b);
+}
+
+void test_rejects_mismatched_element_type(void) {
+    dyn_array_double_t *a = make_array(8);
+    save(a);
+
+    TEST_ASSERT_NULL(dyn_array_short_map_file(path));
+    int fd = open(path, O_RDONLY);
+    TEST_ASSERT_NULL(dyn_array_short_read(fd));
+    close(fd);
+
+    dyn_array_double_free(a);
+}
+
+void test_rejects_truncated_and_missing_files(void) {
+    dyn_array_double_t *a = make_array(100);
+    save(a);
+    TEST_ASSERT_EQUAL_INT(0, truncate(path, 64 + 50 * sizeof(double)));
+
+    TEST_ASSERT_NULL(dyn_array_double_map_file(path));
+    int fd = open(path, O_RDONLY);
+    TEST_ASSERT_NULL(dyn_array_double_read(fd));
+    close(fd);
+
+    TEST_ASSERT_NULL(dyn_array_double_map_file("/nonexistent/pocket/file"));
+    dyn_array_double_free(a);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_write_then_read_roundtrip);
+    RUN_TEST(test_map_file_is_zero_copy_view);
+    RUN_TEST(test_empty_array_roundtrip);
+    RUN_TEST(test_rejects_mismatched_element_type);
+    RUN_TEST(test_rejects_truncated_and_missing_files);
+    return UNITY_END();
+}
@@ -7,6 +7,10 @@ static bool int_equal(int a, int b) { return a == b; }
 HASH_MAP_DECLARE(i2i_map, int, int)
 HASH_MAP_IMPLEMENT(i2i_map, int, int)
 
+/* A second map with the same key and value types must not clash with the first */
+HASH_MAP_DECLARE(other_i2i_map, int, int)
+HASH_MAP_IMPLEMENT(other_i2i_map, int, int)
+
 /* ====== Unity test setup/teardown ====== */
 void setUp(void) {}
 void tearDown(void) {}
@@ -110,6 +114,67 @@ void test_iterator_traverses_all_entries(void) {
     i2i_map_free(&map);
 }
 
+void test_erase_and_reinsert_keeps_counts(void) {
+    i2i_map_t map = i2i_map_create(8, int_equal, default_hash_int);
+
+    // Churn through many more keys than the capacity, always keeping a few live
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(i2i_map_insert(&map, i, i * 2));
+        if (i >= 3) TEST_ASSERT_TRUE(i2i_map_erase(&map, i - 3));
+    }
+    TEST_ASSERT_EQUAL_size_t(3, map.occupancy);
+    TEST_ASSERT_FALSE(i2i_map_erase(&map, 0));  // Erasing twice fails
+    TEST_ASSERT_EQUAL_size_t(3, map.occupancy);
+    TEST_ASSERT_TRUE(map.capacity <= 16);  // Tombstones were cleaned, not grown over
+
+    TEST_ASSERT_EQUAL(1994, *i2i_map_find(&map, 997));
+    TEST_ASSERT_NULL(i2i_map_find(&map, 996));
+
+    i2i_map_free(&map);
+}
+
+void test_two_maps_same_types(void) {
+    i2i_map_t a = i2i_map_create(4, int_equal, default_hash_int);
+    other_i2i_map_t b = other_i2i_map_create(4, int_equal, default_hash_int);
+    i2i_map_insert(&a, 1, 10);
+    other_i2i_map_insert(&b, 1, 20);
+    TEST_ASSERT_EQUAL(10, *i2i_map_find(&a, 1));
+    TEST_ASSERT_EQUAL(20, *other_i2i_map_find(&b, 1));
+    i2i_map_free(&a);
+    other_i2i_map_free(&b);
+}
+
+void test_filter_skips_misses_and_survives_rehash(void) {
+    i2i_map_t map = i2i_map_create(16, int_equal, default_hash_int);
+    for (int i = 0; i < 100; i++) i2i_map_insert(&map, i, i);
+    TEST_ASSERT_TRUE(i2i_map_enable_filter(&map, 0.01));
+
+    // Grows several times, each rehash rebuilds the filter
+    for (int i = 100; i < 5000; i++) i2i_map_insert(&map, i, i);
+    for (int i = 0; i < 5000; i++) TEST_ASSERT_EQUAL(i, *i2i_map_find(&map, i));  // No false negatives
+
+    int false_positives = 0;
+    for (int i = 5000; i < 105000; i++) {
+        TEST_ASSERT_NULL(i2i_map_find(&map, i));
+        false_positives += bloom_filter_may_contain(&map.filter, default_hash_int(i));
+    }
+    TEST_ASSERT_TRUE(false_positives < 2000);  // 1% asked for, 2% allowed
+
+    // Erased keys stay in the filter until it is rebuilt
+    for (int i = 0; i < 5000; i++) i2i_map_erase(&map, i);
+    TEST_ASSERT_TRUE(bloom_filter_may_contain(&map.filter, default_hash_int(42)));
+    TEST_ASSERT_TRUE(i2i_map_rebuild_filter(&map));
+    TEST_ASSERT_FALSE(bloom_filter_may_contain(&map.filter, default_hash_int(42)));
+    TEST_ASSERT_TRUE(i2i_map_memory_usage(&map).overhead_bytes > 0);
+
+    i2i_map_disable_filter(&map);
+    TEST_ASSERT_NULL(map.filter.blocks);
+    TEST_ASSERT_FALSE(i2i_map_rebuild_filter(&map));
+    i2i_map_insert(&map, 7, 70);
+    TEST_ASSERT_EQUAL(70, *i2i_map_find(&map, 7));
+    i2i_map_free(&map);
+}
+
 int main() {
     UNITY_BEGIN();
 
@@ -119,6 +184,9 @@ int main() {
     RUN_TEST(test_erase_removes_key);
     RUN_TEST(test_insert_triggers_rehash);
     RUN_TEST(test_iterator_traverses_all_entries);
+    RUN_TEST(test_erase_and_reinsert_keeps_counts);
+    RUN_TEST(test_two_maps_same_types);
+    RUN_TEST(test_filter_skips_misses_and_survives_rehash);
 
     return UNITY_END();
 }
@@ -0,0 +1,200 @@
+#include "dynamic_array.h"
+#include "hash_map.h"
+#include "pocket_alloc.h"
+#include "pocket_string.h"
+#include "ring_queue.h"
+#include "soa_array.h"
+#include "string_builder.h"
+#include "unity.h"
+
+/* This test is built with POCKET_ALLOC_TRACING, see tests/CMakeLists.txt */
+POCKET_ALLOC_TRACING_IMPLEMENT()
+
+DYN_ARRAY_DECLARE(traced_vec, int)
+DYN_ARRAY_IMPLEMENT(traced_vec, int)
+
+HASH_MAP_DECLARE(traced_map, int, int)
+HASH_MAP_IMPLEMENT(traced_map, int, int)
+
+SOA_ARRAY_DECLARE(traced_soa, (double, x), (int, id))
+SOA_ARRAY_IMPLEMENT(traced_soa, (double, x), (int, id))
+
+MPMC_QUEUE_DECLARE(traced_mpmc, int)
+MPMC_QUEUE_IMPLEMENT(traced_mpmc, int)
+
+SPSC_QUEUE_DECLARE(traced_spsc, int)
+SPSC_QUEUE_IMPLEMENT(traced_spsc, int)
+
+static bool int_equal(int a, int b) { return a == b; }
+
+void setUp(void) { pocket_alloc_reset(); }
+void tearDown(void) {}
+
+/* Helper macro to compare size_t values using Unity */
+#define TEST_ASSERT_EQUAL_SIZE_T(expected, actual) \
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(expected), (unsigned int)(actual))
+
+void test_dyn_array_is_traced_by_name(void) {
+    traced_vec_t *vec = traced_vec_create(4);
+    for (int i = 0; i < 16; i++) traced_vec_push_back(vec, i);  // 4 -> 8 -> 16
+
+    pocket_alloc_stats_t stats = pocket_alloc_get_stats("traced_vec");
+    TEST_ASSERT_EQUAL_SIZE_T(2, stats.allocations);  // Struct and data
+    TEST_ASSERT_EQUAL_SIZE_T(2, stats.reallocations);
+    TEST_ASSERT_EQUAL_SIZE_T(sizeof(traced_vec_t) + 16 * sizeof(int), stats.live_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(stats.live_bytes, stats.peak_bytes);
+
+    traced_vec_free(vec);
+    stats = pocket_alloc_get_stats("traced_vec");
+    TEST_ASSERT_EQUAL_SIZE_T(2, stats.frees);
+    TEST_ASSERT_EQUAL_SIZE_T(0, stats.live_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(sizeof(traced_vec_t) + 16 * sizeof(int), stats.peak_bytes);
+}
+
+void test_hash_map_and_strings_are_traced(void) {
+    traced_map_t map = traced_map_create(4, int_equal, default_hash_int);
+    for (int i = 0; i < 100; i++) traced_map_insert(&map, i, i);
+    string_t s = string_create("a string that is too long to stay inline");
+    string_append_cstr(&s, " and grows");
+
+    pocket_alloc_stats_t map_stats = pocket_alloc_get_stats("traced_map");
+    TEST_ASSERT_EQUAL_SIZE_T(map.capacity * sizeof(traced_map_entry_t), map_stats.live_bytes);
+    TEST_ASSERT_TRUE(map_stats.allocations > 1);  // Every rehash allocates a new slot array
+    TEST_ASSERT_EQUAL_SIZE_T(map_stats.allocations - 1, map_stats.frees);
+
+    pocket_alloc_stats_t string_stats = pocket_alloc_get_stats("string_t");
+    TEST_ASSERT_EQUAL_SIZE_T(1, string_stats.allocations);
+    TEST_ASSERT_EQUAL_SIZE_T(1, string_stats.reallocations);
+    TEST_ASSERT_EQUAL_SIZE_T(sizeof(string_heap_header_t) + string_capacity(&s) + 1, string_stats.live_bytes);
+
+    pocket_alloc_stats_t total = pocket_alloc_get_stats(NULL);
+    TEST_ASSERT_EQUAL_SIZE_T(map_stats.live_bytes + string_stats.live_bytes, total.live_bytes);
+
+    traced_map_free(&map);
+    string_free(&s);
+    TEST_ASSERT_EQUAL_SIZE_T(0, pocket_alloc_get_stats(NULL).live_bytes);
+}
+
+void test_builder_chunks_are_traced(void) {
+    string_builder_t b = string_builder_create(16);
+    for (int i = 0; i < 10; i++) string_builder_append_cstr(&b, "0123456789");
+    string_builder_insert(&b, 5, "xyz", 3);
+    TEST_ASSERT_TRUE(pocket_alloc_get_stats("string_builder_t").live_bytes > 100);
+    string_builder_free(&b);
+    TEST_ASSERT_EQUAL_SIZE_T(0, pocket_alloc_get_stats("string_builder_t").live_bytes);
+}
+
+void test_memory_usage_per_instance(void) {
+    traced_vec_t *vec = traced_vec_create(64);
+    for (int i = 0; i < 10; i++) traced_vec_push_back(vec, i);
+    pocket_memory_usage_t usage = traced_vec_memory_usage(vec);
+    TEST_ASSERT_EQUAL_SIZE_T(10 * sizeof(int), usage.used_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(64 * sizeof(int), usage.reserved_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(54 * sizeof(int), usage.slack_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(sizeof(traced_vec_t), usage.overhead_bytes);
+    traced_vec_free(vec);
+
+    traced_map_t map = traced_map_create(16, int_equal, default_hash_int);
+    for (int i = 0; i < 6; i++) traced_map_insert(&map, i, i);
+    traced_map_erase(&map, 0);
+    traced_map_erase(&map, 1);
+    usage = traced_map_memory_usage(&map);
+    TEST_ASSERT_EQUAL_SIZE_T(4 * sizeof(traced_map_entry_t), usage.used_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(16 * sizeof(traced_map_entry_t), usage.reserved_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(2, usage.tombstones);
+    traced_map_free(&map);
+
+    string_t small = string_create("tiny");
+    usage = string_memory_usage(&small);
+    TEST_ASSERT_EQUAL_SIZE_T(4, usage.used_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(STRING_SSO_CAPACITY, usage.reserved_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(0, usage.overhead_bytes);
+    string_free(&small);
+}
+
+void test_aligned_containers_are_traced(void) {
+    traced_soa_t *soa = traced_soa_create(4);
+    for (int i = 0; i < 20; i++) {
+        traced_soa_row_t row = {i * 0.5, i};
+        traced_soa_push_back(soa, row);  // 4 -> 8 -> 16 -> 32
+    }
+    pocket_alloc_stats_t stats = pocket_alloc_get_stats("traced_soa");
+    TEST_ASSERT_EQUAL_SIZE_T(1 + 2 * 4, stats.allocations);  // Struct, then both columns at every capacity
+    TEST_ASSERT_EQUAL_SIZE_T(2 * 3, stats.frees);
+    pocket_memory_usage_t usage = traced_soa_memory_usage(soa);
+    TEST_ASSERT_EQUAL_SIZE_T(usage.reserved_bytes + usage.overhead_bytes, stats.live_bytes);
+    traced_soa_free(soa);
+    TEST_ASSERT_EQUAL_SIZE_T(0, pocket_alloc_get_stats("traced_soa").live_bytes);
+
+    traced_mpmc_t *mpmc = traced_mpmc_create(100);
+    traced_spsc_t *spsc = traced_spsc_create(3);
+    usage = traced_mpmc_memory_usage(mpmc);
+    TEST_ASSERT_EQUAL_SIZE_T(usage.reserved_bytes + usage.overhead_bytes,
+                             pocket_alloc_get_stats("traced_mpmc").live_bytes);
+    usage = traced_spsc_memory_usage(spsc);
+    TEST_ASSERT_EQUAL_SIZE_T(usage.reserved_bytes + usage.overhead_bytes,
+                             pocket_alloc_get_stats("traced_spsc").live_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(2, pocket_alloc_get_stats("traced_spsc").allocations);
+    traced_mpmc_free(mpmc);
+    traced_spsc_free(spsc);
+    TEST_ASSERT_EQUAL_SIZE_T(0, pocket_alloc_get_stats(NULL).live_bytes);
+}
+
+void test_report_lists_containers(void) {
+    traced_vec_t *vec = traced_vec_create(8);
+    FILE *out = tmpfile();
+    pocket_alloc_report(out);
+    traced_vec_free(vec);
+
+    char text[1024] = {0};
+    rewind(out);
+    size_t got = fread(text, 1, sizeof(text) - 1, out);
+    fclose(out);
+    TEST_ASSERT_TRUE(got > 0);
+    TEST_ASSERT_NOT_NULL(strstr(text, "traced_vec"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "(all)"));
+}
+
+void test_names_beyond_the_table_share_an_other_row(void) {
+    // Names must outlive the table, and distinct addresses keep the pointer comparison from matching
+    static char names[POCKET_ALLOC_MAX_NAMES + 8][24];
+    void *blocks[POCKET_ALLOC_MAX_NAMES + 8];
+    for (int i = 0; i < POCKET_ALLOC_MAX_NAMES + 8; i++) {
+        snprintf(names[i], sizeof(names[i]), "name_%d", i);
+        blocks[i] = POCKET_MALLOC(names[i], 10);
+    }
+    TEST_ASSERT_EQUAL_SIZE_T(10, pocket_alloc_get_stats("name_0").live_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(10, pocket_alloc_get_stats(names[POCKET_ALLOC_MAX_NAMES - 1]).live_bytes);
+    pocket_alloc_stats_t other = pocket_alloc_get_stats("(other)");
+    TEST_ASSERT_EQUAL_SIZE_T(8, other.allocations);
+    TEST_ASSERT_EQUAL_SIZE_T(80, other.live_bytes);
+
+    FILE *out = tmpfile();
+    pocket_alloc_report(out);
+    rewind(out);
+    char line[256];
+    int other_rows = 0, last_name_rows = 0;
+    while (fgets(line, sizeof(line), out)) {
+        other_rows += strncmp(line, "(other) ", 8) == 0;
+        last_name_rows += strstr(line, names[POCKET_ALLOC_MAX_NAMES - 1]) != NULL;
+    }
+    fclose(out);
+    TEST_ASSERT_EQUAL(1, other_rows);
+    TEST_ASSERT_EQUAL(1, last_name_rows);
+
+    for (int i = 0; i < POCKET_ALLOC_MAX_NAMES + 8; i++) POCKET_FREE(names[i], blocks[i], 10);
+    TEST_ASSERT_EQUAL_SIZE_T(0, pocket_alloc_get_stats("(other)").live_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(0, pocket_alloc_get_stats("name_0").live_bytes);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_dyn_array_is_traced_by_name);
+    RUN_TEST(test_hash_map_and_strings_are_traced);
+    RUN_TEST(test_builder_chunks_are_traced);
+    RUN_TEST(test_memory_usage_per_instance);
+    RUN_TEST(test_aligned_containers_are_traced);
+    RUN_TEST(test_report_lists_containers);
+    RUN_TEST(test_names_beyond_the_table_share_an_other_row);
+    return UNITY_END();
+}
@@ -0,0 +1,319 @@
+#include <memory>
+#include <string_view>
+
+#include "dynamic_array_io.h"
+#include "pocket.hpp"
+#include "string_builder.h"
+#include "unity.h"
+
+/* ====== The same C containers, to check layouts and hashes against ====== */
+DYN_ARRAY_DECLARE(c_ints, int)
+DYN_ARRAY_IMPLEMENT(c_ints, int)
+DYN_ARRAY_IO_DECLARE(c_ints, int)  // Only instantiated to keep the generator compiling as C++
+DYN_ARRAY_IO_IMPLEMENT(c_ints, int)
+
+static bool c_int_equal(int a, int b) { return a == b; }
+HASH_MAP_DECLARE(c_i2i, int, int)
+HASH_MAP_IMPLEMENT(c_i2i, int, int)
+
+/* ====== Hashes are usable at compile time ====== */
+static_assert(pocket::hash<std::string_view>{}("") == 1469598103934665603ULL);
+static_assert(pocket::hash<std::string_view>{}("a") != pocket::hash<std::string_view>{}("b"));
+static_assert(pocket::hash<int>{}(42) != pocket::hash<int>{}(43));
+
+/* ====== Counts live objects to catch leaks and double destruction ====== */
+static int live_objects = 0;
+
+struct tracked {
+    int id;
+    explicit tracked(int id) : id(id) { live_objects++; }
+    tracked(const tracked &other) : id(other.id) { live_objects++; }
+    tracked(tracked &&other) noexcept : id(other.id) { live_objects++; }
+    tracked &operator=(const tracked &) = default;
+    tracked &operator=(tracked &&) noexcept = default;
+    ~tracked() { live_objects--; }
+};
+
+// Copies throw on demand, like a pocket::string copy running out of memory
+struct fragile {
+    int id;
+    static inline bool fail_copies = false;
+    explicit fragile(int id) : id(id) { live_objects++; }
+    fragile(const fragile &other) : id(other.id) {
+        if (fail_copies) throw std::bad_alloc();
+        live_objects++;
+    }
+    fragile(fragile &&other) noexcept : id(other.id) { live_objects++; }
+    ~fragile() { live_objects--; }
+    bool operator==(const fragile &other) const noexcept { return id == other.id; }
+};
+
+struct fragile_hash {
+    std::uint64_t operator()(const fragile &key) const noexcept { return pocket::hash<int>{}(key.id); }
+};
+
+/* ====== Unity test setup/teardown ====== */
+void setUp(void) { live_objects = 0; }
+void tearDown(void) {}
+
+/* ====== Test cases ====== */
+void test_hashes_match_the_c_defaults(void) {
+    TEST_ASSERT_EQUAL_UINT64(default_hash_int(-7), pocket::hash<int>{}(-7));
+    TEST_ASSERT_EQUAL_UINT64(default_hash_uint64(1ull << 40), pocket::hash<uint64_t>{}(1ull << 40));
+    TEST_ASSERT_EQUAL_UINT64(default_hash_double(2.5), pocket::hash<double>{}(2.5));
+    TEST_ASSERT_EQUAL_UINT64(default_hash_cstr("route"), pocket::hash<std::string_view>{}("route"));
+
+    pocket::string long_key("a string that is too long for the inline buffer");
+    TEST_ASSERT_EQUAL_UINT64(pocket::hash<std::string_view>{}(long_key.view()),
+                             pocket::hash<pocket::string>{}(long_key));
+}
+
+void test_vector_matches_the_dyn_array_layout(void) {
+    pocket::vector<int> values{1, 2, 3};
+    for (int i = 4; i <= 100; i++) values.push_back(i);
+    TEST_ASSERT_EQUAL_size_t(100, values.size());
+    TEST_ASSERT_EQUAL(100, values.back());
+
+    // Same {data, size, capacity} struct as DYN_ARRAY
+    static_assert(sizeof(pocket::vector<int>) == sizeof(c_ints_t));
+    c_ints_t view;
+    std::memcpy(&view, &values, sizeof(view));
+    TEST_ASSERT_EQUAL(50, c_ints_get(&view, 49));
+    TEST_ASSERT_EQUAL_size_t(values.capacity(), c_ints_capacity(&view));
+
+    values.insert(values.begin() + 1, 42);
+    TEST_ASSERT_EQUAL(42, values[1]);
+    TEST_ASSERT_EQUAL(2, values[2]);
+    values.erase(values.begin());
+    TEST_ASSERT_EQUAL(42, values.front());
+    TEST_ASSERT_EQUAL_size_t(100, values.size());
+
+    pocket::vector<int> copy = values;
+    values.clear();
+    TEST_ASSERT_EQUAL_size_t(100, copy.size());
+    TEST_ASSERT_EQUAL_size_t(100 * sizeof(int), copy.memory_usage().used_bytes);
+}
+
+void test_vector_holds_move_only_and_non_trivial_elements(void) {
+    {
+        pocket::vector<std::unique_ptr<int>> owners;
+        for (int i = 0; i < 1000; i++) owners.emplace_back(new int(i));
+        owners.emplace(owners.begin(), std::make_unique<int>(-1));
+        TEST_ASSERT_EQUAL(-1, *owners[0]);
+        TEST_ASSERT_EQUAL(999, *owners.back());
+
+        pocket::vector<std::unique_ptr<int>> moved = std::move(owners);
+        TEST_ASSERT_EQUAL_size_t(0, owners.size());
+        TEST_ASSERT_EQUAL_size_t(1001, moved.size());
+        moved.erase(moved.begin() + 500);
+        TEST_ASSERT_EQUAL(500, *moved[500]);
+    }
+    {
+        pocket::vector<tracked> items;
+        for (int i = 0; i < 100; i++) items.emplace_back(i);
+        items.emplace_back(items[0]);  // Aliases an element while the array grows
+        TEST_ASSERT_EQUAL(0, items.back().id);
+        while (items.size() > 10) items.pop_back();
+        TEST_ASSERT_EQUAL(10, live_objects);
+        items.erase(items.begin());
+        TEST_ASSERT_EQUAL(9, live_objects);
+        TEST_ASSERT_EQUAL(1, items.front().id);
+    }
+    TEST_ASSERT_EQUAL(0, live_objects);
+}
+
+// Default construction throws once `fail_after` objects exist
+struct limited {
+    static inline int fail_after = -1;
+    limited() {
+        if (live_objects == fail_after) throw std::bad_alloc();
+        live_objects++;
+    }
+    ~limited() { live_objects--; }
+};
+
+void test_vector_sized_and_reserved_construction(void) {
+    pocket::vector<int> zeros(5);
+    TEST_ASSERT_EQUAL_size_t(5, zeros.size());
+    for (int value : zeros) TEST_ASSERT_EQUAL(0, value);
+
+    pocket::vector<int> one{5};  // Braces still pick the initializer list
+    TEST_ASSERT_EQUAL_size_t(1, one.size());
+    TEST_ASSERT_EQUAL(5, one[0]);
+
+    pocket::vector<int> reserved(pocket::with_capacity, 100);
+    TEST_ASSERT_EQUAL_size_t(0, reserved.size());
+    TEST_ASSERT_EQUAL_size_t(100, reserved.capacity());
+
+    {
+        pocket::vector<limited> items(8);
+        TEST_ASSERT_EQUAL(8, live_objects);
+    }
+    TEST_ASSERT_EQUAL(0, live_objects);
+
+    // A throwing element destroys the ones already built
+    limited::fail_after = 3;
+    bool thrown = false;
+    try {
+        pocket::vector<limited> items(8);
+    } catch (const std::bad_alloc &) {
+        thrown = true;
+    }
+    limited::fail_after = -1;
+    TEST_ASSERT_TRUE(thrown);
+    TEST_ASSERT_EQUAL(0, live_objects);
+}
+
+void test_hash_map_matches_the_c_probing(void) {
+    pocket::hash_map<int, int> map(16);
+    c_i2i_t c_map = c_i2i_create(16, c_int_equal, default_hash_int);
+    for (int i = 0; i < 1000; i++) {
+        map.insert_or_assign(i * 7, i);
+        c_i2i_insert(&c_map, i * 7, i);
+    }
+    for (int i = 0; i < 500; i++) {
+        map.erase(i * 14);
+        c_i2i_erase(&c_map, i * 14);
+    }
+
+    // Same capacity, same slots
+    TEST_ASSERT_EQUAL_size_t(c_map.capacity, map.capacity());
+    TEST_ASSERT_EQUAL_size_t(c_map.occupancy, map.size());
+    size_t index = 0;
+    c_i2i_it_t c_it = c_i2i_it_begin(&c_map);
+    for (auto [key, value] : map) {
+        TEST_ASSERT_EQUAL(c_i2i_it_key(&c_it), key);
+        TEST_ASSERT_EQUAL(c_i2i_it_value(&c_it), value);
+        c_i2i_it_next(&c_it);
+        index++;
+    }
+    TEST_ASSERT_EQUAL_size_t(map.size(), index);
+    TEST_ASSERT_EQUAL_size_t(c_i2i_memory_usage(&c_map).reserved_bytes, map.memory_usage().reserved_bytes);
+    TEST_ASSERT_EQUAL_size_t(c_map.tombstones, map.memory_usage().tombstones);
+    c_i2i_free(&c_map);
+
+    TEST_ASSERT_NULL(map.find(14));
+    TEST_ASSERT_EQUAL(1, *map.find(7));
+    map[7] += 10;
+    TEST_ASSERT_EQUAL(11, map.at(7));
+    TEST_ASSERT_EQUAL(0, map[-1]);  // Inserted by operator[]
+}
+
+void test_hash_map_emplace_and_move_only_values(void) {
+    {
+        pocket::hash_map<pocket::string, std::unique_ptr<tracked>> owners;
+        for (int i = 0; i < 200; i++) {
+            pocket::string key("key number ");
+            key.append(std::to_string(i));
+            auto [value, inserted] = owners.emplace(std::move(key), std::make_unique<tracked>(i));
+            TEST_ASSERT_TRUE(inserted);
+            TEST_ASSERT_EQUAL(i, (*value)->id);
+        }
+
+        // An existing key leaves the arguments alone
+        std::unique_ptr<tracked> spare = std::make_unique<tracked>(-1);
+        auto [existing, inserted] = owners.emplace(pocket::string("key number 7"), std::move(spare));
+        TEST_ASSERT_FALSE(inserted);
+        TEST_ASSERT_EQUAL(7, (*existing)->id);
+        TEST_ASSERT_NOT_NULL(spare.get());
+
+        TEST_ASSERT_TRUE(owners.erase(pocket::string("key number 8")));
+        TEST_ASSERT_FALSE(owners.contains(pocket::string("key number 8")));
+        TEST_ASSERT_EQUAL(200, live_objects);  // 199 in the map and the spare
+
+        pocket::hash_map<pocket::string, std::unique_ptr<tracked>> moved(std::move(owners));
+        TEST_ASSERT_EQUAL_size_t(0, owners.size());
+        TEST_ASSERT_EQUAL_size_t(199, moved.size());
+        TEST_ASSERT_EQUAL(150, (*moved.find(pocket::string("key number 150")))->id);
+    }
+    TEST_ASSERT_EQUAL(0, live_objects);
+}
+
+void test_hash_map_emplace_throwing_constructors(void) {
+    {
+        pocket::hash_map<fragile, fragile, fragile_hash> map;
+        fragile key(1), value(10);
+        fragile::fail_copies = true;
+
+        // The key copy throws, nothing was built yet
+        bool threw = false;
+        try {
+            map.emplace(key, fragile(10));
+        } catch (const std::bad_alloc &) {
+            threw = true;
+        }
+        TEST_ASSERT_TRUE(threw);
+        TEST_ASSERT_EQUAL(2, live_objects);
+
+        // The value copy throws, the key moved into the slot is destroyed again
+        threw = false;
+        try {
+            map.emplace(fragile(2), value);
+        } catch (const std::bad_alloc &) {
+            threw = true;
+        }
+        TEST_ASSERT_TRUE(threw);
+        TEST_ASSERT_EQUAL(2, live_objects);
+        TEST_ASSERT_EQUAL_size_t(0, map.size());
+        TEST_ASSERT_FALSE(map.contains(fragile(2)));
+
+        fragile::fail_copies = false;
+        for (int i = 0; i < 100; i++) map.emplace(fragile(i), value);  // Rehashes several times
+        TEST_ASSERT_EQUAL_size_t(100, map.size());
+        TEST_ASSERT_EQUAL(10, map.at(fragile(42)).id);
+    }
+    TEST_ASSERT_EQUAL(0, live_objects);
+}
+
+void test_string_wraps_string_t(void) {
+    static_assert(sizeof(pocket::string) == 24);
+    pocket::string small("short");
+    TEST_ASSERT_EQUAL_size_t(5, small.size());
+    TEST_ASSERT_EQUAL_size_t(0, small.memory_usage().reserved_bytes - STRING_SSO_CAPACITY);  // Inline
+
+    pocket::string text = small;
+    text += " and now long enough to live on the heap";
+    TEST_ASSERT_TRUE(string_is_heap(&text.raw()));
+    TEST_ASSERT_TRUE(small == "short");
+    TEST_ASSERT_EQUAL_size_t(10, text.find("now"));
+    TEST_ASSERT_EQUAL_size_t(pocket::string::npos, text.find("missing"));
+
+    // Moving steals the heap buffer
+    const char *buffer = text.c_str();
+    pocket::string moved = std::move(text);
+    TEST_ASSERT_TRUE(moved.c_str() == buffer);
+    TEST_ASSERT_TRUE(text.empty());
+
+    // The C functions work on raw()
+    string_append_int(&moved.raw(), 42);
+    TEST_ASSERT_TRUE(moved.view().substr(moved.size() - 2) == "42");
+    TEST_ASSERT_TRUE(small < moved);
+
+    // Writing through data() or operator[] drops the cached hash
+    pocket::string key("a heap allocated key, long enough to cache its hash");
+    std::uint64_t before = key.hash();
+    key.data()[0] = 'b';
+    TEST_ASSERT_TRUE(key.hash() != before);
+    TEST_ASSERT_EQUAL_UINT64(pocket::hash<std::string_view>{}(key.view()), key.hash());
+    key[0] = 'a';
+    TEST_ASSERT_EQUAL_UINT64(before, key.hash());
+
+    pocket::string adopted = pocket::string::adopt(string_create("from C"));
+    TEST_ASSERT_TRUE(adopted == "from C");
+}
+
+/* ====== Main runner ====== */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_hashes_match_the_c_defaults);
+    RUN_TEST(test_vector_matches_the_dyn_array_layout);
+    RUN_TEST(test_vector_holds_move_only_and_non_trivial_elements);
+    RUN_TEST(test_vector_sized_and_reserved_construction);
+    RUN_TEST(test_hash_map_matches_the_c_probing);
+    RUN_TEST(test_hash_map_emplace_and_move_only_values);
+    RUN_TEST(test_hash_map_emplace_throwing_constructors);
+    RUN_TEST(test_string_wraps_string_t);
+
+    return UNITY_END();
+}
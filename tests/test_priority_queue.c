@@ -0,0 +1,216 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "priority_queue.h"
+#include "unity.h"
+
+/* ====== Declare and implement an int min-heap ====== */
+static int compare_int(int a, int b) { return (a > b) - (a < b); }
+
+PRIORITY_QUEUE_DECLARE(int_queue, int, compare_int)
+PRIORITY_QUEUE_IMPLEMENT(int_queue, int, compare_int)
+
+/* ====== Struct elements with a macro comparator, earliest deadline first ====== */
+typedef struct deadline_t {
+    uint64_t deadline;
+    int id;
+} deadline_t;
+
+#define DEADLINE_CMP(a, b) (((a).deadline > (b).deadline) - ((a).deadline < (b).deadline))
+
+PRIORITY_QUEUE_DECLARE(timers, deadline_t, DEADLINE_CMP)
+PRIORITY_QUEUE_IMPLEMENT(timers, deadline_t, DEADLINE_CMP)
+
+/* ====== Unity test setup/teardown ====== */
+void setUp(void) {}
+void tearDown(void) {}
+
+/* ====== Helpers ====== */
+static uint64_t rng_state = 2463534242ull;
+static uint32_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)rng_state;
+}
+
+static int qsort_int(const void *a, const void *b) { return compare_int(*(const int *)a, *(const int *)b); }
+
+/* ====== Test cases ====== */
+void test_push_pop_in_order(void) {
+    enum { N = 5000 };
+    static int values[N];
+    int_queue_t queue = int_queue_create(0, false);
+    TEST_ASSERT_NOT_NULL(queue.items);
+    for (int i = 0; i < N; i++) {
+        values[i] = (int)(next_random() % 1000);  // Plenty of duplicates
+        TEST_ASSERT_EQUAL(1, int_queue_push(&queue, values[i]));
+    }
+    qsort(values, N, sizeof(int), qsort_int);
+
+    TEST_ASSERT_EQUAL_size_t(N, int_queue_size(&queue));
+    TEST_ASSERT_EQUAL(values[0], int_queue_top(&queue));
+    for (int i = 0; i < N; i++) TEST_ASSERT_EQUAL(values[i], int_queue_pop(&queue));
+    TEST_ASSERT_EQUAL_size_t(0, int_queue_size(&queue));
+    TEST_ASSERT_EQUAL(0, int_queue_pop(&queue));  // Empty
+    int_queue_free(&queue);
+}
+
+void test_struct_elements(void) {
+    timers_t queue = timers_create(4, false);
+    uint64_t deadlines[] = {50, 10, 40, 30, 20, 60};
+    for (int i = 0; i < 6; i++) {
+        deadline_t timer = {deadlines[i], i};
+        timers_push(&queue, timer);
+    }
+    TEST_ASSERT_EQUAL(1, timers_top(&queue).id);
+    for (uint64_t expected = 10; expected <= 60; expected += 10)
+        TEST_ASSERT_EQUAL_UINT64(expected, timers_pop(&queue).deadline);
+    TEST_ASSERT_EQUAL_UINT64(0, timers_pop(&queue).deadline);  // Zero value when empty
+    timers_free(&queue);
+}
+
+void test_heapify(void) {
+    enum { N = 1001 };
+    static int values[N];
+    for (int i = 0; i < N; i++) values[i] = (int)(next_random() % 100000);
+    int_queue_t queue = int_queue_create(8, false);
+    int_queue_push(&queue, -1);
+    TEST_ASSERT_EQUAL(1, int_queue_heapify(&queue, values, N));  // Grows past the initial capacity
+    TEST_ASSERT_EQUAL_size_t(N + 1, int_queue_size(&queue));
+
+    qsort(values, N, sizeof(int), qsort_int);
+    TEST_ASSERT_EQUAL(-1, int_queue_pop(&queue));
+    for (int i = 0; i < N; i++) TEST_ASSERT_EQUAL(values[i], int_queue_pop(&queue));
+    int_queue_free(&queue);
+}
+
+void test_push_bounded_keeps_top_k(void) {
+    enum { N = 10000, K = 10 };
+    static int values[N];
+    int_queue_t queue = int_queue_create(K, false);
+    for (int i = 0; i < N; i++) {
+        values[i] = (int)next_random();
+        int_queue_push_bounded(&queue, values[i], K);
+    }
+    TEST_ASSERT_EQUAL_size_t(K, int_queue_size(&queue));
+    TEST_ASSERT_EQUAL(0, int_queue_push_bounded(&queue, INT32_MIN, K));  // Smaller than all kept ones
+
+    // Pops the K greatest, smallest of them first
+    qsort(values, N, sizeof(int), qsort_int);
+    for (int i = N - K; i < N; i++) TEST_ASSERT_EQUAL(values[i], int_queue_pop(&queue));
+    int_queue_free(&queue);
+}
+
+void test_handles_update_and_remove(void) {
+    timers_t queue = timers_create(2, true);
+    size_t handles[100];
+    for (int i = 0; i < 100; i++) {
+        deadline_t timer = {(uint64_t)(1000 + i), i};
+        TEST_ASSERT_EQUAL(1, timers_push_handle(&queue, timer, &handles[i]));
+    }
+
+    // Decrease-key moves an element to the top, increase-key moves it down
+    deadline_t moved = {5, 42};
+    TEST_ASSERT_EQUAL(1, timers_update(&queue, handles[42], moved));
+    TEST_ASSERT_EQUAL(42, timers_top(&queue).id);
+    deadline_t later = {5000, 0};
+    TEST_ASSERT_EQUAL(1, timers_update(&queue, handles[0], later));
+    TEST_ASSERT_EQUAL_UINT64(5000, timers_get(&queue, handles[0]).deadline);
+
+    // Cancel every odd timer
+    for (int i = 1; i < 100; i += 2) TEST_ASSERT_EQUAL(1, timers_remove(&queue, handles[i]));
+    TEST_ASSERT_FALSE(timers_contains(&queue, handles[1]));
+    TEST_ASSERT_EQUAL(0, timers_remove(&queue, handles[1]));
+    TEST_ASSERT_EQUAL_size_t(50, timers_size(&queue));
+
+    // Handles of remaining elements still point at them
+    for (int i = 2; i < 100; i += 2) TEST_ASSERT_EQUAL(i, timers_get(&queue, handles[i]).id);
+
+    TEST_ASSERT_EQUAL(42, timers_pop(&queue).id);
+    TEST_ASSERT_FALSE(timers_contains(&queue, handles[42]));
+    uint64_t previous = 0;
+    int last_id = -1;
+    while (timers_size(&queue) > 0) {
+        deadline_t timer = timers_pop(&queue);
+        TEST_ASSERT_TRUE(timer.deadline >= previous);
+        TEST_ASSERT_EQUAL(0, timer.id % 2);
+        previous = timer.deadline;
+        last_id = timer.id;
+    }
+    TEST_ASSERT_EQUAL(0, last_id);  // Pushed back to 5000
+
+    // Freed handles are reused
+    size_t reused;
+    deadline_t timer = {1, 7};
+    timers_push_handle(&queue, timer, &reused);
+    TEST_ASSERT_TRUE(reused < 100);
+    TEST_ASSERT_EQUAL(7, timers_get(&queue, reused).id);
+    timers_free(&queue);
+}
+
+void test_handles_reused_past_the_end_of_the_free_list(void) {
+    int_queue_t queue = int_queue_create(0, true);
+    size_t a, b;
+    TEST_ASSERT_EQUAL(1, int_queue_push_handle(&queue, 1, &a));
+    TEST_ASSERT_EQUAL(1, int_queue_push_handle(&queue, 2, &b));
+    int_queue_pop(&queue);
+    TEST_ASSERT_EQUAL(1, int_queue_remove(&queue, b));
+
+    // The first two reuse the freed handles, the rest must get new ones
+    size_t handles[5];
+    for (int i = 0; i < 5; i++) TEST_ASSERT_EQUAL(1, int_queue_push_handle(&queue, 10 + i, &handles[i]));
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(handles[i] < 5);
+        TEST_ASSERT_EQUAL(10 + i, int_queue_get(&queue, handles[i]));
+        for (int j = 0; j < i; j++) TEST_ASSERT_TRUE(handles[i] != handles[j]);
+    }
+    for (int i = 0; i < 5; i++) TEST_ASSERT_EQUAL(10 + i, int_queue_pop(&queue));
+    int_queue_free(&queue);
+}
+
+void test_handles_match_a_sorted_reference(void) {
+    enum { N = 2000 };
+    int_queue_t queue = int_queue_create(16, true);
+    static size_t handles[N];
+    static int values[N], alive[N];
+    for (int i = 0; i < N; i++) {
+        values[i] = (int)(next_random() % 50000);
+        alive[i] = 1;
+        int_queue_push_handle(&queue, values[i], &handles[i]);
+    }
+    for (int round = 0; round < N; round++) {
+        int i = (int)(next_random() % N);
+        if (!alive[i]) continue;
+        if (round % 3 == 0) {
+            int_queue_remove(&queue, handles[i]);
+            alive[i] = 0;
+        } else {
+            values[i] = (int)(next_random() % 50000);
+            int_queue_update(&queue, handles[i], values[i]);
+        }
+    }
+    static int expected[N];
+    size_t count = 0;
+    for (int i = 0; i < N; i++)
+        if (alive[i]) expected[count++] = values[i];
+    qsort(expected, count, sizeof(int), qsort_int);
+    TEST_ASSERT_EQUAL_size_t(count, int_queue_size(&queue));
+    for (size_t i = 0; i < count; i++) TEST_ASSERT_EQUAL(expected[i], int_queue_pop(&queue));
+    int_queue_free(&queue);
+}
+
+/* ====== Main runner ====== */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_push_pop_in_order);
+    RUN_TEST(test_struct_elements);
+    RUN_TEST(test_heapify);
+    RUN_TEST(test_push_bounded_keeps_top_k);
+    RUN_TEST(test_handles_update_and_remove);
+    RUN_TEST(test_handles_reused_past_the_end_of_the_free_list);
+    RUN_TEST(test_handles_match_a_sorted_reference);
+
+    return UNITY_END();
+}
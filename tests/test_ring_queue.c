@@ -0,0 +1,242 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+
+#include "ring_queue.h"
+#include "unity.h"
+
+MPMC_QUEUE_DECLARE(mpmc_int, int)
+MPMC_QUEUE_IMPLEMENT(mpmc_int, int)
+
+SPSC_QUEUE_DECLARE(spsc_int, int)
+SPSC_QUEUE_IMPLEMENT(spsc_int, int)
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* Helper macro to compare size_t values using Unity */
+#define TEST_ASSERT_EQUAL_SIZE_T(expected, actual) \
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(expected), (unsigned int)(actual))
+
+/*******************
+ * MPMC
+ *******************/
+void test_mpmc_capacity_is_power_of_two(void) {
+    mpmc_int_t *q = mpmc_int_create(5);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_EQUAL_SIZE_T(8, mpmc_int_capacity(q));
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)q % RING_QUEUE_CACHE_LINE);
+    mpmc_int_free(q);
+
+    // Capacities that cannot be rounded up or allocated are rejected
+    TEST_ASSERT_NULL(mpmc_int_create(SIZE_MAX));
+    TEST_ASSERT_NULL(mpmc_int_create(SIZE_MAX / 2 + 2));
+    TEST_ASSERT_NULL(mpmc_int_create(SIZE_MAX / 8));
+    TEST_ASSERT_NULL(spsc_int_create(SIZE_MAX));
+    TEST_ASSERT_NULL(spsc_int_create(SIZE_MAX / 4));
+}
+
+void test_mpmc_fifo_full_and_empty(void) {
+    mpmc_int_t *q = mpmc_int_create(4);
+    int out = 0;
+    TEST_ASSERT_FALSE(mpmc_int_dequeue(q, &out));
+
+    for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(mpmc_int_enqueue(q, i));
+    TEST_ASSERT_FALSE(mpmc_int_enqueue(q, 99));  // Full
+    TEST_ASSERT_EQUAL_SIZE_T(4, mpmc_int_size(q));
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(mpmc_int_dequeue(q, &out));
+        TEST_ASSERT_EQUAL_INT(i, out);
+    }
+    TEST_ASSERT_FALSE(mpmc_int_dequeue(q, &out));
+    mpmc_int_free(q);
+}
+
+void test_mpmc_wraps_around(void) {
+    mpmc_int_t *q = mpmc_int_create(4);
+    int out = 0;
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(mpmc_int_enqueue(q, i));
+        TEST_ASSERT_TRUE(mpmc_int_enqueue(q, -i));
+        TEST_ASSERT_TRUE(mpmc_int_dequeue(q, &out));
+        TEST_ASSERT_EQUAL_INT(i, out);
+        TEST_ASSERT_TRUE(mpmc_int_dequeue(q, &out));
+        TEST_ASSERT_EQUAL_INT(-i, out);
+    }
+    mpmc_int_free(q);
+}
+
+void test_mpmc_batch(void) {
+    mpmc_int_t *q = mpmc_int_create(8);
+    int in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int out[10] = {0};
+
+    TEST_ASSERT_EQUAL_SIZE_T(8, mpmc_int_enqueue_batch(q, in, 10));  // Only 8 fit
+    TEST_ASSERT_EQUAL_SIZE_T(0, mpmc_int_enqueue_batch(q, in, 1));
+    TEST_ASSERT_EQUAL_SIZE_T(3, mpmc_int_dequeue_batch(q, out, 3));
+    TEST_ASSERT_EQUAL_INT(2, out[2]);
+    TEST_ASSERT_EQUAL_SIZE_T(3, mpmc_int_enqueue_batch(q, in + 7, 3));  // Wraps around the end of the ring
+    TEST_ASSERT_EQUAL_SIZE_T(8, mpmc_int_dequeue_batch(q, out, 10));
+    TEST_ASSERT_EQUAL_INT(3, out[0]);
+    TEST_ASSERT_EQUAL_INT(7, out[4]);
+    TEST_ASSERT_EQUAL_INT(7, out[5]);
+    TEST_ASSERT_EQUAL_INT(9, out[7]);
+    TEST_ASSERT_EQUAL_SIZE_T(0, mpmc_int_dequeue_batch(q, out, 10));
+    mpmc_int_free(q);
+}
+
+#define MPMC_THREADS 4
+#define MPMC_ITEMS_PER_PRODUCER 20000
+
+static void *mpmc_producer(void *arg) {
+    mpmc_int_t *q = arg;
+    for (int i = 1; i <= MPMC_ITEMS_PER_PRODUCER; i++) {
+        if (i % 2) {
+            while (!mpmc_int_enqueue(q, i)) sched_yield();
+        } else {
+            while (!mpmc_int_enqueue_batch(q, &i, 1)) sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *mpmc_consumer(void *arg) {
+    mpmc_int_t *q = arg;
+    long long *sum = malloc(sizeof(long long));
+    *sum = 0;
+    int received = 0, value = 0, batch[16];
+    while (received < MPMC_ITEMS_PER_PRODUCER) {
+        if (received % 3 == 0 && received + 16 <= MPMC_ITEMS_PER_PRODUCER) {
+            size_t n = mpmc_int_dequeue_batch(q, batch, 16);
+            for (size_t i = 0; i < n; i++) *sum += batch[i];
+            received += (int)n;
+        } else if (mpmc_int_dequeue(q, &value)) {
+            *sum += value;
+            received++;
+        } else {
+            sched_yield();
+        }
+    }
+    return sum;
+}
+
+void test_mpmc_threads_deliver_everything_once(void) {
+    mpmc_int_t *q = mpmc_int_create(64);
+    pthread_t producers[MPMC_THREADS], consumers[MPMC_THREADS];
+    for (int i = 0; i < MPMC_THREADS; i++) {
+        pthread_create(&producers[i], NULL, mpmc_producer, q);
+        pthread_create(&consumers[i], NULL, mpmc_consumer, q);
+    }
+    long long total = 0;
+    for (int i = 0; i < MPMC_THREADS; i++) {
+        void *sum;
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], &sum);
+        total += *(long long *)sum;
+        free(sum);
+    }
+    long long expected = (long long)MPMC_THREADS * MPMC_ITEMS_PER_PRODUCER * (MPMC_ITEMS_PER_PRODUCER + 1) / 2;
+    TEST_ASSERT_TRUE(total == expected);
+    TEST_ASSERT_EQUAL_SIZE_T(0, mpmc_int_size(q));
+    mpmc_int_free(q);
+}
+
+/*******************
+ * SPSC
+ *******************/
+void test_spsc_fifo_full_and_empty(void) {
+    spsc_int_t *q = spsc_int_create(3);
+    int out = 0;
+    TEST_ASSERT_EQUAL_SIZE_T(4, spsc_int_capacity(q));
+    TEST_ASSERT_FALSE(spsc_int_dequeue(q, &out));
+    for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(spsc_int_enqueue(q, i));
+    TEST_ASSERT_FALSE(spsc_int_enqueue(q, 99));
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(spsc_int_dequeue(q, &out));
+        TEST_ASSERT_EQUAL_INT(i, out);
+    }
+    TEST_ASSERT_FALSE(spsc_int_dequeue(q, &out));
+    spsc_int_free(q);
+}
+
+void test_spsc_batch_wraps_around(void) {
+    spsc_int_t *q = spsc_int_create(8);
+    int in[6] = {1, 2, 3, 4, 5, 6};
+    int out[8] = {0};
+    TEST_ASSERT_EQUAL_SIZE_T(6, spsc_int_enqueue_batch(q, in, 6));
+    TEST_ASSERT_EQUAL_SIZE_T(5, spsc_int_dequeue_batch(q, out, 5));
+    TEST_ASSERT_EQUAL_SIZE_T(6, spsc_int_enqueue_batch(q, in, 6));  // Crosses the end of the ring
+    TEST_ASSERT_EQUAL_SIZE_T(1, spsc_int_enqueue_batch(q, in, 6));  // Only one slot left
+    TEST_ASSERT_EQUAL_SIZE_T(8, spsc_int_dequeue_batch(q, out, 8));
+    int expected[8] = {6, 1, 2, 3, 4, 5, 6, 1};
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, out, 8);
+    spsc_int_free(q);
+}
+
+#define SPSC_ITEMS 200000
+
+static void *spsc_producer(void *arg) {
+    spsc_int_t *q = arg;
+    int i = 0;
+    while (i < SPSC_ITEMS) {
+        int chunk[7];
+        int n = SPSC_ITEMS - i < 7 ? SPSC_ITEMS - i : 7;
+        for (int k = 0; k < n; k++) chunk[k] = i + k;
+        size_t pushed = spsc_int_enqueue_batch(q, chunk, (size_t)n);
+        if (pushed == 0) sched_yield();
+        i += (int)pushed;
+    }
+    return NULL;
+}
+
+void test_spsc_threads_preserve_order(void) {
+    spsc_int_t *q = spsc_int_create(128);
+    pthread_t producer;
+    pthread_create(&producer, NULL, spsc_producer, q);
+    int expected = 0, value = 0, in_order = 1;
+    while (expected < SPSC_ITEMS) {
+        if (spsc_int_dequeue(q, &value)) {
+            in_order &= value == expected;
+            expected++;
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_join(producer, NULL);
+    TEST_ASSERT_TRUE(in_order);
+    spsc_int_free(q);
+}
+
+void test_memory_usage_counts_slots(void) {
+    mpmc_int_t *mpmc = mpmc_int_create(4);
+    for (int i = 0; i < 3; i++) mpmc_int_enqueue(mpmc, i);
+    pocket_memory_usage_t usage = mpmc_int_memory_usage(mpmc);
+    TEST_ASSERT_EQUAL_SIZE_T(3 * sizeof(mpmc_int_slot_t), usage.used_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(4 * sizeof(mpmc_int_slot_t), usage.reserved_bytes);
+    TEST_ASSERT_TRUE(usage.overhead_bytes >= sizeof(mpmc_int_t));
+    mpmc_int_free(mpmc);
+
+    spsc_int_t *spsc = spsc_int_create(8);
+    spsc_int_enqueue(spsc, 1);
+    usage = spsc_int_memory_usage(spsc);
+    TEST_ASSERT_EQUAL_SIZE_T(sizeof(int), usage.used_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(8 * sizeof(int), usage.reserved_bytes);
+    // The slot array is padded to a whole cache line
+    TEST_ASSERT_EQUAL_SIZE_T(sizeof(spsc_int_t) + RING_QUEUE_CACHE_LINE - 8 * sizeof(int), usage.overhead_bytes);
+    spsc_int_free(spsc);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_mpmc_capacity_is_power_of_two);
+    RUN_TEST(test_mpmc_fifo_full_and_empty);
+    RUN_TEST(test_mpmc_wraps_around);
+    RUN_TEST(test_mpmc_batch);
+    RUN_TEST(test_mpmc_threads_deliver_everything_once);
+    RUN_TEST(test_spsc_fifo_full_and_empty);
+    RUN_TEST(test_spsc_batch_wraps_around);
+    RUN_TEST(test_spsc_threads_preserve_order);
+    RUN_TEST(test_memory_usage_counts_slots);
+    return UNITY_END();
+}
@@ -0,0 +1,136 @@
+#include <stdint.h>
+
+#include "soa_array.h"
+#include "unity.h"
+
+/* A wide-ish record: scans usually only touch one or two of its columns */
+SOA_ARRAY_DECLARE(tick_soa, (double, price), (int, volume), (char, side), (uint64_t, timestamp))
+SOA_ARRAY_IMPLEMENT(tick_soa, (double, price), (int, volume), (char, side), (uint64_t, timestamp))
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* Helper macro to compare size_t values using Unity */
+#define TEST_ASSERT_EQUAL_SIZE_T(expected, actual) \
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(expected), (unsigned int)(actual))
+
+static tick_soa_row_t make_tick(int i) {
+    tick_soa_row_t row = {i * 0.5, i, (char)('a' + i % 26), (uint64_t)i * 1000};
+    return row;
+}
+
+void test_create_and_properties(void) {
+    tick_soa_t *soa = tick_soa_create(4);
+    TEST_ASSERT_NOT_NULL(soa);
+    TEST_ASSERT_EQUAL_SIZE_T(0, tick_soa_size(soa));
+    TEST_ASSERT_EQUAL_SIZE_T(4, tick_soa_capacity(soa));
+    TEST_ASSERT_NOT_NULL(tick_soa_column_price(soa));
+    TEST_ASSERT_NOT_NULL(tick_soa_column_timestamp(soa));
+    tick_soa_free(soa);
+}
+
+void test_push_get_set(void) {
+    tick_soa_t *soa = tick_soa_create(2);
+    TEST_ASSERT_TRUE(tick_soa_push_back(soa, make_tick(1)));
+    TEST_ASSERT_TRUE(tick_soa_push_back(soa, make_tick(2)));
+
+    tick_soa_row_t row = tick_soa_get(soa, 1);
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, row.price);
+    TEST_ASSERT_EQUAL_INT(2, row.volume);
+    TEST_ASSERT_EQUAL_CHAR('c', row.side);
+    TEST_ASSERT_EQUAL_UINT64(2000, row.timestamp);
+
+    row.volume = 42;
+    TEST_ASSERT_TRUE(tick_soa_set(soa, 1, row));
+    TEST_ASSERT_EQUAL_INT(42, tick_soa_get(soa, 1).volume);
+    TEST_ASSERT_EQUAL_INT(42, tick_soa_column_volume(soa)[1]);
+
+    /* Out of bounds */
+    TEST_ASSERT_FALSE(tick_soa_set(soa, 5, row));
+    TEST_ASSERT_EQUAL_INT(0, tick_soa_get(soa, 5).volume);
+
+    tick_soa_free(soa);
+}
+
+void test_growth_keeps_columns_aligned_and_intact(void) {
+    tick_soa_t *soa = tick_soa_create(1);
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(tick_soa_push_back(soa, make_tick(i)));
+    }
+    TEST_ASSERT_EQUAL_SIZE_T(1000, tick_soa_size(soa));
+    TEST_ASSERT_TRUE(tick_soa_capacity(soa) >= 1000);
+
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)tick_soa_column_price(soa) % SOA_ARRAY_ALIGNMENT);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)tick_soa_column_volume(soa) % SOA_ARRAY_ALIGNMENT);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)tick_soa_column_side(soa) % SOA_ARRAY_ALIGNMENT);
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)tick_soa_column_timestamp(soa) % SOA_ARRAY_ALIGNMENT);
+
+    /* Column scan over a single field */
+    const int *volume = tick_soa_column_volume(soa);
+    long sum = 0;
+    for (size_t i = 0; i < tick_soa_size(soa); i++) sum += volume[i];
+    TEST_ASSERT_EQUAL_INT(999 * 1000 / 2, sum);
+
+    tick_soa_row_t last = tick_soa_get(soa, 999);
+    TEST_ASSERT_EQUAL_DOUBLE(499.5, last.price);
+    TEST_ASSERT_EQUAL_UINT64(999000, last.timestamp);
+
+    tick_soa_free(soa);
+}
+
+void test_reserve_and_zero_capacity(void) {
+    tick_soa_t *soa = tick_soa_create(0);
+    TEST_ASSERT_NOT_NULL(soa);
+    TEST_ASSERT_TRUE(tick_soa_reserve(soa, 100));
+    TEST_ASSERT_TRUE(tick_soa_capacity(soa) >= 100);
+    TEST_ASSERT_TRUE(tick_soa_push_back(soa, make_tick(3)));
+    TEST_ASSERT_EQUAL_INT(3, tick_soa_get(soa, 0).volume);
+
+    // Sizes whose columns cannot be allocated fail and leave the array as it was
+    TEST_ASSERT_FALSE(tick_soa_reserve(soa, SIZE_MAX / 2 + 2));
+    TEST_ASSERT_FALSE(tick_soa_reserve(soa, SIZE_MAX));
+    TEST_ASSERT_TRUE(tick_soa_capacity(soa) >= 100);
+    TEST_ASSERT_EQUAL_INT(3, tick_soa_get(soa, 0).volume);
+    TEST_ASSERT_NULL(tick_soa_create(SIZE_MAX / 4));
+    tick_soa_free(soa);
+}
+
+void test_remove_and_clear(void) {
+    tick_soa_t *soa = tick_soa_create(4);
+    for (int i = 0; i < 4; i++) tick_soa_push_back(soa, make_tick(i));
+
+    TEST_ASSERT_TRUE(tick_soa_remove(soa, 1));
+    TEST_ASSERT_EQUAL_SIZE_T(3, tick_soa_size(soa));
+    TEST_ASSERT_EQUAL_INT(0, tick_soa_get(soa, 0).volume);
+    TEST_ASSERT_EQUAL_INT(2, tick_soa_get(soa, 1).volume);
+    TEST_ASSERT_EQUAL_CHAR('d', tick_soa_get(soa, 2).side);
+    TEST_ASSERT_FALSE(tick_soa_remove(soa, 3));
+
+    tick_soa_clear(soa);
+    TEST_ASSERT_EQUAL_SIZE_T(0, tick_soa_size(soa));
+    tick_soa_free(soa);
+}
+
+void test_memory_usage_counts_every_column(void) {
+    tick_soa_t *soa = tick_soa_create(4);
+    for (int i = 0; i < 3; i++) tick_soa_push_back(soa, make_tick(i));
+    size_t row = sizeof(double) + sizeof(int) + sizeof(char) + sizeof(uint64_t);
+    pocket_memory_usage_t usage = tick_soa_memory_usage(soa);
+    TEST_ASSERT_EQUAL_SIZE_T(3 * row, usage.used_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(4 * row, usage.reserved_bytes);
+    TEST_ASSERT_EQUAL_SIZE_T(row, usage.slack_bytes);
+    // Every column takes at least one SOA_ARRAY_ALIGNMENT block
+    TEST_ASSERT_EQUAL_SIZE_T(sizeof(tick_soa_t) + 4 * SOA_ARRAY_ALIGNMENT - 4 * row, usage.overhead_bytes);
+    tick_soa_free(soa);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_create_and_properties);
+    RUN_TEST(test_push_get_set);
+    RUN_TEST(test_growth_keeps_columns_aligned_and_intact);
+    RUN_TEST(test_reserve_and_zero_capacity);
+    RUN_TEST(test_remove_and_clear);
+    RUN_TEST(test_memory_usage_counts_every_column);
+    return UNITY_END();
+}
@@ -1,6 +1,13 @@
+#include <float.h>
+#include <locale.h>
+
+#include "hash_map.h"
 #include "pocket_string.h"
 #include "unity.h"
 
+HASH_MAP_DECLARE(route_map, string_t, int)
+HASH_MAP_IMPLEMENT(route_map, string_t, int)
+
 void setUp(void) {}
 void tearDown(void) {}
 
@@ -13,7 +20,7 @@ void tearDown(void) {}
  *******************/
 void test_string_create(void) {
     string_t s = string_create("Hello");
-    TEST_ASSERT_NOT_NULL(s.data);
+    TEST_ASSERT_NOT_NULL(string_get_cstr(&s));
     TEST_ASSERT_EQUAL_SIZE_T(5, string_size(&s));
     TEST_ASSERT_EQUAL_STRING("Hello", string_get_cstr(&s));
     string_free(&s);
@@ -21,7 +28,7 @@ void test_string_create(void) {
 
 void test_string_create_empty(void) {
     string_t s = string_create_empty();
-    TEST_ASSERT_NOT_NULL(s.data);
+    TEST_ASSERT_NOT_NULL(string_get_cstr(&s));
     TEST_ASSERT_EQUAL_SIZE_T(0, string_size(&s));
     TEST_ASSERT_TRUE(string_empty(&s));
     TEST_ASSERT_EQUAL_STRING("", string_get_cstr(&s));
@@ -93,6 +100,134 @@ void test_string_clear(void) {
     string_free(&s);
 }
 
+void test_string_reserve(void) {
+    string_t s = string_create("abc");
+    TEST_ASSERT_TRUE(string_reserve(&s, 100));
+    TEST_ASSERT_TRUE(string_capacity(&s) >= 100);
+    const char *buffer = string_get_cstr(&s);
+    for (int i = 0; i < 97; i++) string_push_back(&s, 'x');
+    TEST_ASSERT_EQUAL_PTR(buffer, string_get_cstr(&s));  // No reallocation up to the reserved size
+    TEST_ASSERT_EQUAL_SIZE_T(100, string_size(&s));
+    string_free(&s);
+}
+
+void test_string_append_n(void) {
+    string_t s = string_create_empty();
+    string_append_n(&s, "Hello World", 5);
+    TEST_ASSERT_EQUAL_STRING("Hello", string_get_cstr(&s));
+    string_append_n(&s, "!!!", 1);
+    TEST_ASSERT_EQUAL_STRING("Hello!", string_get_cstr(&s));
+    TEST_ASSERT_EQUAL_SIZE_T(6, string_size(&s));
+    string_free(&s);
+}
+
+void test_string_append_self(void) {
+    string_t s = string_create("abc");
+    string_append_n(&s, string_get_cstr(&s), string_size(&s));
+    string_concat(&s, &s);
+    TEST_ASSERT_EQUAL_STRING("abcabcabcabc", string_get_cstr(&s));
+    string_free(&s);
+}
+
+void test_string_appendf(void) {
+    string_t s = string_create("n=");
+    TEST_ASSERT_TRUE(string_appendf(&s, "%d, pi=%.2f, %s", 42, 3.14159, "ok"));
+    TEST_ASSERT_EQUAL_STRING("n=42, pi=3.14, ok", string_get_cstr(&s));
+
+    // Longer than any spare capacity
+    string_appendf(&s, "%0100d", 7);
+    TEST_ASSERT_EQUAL_SIZE_T(17 + 100, string_size(&s));
+    TEST_ASSERT_EQUAL_CHAR('7', string_back(&s));
+    string_free(&s);
+}
+
+void test_string_copy_keeps_size(void) {
+    string_t s1 = string_create("copy me");
+    string_t s2 = string_copy(&s1);
+    TEST_ASSERT_EQUAL_SIZE_T(7, string_size(&s2));
+    string_push_back(&s2, '!');
+    TEST_ASSERT_EQUAL_STRING("copy me!", string_get_cstr(&s2));
+    TEST_ASSERT_EQUAL_STRING("copy me", string_get_cstr(&s1));
+    string_free(&s1);
+    string_free(&s2);
+}
+
+void test_concat_into_empty(void) {
+    string_t s1 = string_create_empty();
+    string_t s2 = string_create("World");
+    string_concat(&s1, &s2);
+    TEST_ASSERT_EQUAL_STRING("World", string_get_cstr(&s1));
+    string_free(&s1);
+    string_free(&s2);
+}
+
+/*******************
+ * Small String Optimization
+ *******************/
+static int stored_inline(const string_t *s) {
+    const char *p = string_get_cstr(s);
+    return p >= (const char *)s && p < (const char *)s + sizeof(string_t);
+}
+
+void test_string_is_24_bytes(void) { TEST_ASSERT_EQUAL_SIZE_T(24, sizeof(string_t)); }
+
+void test_short_strings_stay_inline(void) {
+    string_t empty = string_create_empty();
+    TEST_ASSERT_TRUE(stored_inline(&empty));
+
+    string_t s = string_create("0123456789012345678901");  // STRING_SSO_CAPACITY chars
+    TEST_ASSERT_TRUE(stored_inline(&s));
+    TEST_ASSERT_EQUAL_SIZE_T(22, string_size(&s));
+    TEST_ASSERT_EQUAL_SIZE_T(STRING_SSO_CAPACITY, string_capacity(&s));
+    TEST_ASSERT_EQUAL_CHAR('1', string_back(&s));
+
+    string_free(&empty);
+    string_free(&s);
+}
+
+void test_growing_past_inline_capacity_moves_to_heap(void) {
+    string_t s = string_create("012345678901234567890");
+    string_push_back(&s, 'x');
+    TEST_ASSERT_TRUE(stored_inline(&s));
+    string_push_back(&s, 'y');
+    TEST_ASSERT_FALSE(stored_inline(&s));
+    TEST_ASSERT_EQUAL_STRING("012345678901234567890xy", string_get_cstr(&s));
+    TEST_ASSERT_EQUAL_SIZE_T(23, string_size(&s));
+
+    // Shrinking keeps the heap buffer
+    string_pop_back(&s);
+    string_pop_back(&s);
+    TEST_ASSERT_EQUAL_STRING("012345678901234567890", string_get_cstr(&s));
+    string_free(&s);
+}
+
+void test_long_string_create_and_copy(void) {
+    const char *text = "this string is definitely longer than twenty two characters";
+    string_t s = string_create(text);
+    TEST_ASSERT_FALSE(stored_inline(&s));
+    TEST_ASSERT_EQUAL_STRING(text, string_get_cstr(&s));
+
+    string_t c = string_copy(&s);
+    TEST_ASSERT_TRUE(string_get_cstr(&c) != string_get_cstr(&s));
+    string_erase(&c, 0);
+    TEST_ASSERT_EQUAL_STRING(text, string_get_cstr(&s));
+    TEST_ASSERT_EQUAL_STRING(text + 1, string_get_cstr(&c));
+
+    string_clear(&s);
+    TEST_ASSERT_TRUE(string_empty(&s));
+    TEST_ASSERT_TRUE(string_capacity(&s) >= strlen(text));
+
+    string_free(&s);
+    string_free(&c);
+}
+
+void test_string_create_n(void) {
+    string_t s = string_create_n("abcdef", 3);
+    TEST_ASSERT_EQUAL_STRING("abc", string_get_cstr(&s));
+    TEST_ASSERT_EQUAL_SIZE_T(3, string_size(&s));
+    string_free(&s);
+}
+
 /*******************
  * String Operations
  *******************/
@@ -110,6 +245,373 @@ void test_string_compare_equals(void) {
     string_free(&c);
 }
 
+void test_compare_uses_lengths(void) {
+    string_t a = string_create_n("ab\0c", 4);
+    string_t b = string_create_n("ab\0d", 4);
+    string_t prefix = string_create("ab");
+    TEST_ASSERT_FALSE(string_equals(&a, &b));  // strcmp would stop at the '\0'
+    TEST_ASSERT_LESS_THAN(0, string_compare(&a, &b));
+    TEST_ASSERT_GREATER_THAN(0, string_compare(&a, &prefix));
+    TEST_ASSERT_LESS_THAN(0, string_compare(&prefix, &a));
+    string_free(&a);
+    string_free(&b);
+    string_free(&prefix);
+}
+
+void test_hash_is_cached_and_invalidated(void) {
+    const char *path = "/api/v1/users/profile/settings/notifications";
+    string_t s = string_create(path);
+    uint64_t hash = string_hash(&s);
+    TEST_ASSERT_TRUE(hash == fnv_1a_hash_bytes(path, strlen(path)));
+    TEST_ASSERT_TRUE(hash == string_hash(&s));
+
+    string_push_back(&s, '/');
+    TEST_ASSERT_TRUE(string_hash(&s) == fnv_1a_hash_bytes(string_get_cstr(&s), string_size(&s)));
+    string_erase(&s, string_size(&s) - 1);
+    TEST_ASSERT_TRUE(string_hash(&s) == hash);
+
+    // Equal contents, different cached hashes only when the contents differ
+    string_t other = string_copy(&s);
+    string_hash(&other);
+    TEST_ASSERT_TRUE(string_equals(&s, &other));
+    string_push_back(&other, 'x');
+    string_hash(&other);
+    TEST_ASSERT_FALSE(string_equals(&s, &other));
+
+    string_t small = string_create("short");
+    TEST_ASSERT_TRUE(string_hash(&small) == fnv_1a_hash_bytes("short", 5));
+    string_free(&small);
+    string_free(&other);
+    string_free(&s);
+}
+
+void test_string_keys_in_hash_map(void) {
+    route_map_t map = route_map_create(4, string_keys_equal, default_hash_string);
+    const char *paths[] = {"/", "/health", "/api/v1/users/profile/settings", "/api/v1/orders/history/recent"};
+    for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(route_map_insert(&map, string_create(paths[i]), i));
+    for (int i = 0; i < 64; i++) {
+        string_t key = string_create_empty();
+        string_appendf(&key, "/generated/route/number/%d", i);
+        route_map_insert(&map, key, 100 + i);
+    }
+
+    for (int i = 0; i < 4; i++) {
+        string_t probe = string_create(paths[i]);
+        int *value = route_map_find(&map, probe);
+        TEST_ASSERT_NOT_NULL(value);
+        TEST_ASSERT_EQUAL(i, *value);
+        string_free(&probe);
+    }
+    string_t missing = string_create("/api/v1/users/profile/settingz");
+    TEST_ASSERT_NULL(route_map_find(&map, missing));
+    string_free(&missing);
+    TEST_ASSERT_EQUAL_size_t(68, map.occupancy);
+
+    // The map owns its keys
+    for (size_t i = 0; i < map.capacity; i++) {
+        if (map.entries[i].status == OCCUPIED) string_free(&map.entries[i].key);
+    }
+    route_map_free(&map);
+}
+
+/*******************
+ * String Views
+ *******************/
+static string_view_t sv(const char *c_str) { return string_view_create(c_str); }
+
+void test_substr_view_is_zero_copy(void) {
+    string_t s = string_create("key=value");
+    string_view_t key = string_substr_view(&s, 0, 3);
+    string_view_t value = string_substr_view(&s, 4, 100);  // len is clamped
+    TEST_ASSERT_EQUAL_PTR(string_get_cstr(&s), key.data);
+    TEST_ASSERT_EQUAL_SIZE_T(3, key.size);
+    TEST_ASSERT_TRUE(string_view_equals(value, sv("value")));
+    TEST_ASSERT_EQUAL_SIZE_T(0, string_substr_view(&s, 50, 2).size);  // pos is clamped
+
+    string_t copy = string_create_from_view(key);
+    TEST_ASSERT_EQUAL_STRING("key", string_get_cstr(&copy));
+    string_free(&copy);
+    string_free(&s);
+}
+
+void test_view_compare_prefix_suffix(void) {
+    TEST_ASSERT_EQUAL_INT(0, string_view_compare(sv("abc"), sv("abc")));
+    TEST_ASSERT_TRUE(string_view_compare(sv("ab"), sv("abc")) < 0);
+    TEST_ASSERT_TRUE(string_view_compare(sv("abd"), sv("abc")) > 0);
+    TEST_ASSERT_FALSE(string_view_equals(sv("ab"), sv("abc")));
+    TEST_ASSERT_TRUE(string_view_equals(sv(""), string_view_create_n(NULL, 0)));
+
+    TEST_ASSERT_TRUE(string_view_starts_with(sv("GET /index"), sv("GET ")));
+    TEST_ASSERT_FALSE(string_view_starts_with(sv("GE"), sv("GET")));
+    TEST_ASSERT_TRUE(string_view_ends_with(sv("log.txt"), sv(".txt")));
+    TEST_ASSERT_TRUE(string_view_ends_with(sv("log.txt"), sv("")));
+    TEST_ASSERT_FALSE(string_view_ends_with(sv("log.txt"), sv(".csv")));
+}
+
+void test_view_trim(void) {
+    TEST_ASSERT_TRUE(string_view_equals(string_view_trim(sv(" \t hello world\r\n")), sv("hello world")));
+    TEST_ASSERT_TRUE(string_view_equals(string_view_trim_left(sv("  x ")), sv("x ")));
+    TEST_ASSERT_TRUE(string_view_equals(string_view_trim_right(sv("  x ")), sv("  x")));
+    TEST_ASSERT_EQUAL_SIZE_T(0, string_view_trim(sv("   ")).size);
+}
+
+void test_split_keeps_empty_fields(void) {
+    string_t line = string_create("id,,name,score,");
+    string_view_t parts[8];
+    size_t n = string_split(string_view_of(&line), ',', parts, 8);
+    TEST_ASSERT_EQUAL_SIZE_T(5, n);
+    TEST_ASSERT_TRUE(string_view_equals(parts[0], sv("id")));
+    TEST_ASSERT_EQUAL_SIZE_T(0, parts[1].size);
+    TEST_ASSERT_TRUE(string_view_equals(parts[3], sv("score")));
+    TEST_ASSERT_EQUAL_SIZE_T(0, parts[4].size);
+    TEST_ASSERT_TRUE(parts[2].data == string_get_cstr(&line) + 4);
+
+    // Output buffer too small: still reports the full field count
+    TEST_ASSERT_EQUAL_SIZE_T(5, string_split(string_view_of(&line), ',', parts, 2));
+    TEST_ASSERT_EQUAL_SIZE_T(1, string_split(sv(""), ',', parts, 8));
+    string_free(&line);
+}
+
+void test_tokenize(void) {
+    string_view_t rest = sv("  GET\t/index.html  HTTP/1.1 "), token;
+    const char *expected[] = {"GET", "/index.html", "HTTP/1.1"};
+    int count = 0;
+    while (string_tokenize(&rest, " \t", &token)) {
+        TEST_ASSERT_TRUE(string_view_equals(token, sv(expected[count])));
+        count++;
+    }
+    TEST_ASSERT_EQUAL_INT(3, count);
+    TEST_ASSERT_EQUAL_SIZE_T(0, rest.size);
+}
+
+/*******************
+ * Search
+ *******************/
+void test_find_and_find_char(void) {
+    string_t s = string_create("the quick brown fox jumps over the lazy dog, the end");
+    TEST_ASSERT_EQUAL_SIZE_T(0, string_find(&s, "the", 0));
+    TEST_ASSERT_EQUAL_SIZE_T(31, string_find(&s, "the", 1));
+    TEST_ASSERT_EQUAL_SIZE_T(16, string_find(&s, "fox", 0));
+    TEST_ASSERT_EQUAL_SIZE_T(STRING_NPOS, string_find(&s, "cat", 0));
+    TEST_ASSERT_EQUAL_SIZE_T(5, string_find(&s, "", 5));
+    TEST_ASSERT_EQUAL_SIZE_T(STRING_NPOS, string_find(&s, "the", 1000));
+    TEST_ASSERT_EQUAL_SIZE_T(40, string_find(&s, "dog", 10));
+    TEST_ASSERT_EQUAL_SIZE_T(4, string_find_char(&s, 'q', 0));
+    TEST_ASSERT_EQUAL_SIZE_T(STRING_NPOS, string_find_char(&s, 'Z', 0));
+    string_free(&s);
+}
+
+void test_rfind(void) {
+    string_t s = string_create("abcabcabc--abc--x");
+    TEST_ASSERT_EQUAL_SIZE_T(11, string_rfind(&s, "abc"));
+    TEST_ASSERT_EQUAL_SIZE_T(16, string_rfind(&s, "x"));
+    TEST_ASSERT_EQUAL_SIZE_T(3, string_rfind(&s, "abcabc"));
+    TEST_ASSERT_EQUAL_SIZE_T(0, string_rfind(&s, "abcabca"));
+    TEST_ASSERT_EQUAL_SIZE_T(STRING_NPOS, string_rfind(&s, "zz"));
+    TEST_ASSERT_EQUAL_SIZE_T(15, string_view_rfind_char(string_view_of(&s), '-'));
+    string_free(&s);
+}
+
+void test_find_any_of(void) {
+    string_t s = string_create("key1 = value ; other:thing");
+    TEST_ASSERT_EQUAL_SIZE_T(5, string_find_any_of(&s, "=:;", 0));
+    TEST_ASSERT_EQUAL_SIZE_T(13, string_find_any_of(&s, "=:;", 6));
+    TEST_ASSERT_EQUAL_SIZE_T(20, string_find_any_of(&s, ":", 14));
+    TEST_ASSERT_EQUAL_SIZE_T(STRING_NPOS, string_find_any_of(&s, "#!", 0));
+    TEST_ASSERT_EQUAL_SIZE_T(3, string_find_any_of(&s, "0123456789ABCDEF", 0));  // Larger set
+    string_free(&s);
+}
+
+void test_count(void) {
+    string_t s = string_create("aaaa,bb,aaaa,");
+    TEST_ASSERT_EQUAL_SIZE_T(3, string_count(&s, ","));
+    TEST_ASSERT_EQUAL_SIZE_T(4, string_count(&s, "aa"));  // Non-overlapping
+    TEST_ASSERT_EQUAL_SIZE_T(0, string_count(&s, "c"));
+    string_free(&s);
+}
+
+/* Compares the vectorized search against a naive scan over a large buffer, hitting every block boundary */
+void test_search_matches_naive_scan(void) {
+    string_t hay = string_create_empty();
+    unsigned seed = 12345;
+    for (int i = 0; i < 4000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        string_push_back(&hay, (char)('a' + (seed >> 16) % 4));
+    }
+    const char *data = string_get_cstr(&hay);
+    size_t n = string_size(&hay);
+    const char *needles[] = {"a", "abc", "dcba", "abcdab", "ddddd", "bacabadcab"};
+    for (size_t k = 0; k < sizeof(needles) / sizeof(needles[0]); k++) {
+        size_t m = strlen(needles[k]);
+        size_t first = STRING_NPOS, last = STRING_NPOS, count = 0;
+        for (size_t i = 0; i + m <= n; i++) {
+            if (memcmp(data + i, needles[k], m) == 0) {
+                if (first == STRING_NPOS) first = i;
+                last = i;
+            }
+        }
+        for (size_t i = 0; i + m <= n;) {
+            if (memcmp(data + i, needles[k], m) == 0) {
+                count++;
+                i += m;
+            } else {
+                i++;
+            }
+        }
+        TEST_ASSERT_EQUAL_SIZE_T(first, string_find(&hay, needles[k], 0));
+        TEST_ASSERT_EQUAL_SIZE_T(last, string_rfind(&hay, needles[k]));
+        TEST_ASSERT_EQUAL_SIZE_T(count, string_count(&hay, needles[k]));
+        if (first != STRING_NPOS) {
+            TEST_ASSERT_EQUAL_SIZE_T(first, string_find(&hay, needles[k], first));
+        }
+    }
+    string_free(&hay);
+}
+
+void test_replace_all(void) {
+    string_t s = string_create("a-b-c--d");
+    TEST_ASSERT_TRUE(string_replace_all(&s, "-", ", "));  // Growing
+    TEST_ASSERT_EQUAL_STRING("a, b, c, , d", string_get_cstr(&s));
+    TEST_ASSERT_TRUE(string_replace_all(&s, ", ", "|"));  // Shrinking, in place
+    TEST_ASSERT_EQUAL_STRING("a|b|c||d", string_get_cstr(&s));
+    TEST_ASSERT_TRUE(string_replace_all(&s, "|", ""));
+    TEST_ASSERT_EQUAL_STRING("abcd", string_get_cstr(&s));
+    TEST_ASSERT_TRUE(string_replace_all(&s, "xyz", "!"));  // No match
+    TEST_ASSERT_EQUAL_STRING("abcd", string_get_cstr(&s));
+    TEST_ASSERT_FALSE(string_replace_all(&s, "", "!"));
+    TEST_ASSERT_TRUE(string_replace_all(&s, "abcd", "a much longer replacement than before"));
+    TEST_ASSERT_EQUAL_STRING("a much longer replacement than before", string_get_cstr(&s));
+    string_free(&s);
+}
+
+/*******************
+ * Numbers
+ *******************/
+void test_append_integers(void) {
+    string_t s = string_create("n=");
+    TEST_ASSERT_TRUE(string_append_int(&s, -42));
+    string_push_back(&s, ',');
+    string_append_uint(&s, 0);
+    string_push_back(&s, ',');
+    string_append_int(&s, INT64_MIN);
+    string_push_back(&s, ',');
+    string_append_uint(&s, UINT64_MAX);
+    TEST_ASSERT_EQUAL_STRING("n=-42,0,-9223372036854775808,18446744073709551615", string_get_cstr(&s));
+    string_free(&s);
+}
+
+void test_append_double_shortest(void) {
+    const double values[] = {0.1, -1234.5, 3, 1e-7, 0.1 + 0.2, 1e300, 5e-324, -0.0};
+    const char *expected[] = {"0.1", "-1234.5", "3", "0.0000001", "0.30000000000000004", "1e+300", "5e-324", "-0"};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        string_t s = string_create_empty();
+        TEST_ASSERT_TRUE(string_append_double(&s, values[i]));
+        TEST_ASSERT_EQUAL_STRING(expected[i], string_get_cstr(&s));
+        string_free(&s);
+    }
+}
+
+void test_double_round_trips(void) {
+    srand(7);
+    for (int i = 0; i < 20000; i++) {
+        uint64_t bits = ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (i % 2) value = (double)(rand() % 1000000) / 100.0;
+        if (isnan(value)) continue;
+        string_t s = string_create_empty();
+        string_append_double(&s, value);
+        double back = 0;
+        TEST_ASSERT_TRUE(string_parse_double(&s, &back));
+        TEST_ASSERT_TRUE(back == value);
+        string_free(&s);
+    }
+}
+
+void test_parse_integers(void) {
+    int64_t i;
+    uint64_t u;
+    TEST_ASSERT_TRUE(string_view_parse_int(string_view_create("-9223372036854775808"), &i));
+    TEST_ASSERT_TRUE(i == INT64_MIN);
+    TEST_ASSERT_TRUE(string_view_parse_int(string_view_create("+17"), &i));
+    TEST_ASSERT_TRUE(i == 17);
+    TEST_ASSERT_FALSE(string_view_parse_int(string_view_create("9223372036854775808"), &i));  // Overflow
+    TEST_ASSERT_FALSE(string_view_parse_int(string_view_create("-"), &i));
+    TEST_ASSERT_FALSE(string_view_parse_int(string_view_create("12a"), &i));
+    TEST_ASSERT_FALSE(string_view_parse_int(string_view_create(" 1"), &i));
+
+    TEST_ASSERT_TRUE(string_view_parse_uint(string_view_create("18446744073709551615"), &u));
+    TEST_ASSERT_TRUE(u == UINT64_MAX);
+    TEST_ASSERT_FALSE(string_view_parse_uint(string_view_create("18446744073709551616"), &u));
+    TEST_ASSERT_FALSE(string_view_parse_uint(string_view_create(""), &u));
+
+    // Views need no terminator
+    string_t s = string_create("port=8080;");
+    TEST_ASSERT_TRUE(string_view_parse_uint(string_view_substr(string_view_of(&s), 5, 4), &u));
+    TEST_ASSERT_TRUE(u == 8080);
+    string_free(&s);
+}
+
+void test_parse_double(void) {
+    double d;
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("3.25"), &d));
+    TEST_ASSERT_TRUE(d == 3.25);
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("-.5e2"), &d));
+    TEST_ASSERT_TRUE(d == -50.0);
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("1E-300"), &d));  // Slow path
+    TEST_ASSERT_TRUE(d == 1e-300);
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("0.30000000000000004"), &d));
+    TEST_ASSERT_TRUE(d == 0.1 + 0.2);
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("-Infinity"), &d));
+    TEST_ASSERT_TRUE(isinf(d) && d < 0);
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("nan"), &d));
+    TEST_ASSERT_TRUE(isnan(d));
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("."), &d));
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("1e"), &d));
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("1.5x"), &d));
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("infinit"), &d));
+}
+
+void test_parse_double_out_of_range(void) {
+    double d = 7.0;
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("1e400"), &d));
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("-1e400"), &d));
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("1e-400"), &d));
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("-0.001e-322"), &d));
+    TEST_ASSERT_TRUE(d == 7.0);  // Untouched on failure
+
+    // The edges of the range still parse
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("1.7976931348623157e308"), &d));
+    TEST_ASSERT_TRUE(d == DBL_MAX);
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("5e-324"), &d));
+    TEST_ASSERT_TRUE(d > 0 && d < DBL_MIN);
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("0e-400"), &d));
+    TEST_ASSERT_TRUE(d == 0);
+}
+
+void test_double_fallbacks_ignore_locale(void) {
+    const char *names[] = {"de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR.utf8", "fr_FR"};
+    int found = 0;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]) && !found; i++) {
+        found = setlocale(LC_NUMERIC, names[i]) != NULL;
+    }
+    if (!found) TEST_IGNORE_MESSAGE("no locale with a ',' decimal separator installed");
+
+    // Neither value takes a fast path, parsing goes through strtod
+    string_t s = string_create_empty();
+    TEST_ASSERT_TRUE(string_append_double(&s, 1.5e-30));
+    TEST_ASSERT_EQUAL_STRING("1.5e-30", string_get_cstr(&s));
+    double d = 0;
+    TEST_ASSERT_TRUE(string_parse_double(&s, &d));
+    TEST_ASSERT_TRUE(d == 1.5e-30);
+    TEST_ASSERT_TRUE(string_view_parse_double(string_view_create("0.30000000000000004"), &d));
+    TEST_ASSERT_TRUE(d == 0.1 + 0.2);
+    TEST_ASSERT_FALSE(string_view_parse_double(string_view_create("1,5e-30"), &d));
+    string_free(&s);
+
+    setlocale(LC_NUMERIC, "C");
+}
+
 /*******************
  * Edge Cases
  *******************/
@@ -183,7 +685,46 @@ int main(void) {
     RUN_TEST(test_string_concat);
     RUN_TEST(test_string_insert_erase);
     RUN_TEST(test_string_clear);
+    RUN_TEST(test_string_reserve);
+    RUN_TEST(test_string_append_n);
+    RUN_TEST(test_string_append_self);
+    RUN_TEST(test_string_appendf);
+    RUN_TEST(test_string_copy_keeps_size);
     RUN_TEST(test_string_compare_equals);
+    RUN_TEST(test_compare_uses_lengths);
+    RUN_TEST(test_hash_is_cached_and_invalidated);
+    RUN_TEST(test_string_keys_in_hash_map);
+
+    // Small string optimization
+    RUN_TEST(test_string_is_24_bytes);
+    RUN_TEST(test_short_strings_stay_inline);
+    RUN_TEST(test_growing_past_inline_capacity_moves_to_heap);
+    RUN_TEST(test_long_string_create_and_copy);
+    RUN_TEST(test_string_create_n);
+
+    // String views
+    RUN_TEST(test_substr_view_is_zero_copy);
+    RUN_TEST(test_view_compare_prefix_suffix);
+    RUN_TEST(test_view_trim);
+    RUN_TEST(test_split_keeps_empty_fields);
+    RUN_TEST(test_tokenize);
+
+    // Search
+    RUN_TEST(test_find_and_find_char);
+    RUN_TEST(test_rfind);
+    RUN_TEST(test_find_any_of);
+    RUN_TEST(test_count);
+    RUN_TEST(test_search_matches_naive_scan);
+    RUN_TEST(test_replace_all);
+
+    // Numbers
+    RUN_TEST(test_append_integers);
+    RUN_TEST(test_append_double_shortest);
+    RUN_TEST(test_double_round_trips);
+    RUN_TEST(test_parse_integers);
+    RUN_TEST(test_parse_double);
+    RUN_TEST(test_parse_double_out_of_range);
+    RUN_TEST(test_double_fallbacks_ignore_locale);
 
     // Edge cases
     RUN_TEST(test_append_empty_string);
@@ -192,6 +733,7 @@ int main(void) {
     RUN_TEST(test_erase_first_and_last_char);
     RUN_TEST(test_clear_empty_string);
     RUN_TEST(test_multiple_push_and_pop);
+    RUN_TEST(test_concat_into_empty);
 
     return UNITY_END();
 }
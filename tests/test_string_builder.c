@@ -0,0 +1,111 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "string_builder.h"
+#include "unity.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* Helper macro to compare size_t values using Unity */
+#define TEST_ASSERT_EQUAL_SIZE_T(expected, actual) \
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(expected), (unsigned int)(actual))
+
+static size_t count_chunks(const string_builder_t *builder) {
+    size_t count = 0;
+    for (const string_builder_chunk_t *c = builder->head; c; c = c->next) count++;
+    return count;
+}
+
+void test_append_and_finish(void) {
+    string_builder_t b = string_builder_create(8);
+    string_t name = string_create("world");
+    TEST_ASSERT_TRUE(string_builder_append_cstr(&b, "Hello, "));
+    TEST_ASSERT_TRUE(string_builder_append_string(&b, &name));
+    TEST_ASSERT_TRUE(string_builder_append_view(&b, string_view_create("! and more")));
+    TEST_ASSERT_TRUE(string_builder_append_n(&b, "xyz", 1));
+    TEST_ASSERT_EQUAL_SIZE_T(23, string_builder_size(&b));
+    TEST_ASSERT_TRUE(count_chunks(&b) > 1);
+
+    string_t s = string_builder_finish(&b);
+    TEST_ASSERT_EQUAL_STRING("Hello, world! and morex", string_get_cstr(&s));
+    TEST_ASSERT_EQUAL_SIZE_T(0, string_builder_size(&b));
+    TEST_ASSERT_NULL(b.head);
+
+    string_free(&s);
+    string_free(&name);
+}
+
+void test_appended_bytes_never_move(void) {
+    string_builder_t b = string_builder_create(16);
+    string_builder_append_cstr(&b, "first");
+    const char *first = b.head->data;
+    for (int i = 0; i < 1000; i++) string_builder_append_cstr(&b, "0123456789");
+    TEST_ASSERT_EQUAL_PTR(first, b.head->data);
+    TEST_ASSERT_EQUAL_SIZE_T(10005, string_builder_size(&b));
+    string_builder_free(&b);
+}
+
+void test_appendf(void) {
+    string_builder_t b = string_builder_create(16);
+    string_builder_appendf(&b, "{\"id\":%d,", 7);
+    string_builder_appendf(&b, "\"name\":\"%s\"}", "a rather long name that does not fit");
+    string_t s = string_builder_finish(&b);
+    TEST_ASSERT_EQUAL_STRING("{\"id\":7,\"name\":\"a rather long name that does not fit\"}", string_get_cstr(&s));
+    string_free(&s);
+}
+
+void test_insert_in_the_middle(void) {
+    string_builder_t b = string_builder_create(4);
+    string_builder_append_cstr(&b, "abcd");  // Fills the first chunk
+    string_builder_append_cstr(&b, "efghijkl");
+    TEST_ASSERT_TRUE(string_builder_insert(&b, 2, "XY", 2));   // Splits the full first chunk
+    TEST_ASSERT_TRUE(string_builder_insert(&b, 0, "<", 1));    // Front
+    TEST_ASSERT_TRUE(string_builder_insert(&b, 7, "-", 1));    // Chunk boundary
+    TEST_ASSERT_TRUE(string_builder_insert(&b, 100, ">", 1));  // Past the end appends
+    string_builder_append_cstr(&b, "!");
+
+    string_t s = string_builder_finish(&b);
+    TEST_ASSERT_EQUAL_STRING("<abXYcd-efghijkl>!", string_get_cstr(&s));
+    string_free(&s);
+}
+
+void test_write_fd(void) {
+    char path[] = "/tmp/pocket_string_builder_XXXXXX";
+    int fd = mkstemp(path);
+    string_builder_t b = string_builder_create(8);
+    for (int i = 0; i < 200; i++) string_builder_appendf(&b, "line %d\n", i);
+    string_builder_insert(&b, 0, "header\n", 7);
+    TEST_ASSERT_TRUE(string_builder_write_fd(&b, fd));
+    close(fd);
+
+    // Compare with the single-buffer result
+    string_t expected = string_builder_finish(&b);
+    char buffer[4096];
+    fd = open(path, O_RDONLY);
+    ssize_t got = read(fd, buffer, sizeof(buffer));
+    close(fd);
+    unlink(path);
+    TEST_ASSERT_EQUAL_SIZE_T(string_size(&expected), (size_t)got);
+    TEST_ASSERT_EQUAL_MEMORY(string_get_cstr(&expected), buffer, (size_t)got);
+    string_free(&expected);
+}
+
+void test_empty_builder(void) {
+    string_builder_t b = string_builder_create(0);
+    string_t s = string_builder_finish(&b);
+    TEST_ASSERT_TRUE(string_empty(&s));
+    TEST_ASSERT_EQUAL_STRING("", string_get_cstr(&s));
+    string_free(&s);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_append_and_finish);
+    RUN_TEST(test_appended_bytes_never_move);
+    RUN_TEST(test_appendf);
+    RUN_TEST(test_insert_in_the_middle);
+    RUN_TEST(test_write_fd);
+    RUN_TEST(test_empty_builder);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+#include <pthread.h>
+#include <stdio.h>
+
+#include "string_intern.h"
+#include "unity.h"
+
+STRING_INTERN_DECLARE(symbols)
+STRING_INTERN_IMPLEMENT(symbols)
+
+void setUp(void) {}
+void tearDown(void) {}
+
+/* Helper macro to compare size_t values using Unity */
+#define TEST_ASSERT_EQUAL_SIZE_T(expected, actual) \
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(expected), (unsigned int)(actual))
+
+void test_same_string_same_id(void) {
+    symbols_t pool;
+    TEST_ASSERT_TRUE(symbols_init(&pool, false));
+    char buffer[] = "timeout";
+    uint32_t a = symbols_intern(&pool, "timeout");
+    uint32_t b = symbols_intern(&pool, buffer);
+    uint32_t c = symbols_intern(&pool, "retries");
+    TEST_ASSERT_EQUAL_UINT32(a, b);
+    TEST_ASSERT_NOT_EQUAL(a, c);
+    TEST_ASSERT_EQUAL_SIZE_T(2, symbols_count(&pool));
+
+    // The canonical pointer is shared and does not alias the caller's buffer
+    TEST_ASSERT_EQUAL_PTR(symbols_cstr(&pool, a), symbols_canonical(&pool, buffer, 7));
+    TEST_ASSERT_TRUE(symbols_cstr(&pool, a) != buffer);
+    TEST_ASSERT_EQUAL_STRING("timeout", symbols_cstr(&pool, a));
+    TEST_ASSERT_EQUAL_SIZE_T(7, symbols_length(&pool, a));
+    TEST_ASSERT_TRUE(symbols_hash(&pool, a) == fnv_1a_hash_bytes("timeout", 7));
+    symbols_free(&pool);
+}
+
+void test_intern_views_and_strings(void) {
+    symbols_t pool;
+    TEST_ASSERT_TRUE(symbols_init(&pool, false));
+    string_t owned = string_create("host");
+    uint32_t from_string = symbols_intern_string(&pool, &owned);
+    uint32_t from_view = symbols_intern_view(&pool, string_view_substr(string_view_create("localhost"), 5, 4));
+    TEST_ASSERT_EQUAL_UINT32(from_string, from_view);
+    TEST_ASSERT_TRUE(string_view_equals(symbols_view(&pool, from_view), string_view_create("host")));
+
+    // Embedded NUL bytes and the empty string are distinct keys
+    uint32_t empty = symbols_intern_n(&pool, "", 0);
+    uint32_t nul = symbols_intern_n(&pool, "a\0b", 3);
+    TEST_ASSERT_NOT_EQUAL(empty, nul);
+    TEST_ASSERT_EQUAL_SIZE_T(3, symbols_length(&pool, nul));
+    TEST_ASSERT_EQUAL_STRING("", symbols_cstr(&pool, empty));
+
+    string_free(&owned);
+    symbols_free(&pool);
+}
+
+void test_lookup_does_not_insert(void) {
+    symbols_t pool;
+    TEST_ASSERT_TRUE(symbols_init(&pool, false));
+    TEST_ASSERT_EQUAL_UINT32(STRING_INTERN_INVALID_ID, symbols_lookup_n(&pool, "missing", 7));
+    TEST_ASSERT_EQUAL_SIZE_T(0, symbols_count(&pool));
+    uint32_t id = symbols_intern(&pool, "missing");
+    TEST_ASSERT_EQUAL_UINT32(id, symbols_lookup_n(&pool, "missing", 7));
+    symbols_free(&pool);
+}
+
+void test_many_strings_keep_stable_pointers(void) {
+    symbols_t pool;
+    TEST_ASSERT_TRUE(symbols_init(&pool, false));
+    char name[32];
+    const char *first = symbols_cstr(&pool, symbols_intern(&pool, "name0"));
+    for (int i = 0; i < 20000; i++) {
+        int len = snprintf(name, sizeof(name), "name%d", i);
+        TEST_ASSERT_EQUAL_UINT32((uint32_t)i, symbols_intern_n(&pool, name, (size_t)len));
+    }
+    TEST_ASSERT_EQUAL_SIZE_T(20000, symbols_count(&pool));
+    TEST_ASSERT_EQUAL_PTR(first, symbols_cstr(&pool, 0));
+    TEST_ASSERT_EQUAL_STRING("name12345", symbols_cstr(&pool, 12345));
+    TEST_ASSERT_EQUAL_STRING("name19999", symbols_cstr(&pool, 19999));
+
+    // Strings larger than an arena chunk
+    char *big = malloc(STRING_INTERN_ARENA_CHUNK + 10);
+    memset(big, 'x', STRING_INTERN_ARENA_CHUNK + 10);
+    uint32_t big_id = symbols_intern_n(&pool, big, STRING_INTERN_ARENA_CHUNK + 10);
+    TEST_ASSERT_EQUAL_SIZE_T(STRING_INTERN_ARENA_CHUNK + 10, symbols_length(&pool, big_id));
+    TEST_ASSERT_EQUAL_UINT32(big_id, symbols_intern_n(&pool, big, STRING_INTERN_ARENA_CHUNK + 10));
+    free(big);
+    symbols_free(&pool);
+}
+
+#define SHARED_THREADS 4
+#define SHARED_NAMES 2000
+
+static void *intern_worker(void *arg) {
+    symbols_t *pool = (symbols_t *)arg;
+    uint32_t *ids = malloc(SHARED_NAMES * sizeof(uint32_t));
+    char name[32];
+    for (int i = 0; i < SHARED_NAMES; i++) {
+        int len = snprintf(name, sizeof(name), "key%d", i);
+        ids[i] = symbols_intern_n(pool, name, (size_t)len);
+    }
+    return ids;
+}
+
+void test_thread_safe_pool(void) {
+    symbols_t pool;
+    TEST_ASSERT_TRUE(symbols_init(&pool, true));
+    pthread_t threads[SHARED_THREADS];
+    uint32_t *ids[SHARED_THREADS];
+    for (int t = 0; t < SHARED_THREADS; t++) pthread_create(&threads[t], NULL, intern_worker, &pool);
+    for (int t = 0; t < SHARED_THREADS; t++) pthread_join(threads[t], (void **)&ids[t]);
+
+    // Every thread got the same id for the same string, and each string was added once
+    TEST_ASSERT_EQUAL_SIZE_T(SHARED_NAMES, symbols_count(&pool));
+    for (int i = 0; i < SHARED_NAMES; i++) {
+        for (int t = 1; t < SHARED_THREADS; t++) TEST_ASSERT_EQUAL_UINT32(ids[0][i], ids[t][i]);
+        char name[32];
+        snprintf(name, sizeof(name), "key%d", i);
+        TEST_ASSERT_EQUAL_STRING(name, symbols_cstr(&pool, ids[0][i]));
+    }
+    for (int t = 0; t < SHARED_THREADS; t++) free(ids[t]);
+    symbols_free(&pool);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_same_string_same_id);
+    RUN_TEST(test_intern_views_and_strings);
+    RUN_TEST(test_lookup_does_not_insert);
+    RUN_TEST(test_many_strings_keep_stable_pointers);
+    RUN_TEST(test_thread_safe_pool);
+    return UNITY_END();
+}